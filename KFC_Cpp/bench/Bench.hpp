@@ -0,0 +1,217 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Minimal micro-benchmark harness.
+//
+// Every benchmark is warmed up, then the iteration count is calibrated so a
+// sample lasts at least min_sample_ms; the reported figure is the median of
+// the per-operation times over all samples, with the median absolute
+// deviation (MAD) as the noise estimate.  Medians keep a single preempted
+// sample from moving the result.
+// ---------------------------------------------------------------------------
+
+// Keep the compiler from discarding a result that is otherwise unused
+template <class T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+struct BenchOptions
+{
+    int samples{15};
+    double min_sample_ms{5.0};
+    std::string filter; // run only names containing this
+};
+
+struct BenchResult
+{
+    std::string name;
+    uint64_t iterations{0}; // per sample
+    int samples{0};
+    double median_ns{0}, mad_ns{0}, mean_ns{0}, min_ns{0}, max_ns{0};
+    std::string skipped; // reason, when the benchmark could not run
+};
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(BenchOptions opt) : opt(std::move(opt)) {}
+
+    bool wanted(const std::string &name) const
+    {
+        return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+    }
+
+    // op() performs one operation
+    template <class F>
+    void run(const std::string &name, F &&op)
+    {
+        if (!wanted(name))
+            return;
+        using clock = std::chrono::steady_clock;
+        auto time_n = [&](uint64_t n)
+        {
+            auto t0 = clock::now();
+            for (uint64_t i = 0; i < n; ++i)
+                op();
+            return std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        };
+
+        // Warm-up doubles as calibration
+        const double target_ns = opt.min_sample_ms * 1e6;
+        uint64_t n = 1;
+        double t = time_n(n);
+        while (t < target_ns && n < (1ull << 32))
+        {
+            n = t <= 0 ? n * 2 : std::max(n * 2, static_cast<uint64_t>(static_cast<double>(n) * target_ns / t * 1.2));
+            t = time_n(n);
+        }
+
+        std::vector<double> per_op;
+        per_op.reserve(static_cast<size_t>(opt.samples));
+        for (int s = 0; s < opt.samples; ++s)
+            per_op.push_back(time_n(n) / static_cast<double>(n));
+
+        BenchResult r;
+        r.name = name;
+        r.iterations = n;
+        r.samples = opt.samples;
+        summarize(per_op, r);
+        results_.push_back(r);
+        print(r);
+    }
+
+    void skip(const std::string &name, const std::string &why)
+    {
+        if (!wanted(name))
+            return;
+        BenchResult r;
+        r.name = name;
+        r.skipped = why;
+        results_.push_back(r);
+        print(r);
+    }
+
+    const std::vector<BenchResult> &results() const { return results_; }
+
+    nlohmann::json to_json(const nlohmann::json &context) const
+    {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto &r : results_)
+        {
+            if (!r.skipped.empty())
+            {
+                list.push_back({{"name", r.name}, {"skipped", r.skipped}});
+                continue;
+            }
+            list.push_back({{"name", r.name},
+                            {"median_ns", r.median_ns},
+                            {"mad_ns", r.mad_ns},
+                            {"mean_ns", r.mean_ns},
+                            {"min_ns", r.min_ns},
+                            {"max_ns", r.max_ns},
+                            {"iterations", r.iterations},
+                            {"samples", r.samples}});
+        }
+        return {{"context", context}, {"benchmarks", list}};
+    }
+
+    // Compare against a file written by to_json().  A benchmark regresses
+    // when its median grew by more than threshold and by more than three
+    // times the larger MAD of the two runs.  Returns the number of
+    // regressions.
+    int compare(const std::string &baseline_path, double threshold) const
+    {
+        std::ifstream in(baseline_path);
+        if (!in)
+            throw std::runtime_error("Cannot open baseline " + baseline_path);
+        nlohmann::json base = nlohmann::json::parse(in);
+        std::map<std::string, std::pair<double, double>> old; // median, mad
+        for (const auto &b : base.at("benchmarks"))
+            if (b.contains("median_ns"))
+                old[b.at("name").get<std::string>()] = {b.at("median_ns").get<double>(), b.at("mad_ns").get<double>()};
+
+        int regressions = 0;
+        std::cout << "\n"
+                  << std::left << std::setw(44) << "benchmark" << std::right << std::setw(14) << "baseline ns"
+                  << std::setw(14) << "current ns" << std::setw(10) << "change" << "\n";
+        for (const auto &r : results_)
+        {
+            auto it = old.find(r.name);
+            if (!r.skipped.empty() || it == old.end())
+                continue;
+            double before = it->second.first;
+            double change = (r.median_ns - before) / before;
+            double noise = 3.0 * std::max(it->second.second, r.mad_ns) / before;
+            double limit = std::max(threshold, noise);
+            const char *verdict = change > limit ? "  REGRESSION" : change < -limit ? "  faster" : "";
+            if (change > limit)
+                ++regressions;
+            std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << before << std::setw(14) << r.median_ns << std::setw(9)
+                      << change * 100.0 << "%" << verdict << "\n";
+        }
+        std::cout << regressions << " regression(s)" << std::endl;
+        return regressions;
+    }
+
+private:
+    static double median_of(std::vector<double> v)
+    {
+        std::sort(v.begin(), v.end());
+        size_t m = v.size() / 2;
+        return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2.0;
+    }
+
+    static void summarize(const std::vector<double> &v, BenchResult &r)
+    {
+        r.median_ns = median_of(v);
+        std::vector<double> dev;
+        dev.reserve(v.size());
+        double sum = 0;
+        for (double x : v)
+        {
+            dev.push_back(std::abs(x - r.median_ns));
+            sum += x;
+        }
+        r.mad_ns = median_of(dev);
+        r.mean_ns = sum / static_cast<double>(v.size());
+        r.min_ns = *std::min_element(v.begin(), v.end());
+        r.max_ns = *std::max_element(v.begin(), v.end());
+    }
+
+    static void print(const BenchResult &r)
+    {
+        std::cout << std::left << std::setw(44) << r.name << std::right;
+        if (!r.skipped.empty())
+        {
+            std::cout << "skipped: " << r.skipped << std::endl;
+            return;
+        }
+        std::cout << std::fixed << std::setprecision(1) << std::setw(14) << r.median_ns << " ns/op  +- "
+                  << std::setw(8) << r.mad_ns << "  (" << r.samples << " x " << r.iterations << ")" << std::endl;
+    }
+
+    BenchOptions opt;
+    std::vector<BenchResult> results_;
+};
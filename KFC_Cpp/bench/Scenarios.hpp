@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Command.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Canned full-game scripts for the scenario benchmarks.  Every command is
+// issued at its timestamp on a virtual clock, so a scenario always replays
+// the same game and ends in the same state.
+// ---------------------------------------------------------------------------
+struct Scenario
+{
+    std::string name;
+    int duration_ms{0};
+    std::vector<Command> commands; // sorted by timestamp
+};
+
+namespace scenario_detail
+{
+using Cell = std::pair<int, int>;
+
+// Pieces keep the id of their starting cell, e.g. "PW_(6,4)"
+inline std::string piece_at(char type, char color, Cell start)
+{
+    return std::string{type, color} + "_(" + std::to_string(start.first) + "," + std::to_string(start.second) + ")";
+}
+
+inline Command move(int t, char type, char color, Cell start, Cell from, Cell to)
+{
+    return Command{t, piece_at(type, color, start), "move", {from, to}};
+}
+
+// Black mirrors white across the middle of the board
+inline Cell mirror(Cell c) { return {7 - c.first, c.second}; }
+
+inline void sort_by_time(Scenario &s)
+{
+    std::stable_sort(s.commands.begin(), s.commands.end(),
+                     [](const Command &a, const Command &b)
+                     { return a.timestamp < b.timestamp; });
+}
+
+// Gap that lets a move finish and the long rest after it run out
+constexpr int kSettleMs = 5000;
+} // namespace scenario_detail
+
+// A few developing moves per side, all quiet.  A moving piece stands on
+// the cells its position truncates to, so a move toward row or column 0
+// enters the next cell at once: every cell on the way is empty here.
+inline Scenario scenario_opening()
+{
+    using namespace scenario_detail;
+    Scenario s{"opening", 20000, {}};
+    s.commands = {
+        move(0, 'P', 'W', {6, 4}, {6, 4}, {5, 4}),
+        move(100, 'P', 'B', {1, 3}, {1, 3}, {2, 3}),
+        move(2000, 'P', 'W', {6, 1}, {6, 1}, {5, 1}),
+        move(2100, 'P', 'B', {1, 1}, {1, 1}, {2, 1}),
+        move(4000, 'B', 'W', {7, 5}, {7, 5}, {5, 3}),
+        move(4100, 'B', 'B', {0, 2}, {0, 2}, {2, 4}),
+        move(7000, 'P', 'W', {6, 1}, {5, 1}, {4, 1}),
+        move(7100, 'P', 'B', {1, 1}, {2, 1}, {3, 1}),
+        move(9000, 'N', 'W', {7, 1}, {7, 1}, {5, 2}),
+        move(9100, 'N', 'B', {0, 1}, {0, 1}, {2, 2}),
+    };
+    sort_by_time(s);
+    return s;
+}
+
+// All sixteen pawns step forward together, twice
+inline Scenario scenario_pawn_push()
+{
+    using namespace scenario_detail;
+    Scenario s{"pawn_push", 2 * kSettleMs + 2000, {}};
+    for (int step = 0; step < 2; ++step)
+        for (int c = 0; c < 8; ++c)
+        {
+            int t = step * kSettleMs;
+            s.commands.push_back(move(t, 'P', 'W', {6, c}, {6 - step, c}, {5 - step, c}));
+            s.commands.push_back(move(t, 'P', 'B', {1, c}, {1 + step, c}, {2 + step, c}));
+        }
+    sort_by_time(s);
+    return s;
+}
+
+// The four knights are sent in three hops into the opposing pawns; the
+// collisions on the way and at the end decide who is left
+inline Scenario scenario_capture_storm()
+{
+    using namespace scenario_detail;
+    Scenario s{"capture_storm", 3 * kSettleMs + 3000, {}};
+    // Three hops per knight; the last one lands on an enemy pawn
+    const std::vector<std::pair<Cell, std::vector<Cell>>> raids = {
+        {{7, 1}, {{5, 2}, {3, 3}, {1, 2}}},
+        {{7, 6}, {{5, 7}, {3, 6}, {1, 5}}},
+    };
+    for (const auto &raid : raids)
+    {
+        Cell w = raid.first, b = mirror(raid.first);
+        for (size_t hop = 0; hop < raid.second.size(); ++hop)
+        {
+            int t = static_cast<int>(hop) * kSettleMs;
+            Cell to = raid.second[hop];
+            s.commands.push_back(move(t, 'N', 'W', raid.first, w, to));
+            s.commands.push_back(move(t + 50, 'N', 'B', mirror(raid.first), b, mirror(to)));
+            w = to;
+            b = mirror(to);
+        }
+    }
+    sort_by_time(s);
+    return s;
+}
+
+// Every pawn steps, then every back-rank piece but the knights moves up a
+// rank at the same instant; no two paths cross, so nothing is captured
+inline Scenario scenario_all_at_once()
+{
+    using namespace scenario_detail;
+    Scenario s{"all_at_once", 2 * kSettleMs + 2000, {}};
+    for (int c = 0; c < 8; ++c)
+    {
+        s.commands.push_back(move(0, 'P', 'W', {6, c}, {6, c}, {5, c}));
+        s.commands.push_back(move(0, 'P', 'B', {1, c}, {1, c}, {2, c}));
+    }
+    // Not mirrored: a diagonal step toward column 0 would cross the cell
+    // beside its start, which on row 0 still holds a piece
+    const std::vector<std::pair<char, std::pair<Cell, Cell>>> white = {
+        {'R', {{7, 0}, {6, 0}}}, {'B', {{7, 2}, {6, 1}}}, {'K', {{7, 3}, {6, 3}}},
+        {'Q', {{7, 4}, {6, 4}}}, {'B', {{7, 5}, {6, 6}}}, {'R', {{7, 7}, {6, 7}}},
+    };
+    const std::vector<std::pair<char, std::pair<Cell, Cell>>> black = {
+        {'R', {{0, 0}, {1, 0}}}, {'B', {{0, 2}, {1, 3}}}, {'K', {{0, 3}, {1, 4}}},
+        {'Q', {{0, 4}, {1, 5}}}, {'B', {{0, 5}, {1, 6}}}, {'R', {{0, 7}, {1, 7}}},
+    };
+    for (const auto &p : white)
+        s.commands.push_back(move(kSettleMs, p.first, 'W', p.second.first, p.second.first, p.second.second));
+    for (const auto &p : black)
+        s.commands.push_back(move(kSettleMs, p.first, 'B', p.second.first, p.second.first, p.second.second));
+    sort_by_time(s);
+    return s;
+}
+
+// A minute with nothing happening – the cost of an idle board
+inline Scenario scenario_idle()
+{
+    return Scenario{"idle", 60000, {}};
+}
+
+inline std::vector<Scenario> all_scenarios()
+{
+    return {scenario_opening(), scenario_pawn_push(), scenario_capture_storm(), scenario_all_at_once(),
+            scenario_idle()};
+}
@@ -0,0 +1,289 @@
+// kungfu_chess_bench – micro-benchmarks for the engine hot paths.
+//
+// Usage: kungfu_chess_bench [--pieces DIR] [--img opencv|mock] [--filter TEXT]
+//                           [--samples N] [--min-sample-ms MS]
+//                           [--json OUT.json] [--baseline BASE.json] [--threshold 0.05]
+//
+// With --baseline the run is compared against a previous --json file and the
+// exit code is 1 when any benchmark regressed.  Built without OpenCV only
+// --img mock is available.
+#include "Bench.hpp"
+
+#include "Game.hpp"
+#include "LayoutGenerator.hpp"
+#include "Log.hpp"
+#include "img/MockImg.hpp"
+#ifdef KFC_HAVE_OPENCV
+#include "img/OpenCvImg.hpp"
+#endif
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+PiecePtr find_piece(const Game &game, const std::string &id)
+{
+    for (const auto &p : game.pieces)
+        if (p->id == id)
+            return p;
+    throw std::runtime_error("No piece " + id);
+}
+
+Cell2Pieces cell_map(const Game &game)
+{
+    Cell2Pieces c;
+    for (const auto &p : game.pieces)
+        c[p->current_cell()].push_back(p);
+    return c;
+}
+
+std::unordered_set<std::pair<int, int>, PairHash> occupied(const Game &game)
+{
+    std::unordered_set<std::pair<int, int>, PairHash> s;
+    for (const auto &p : game.pieces)
+        s.insert(p->current_cell());
+    return s;
+}
+
+// Opening with pieces in flight, the typical state of a busy tick
+void play_opening(Game &game)
+{
+    game.reset_pieces(0);
+    game.enqueue_command(Command{0, "PW_(6,4)", "move", {{6, 4}, {4, 4}}});
+    game.enqueue_command(Command{0, "PB_(1,3)", "move", {{1, 3}, {3, 3}}});
+    game.enqueue_command(Command{0, "NW_(7,6)", "move", {{7, 6}, {5, 5}}});
+    game.enqueue_command(Command{0, "NB_(0,1)", "move", {{0, 1}, {2, 2}}});
+    for (int t = 0; t <= 160; t += 16)
+        game.advance(t);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    BenchOptions opt;
+    std::string pieces_root = "../../pieces/";
+#ifdef KFC_HAVE_OPENCV
+    std::string img = "opencv";
+#else
+    std::string img = "mock";
+#endif
+    std::string json_out, baseline;
+    double threshold = 0.05;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--pieces")
+            pieces_root = val;
+        else if (arg == "--img")
+            img = val;
+        else if (arg == "--filter")
+            opt.filter = val;
+        else if (arg == "--samples")
+            opt.samples = std::max(3, std::stoi(val));
+        else if (arg == "--min-sample-ms")
+            opt.min_sample_ms = std::stod(val);
+        else if (arg == "--json")
+            json_out = val;
+        else if (arg == "--baseline")
+            baseline = val;
+        else if (arg == "--threshold")
+            threshold = std::stod(val);
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (img != "opencv" && img != "mock")
+    {
+        std::cerr << "--img must be opencv or mock" << std::endl;
+        return 2;
+    }
+
+    set_log_enabled(false);
+    ImgFactoryPtr factory;
+    if (img == "mock")
+        factory = std::make_shared<MockImgFactory>();
+    else
+    {
+#ifdef KFC_HAVE_OPENCV
+        factory = std::make_shared<OpenCvImgFactory>();
+#else
+        std::cerr << "Built without OpenCV; use --img mock" << std::endl;
+        return 2;
+#endif
+    }
+
+    std::unique_ptr<Game> game;
+    try
+    {
+        fs::path board_csv = fs::path(pieces_root) / "board.csv";
+        std::ifstream in(board_csv);
+        if (!in)
+            throw std::runtime_error("Cannot open " + board_csv.string());
+        GameSetup setup = load_game_setup(in, pieces_root, factory);
+        game = std::make_unique<Game>(setup.pieces, setup.board);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Cannot build the game (" << e.what() << "); try --img mock" << std::endl;
+        return 1;
+    }
+    game->reset_pieces(0);
+
+    BenchRunner bench(opt);
+
+    // --- move validation ---------------------------------------------------
+    {
+        auto queen = find_piece(*game, "QW_(7,4)");
+        const Moves &moves = *queen->state->moves;
+        auto cells = occupied(*game);
+        cells.erase({6, 4}); // open the queen's file
+        const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> probes = {
+            {{7, 4}, {2, 4}}, {{7, 4}, {1, 4}}, {{7, 4}, {6, 3}}, {{7, 4}, {5, 6}}, {{7, 4}, {4, 1}}, {{7, 4}, {5, 5}},
+        };
+        size_t i = 0;
+        bench.run("Moves::is_valid/queen", [&]
+                  {
+                      const auto &p = probes[i++ % probes.size()];
+                      bool ok = moves.is_valid(p.first, p.second, cells, true);
+                      do_not_optimize(ok); });
+        bench.run("Moves::path_is_clear/queen_file", [&]
+                  {
+                      bool ok = moves.path_is_clear({7, 4}, {1, 4}, cells);
+                      do_not_optimize(ok); });
+    }
+
+    // --- per-tick engine steps -----------------------------------------------
+    play_opening(*game);
+    bench.run("Game::update_cell2piece_map", [&]
+              { game->update_cell2piece_map(); });
+    bench.run("Game::resolve_collisions/opening", [&]
+              { game->resolve_collisions(); });
+
+    {
+        game->reset_pieces(0);
+        auto pawn = find_piece(*game, "PW_(6,0)");
+        auto c2p = cell_map(*game);
+        const Command move{0, pawn->id, "move", {{6, 0}, {5, 0}}};
+        bench.run("State::on_command/pawn_move", [&]
+                  {
+                      auto next = pawn->state->on_command(move, c2p);
+                      do_not_optimize(next); });
+    }
+    {
+        auto knight = find_piece(*game, "NW_(7,1)");
+        auto &gfx = *knight->state->graphics;
+        int now = 0;
+        bench.run("Graphics::update", [&]
+                  { gfx.update(now += 16); });
+    }
+
+    // --- input ---------------------------------------------------------------
+    {
+        KeyboardProcessor kp(8, 8, {{"up", "up"}, {"down", "down"}, {"left", "left"}, {"right", "right"}});
+        const KeyCode keys[] = {key_code::Up, key_code::Right, key_code::Down, key_code::Left};
+        size_t i = 0;
+        bench.run("KeyboardProcessor::process_code", [&]
+                  {
+                      KeyAction a = kp.process_code(keys[i++ & 3]);
+                      do_not_optimize(a); });
+        std::vector<Command> queue;
+        std::mutex mtx;
+        KeyboardProducer producer(queue, mtx, kp, 1);
+        const int raw[] = {1072, 1077, 1080, 1075};
+        bench.run("KeyboardProducer::handle_opencv_key/arrow", [&]
+                  { producer.handle_opencv_key(raw[i++ & 3]); });
+    }
+    {
+        // 1000 random keys for both players, then one simulation step; a
+        // game of its own, since the keys capture pieces
+        Game fuzz_game = create_game(pieces_root, factory);
+        fuzz_game.reset_pieces(0);
+        FuzzSource fuzz(1, 1000);
+        int t = 0;
+        bench.run("Game::feed_input/fuzz_1000_keys", [&]
+                  {
+                      size_t n = fuzz_game.feed_input(fuzz, t);
+                      fuzz_game.advance(t++);
+                      do_not_optimize(n); });
+    }
+
+    // --- large boards ----------------------------------------------------------
+    // One tick on generated boards of growing size (half the cells taken, at
+    // most 10k pieces) with the same few pieces in play: 16 jumps every 32
+    // ticks.  The figures should stay flat as the idle crowd grows.
+    for (int side : {8, 32, 64, 128, 256})
+    {
+        int count = std::min(10000, side * side / 2);
+        std::string name = "Game::advance/board_" + std::to_string(side) + "x" + std::to_string(side) + "_" +
+                           std::to_string(count);
+        if (!bench.wanted(name))
+            continue;
+        std::istringstream layout(generate_layout(side, side, count));
+        Game big = create_game(layout, pieces_root, factory);
+        big.reset_pieces(0);
+        int t = 0;
+        size_t next = 0;
+        uint64_t tick = 0;
+        bench.run(name, [&]
+                  {
+                      if (tick++ % 32 == 0)
+                          for (int k = 0; k < 16; ++k)
+                          {
+                              const auto &p = big.pieces[next++ % big.pieces.size()];
+                              big.enqueue_command(Command{t, p->id, "jump", {p->current_cell()}});
+                          }
+                      big.advance(t += 16); });
+    }
+
+    // --- rendering -----------------------------------------------------------
+#ifdef KFC_HAVE_OPENCV
+    {
+        OpenCvImgFactory cv;
+        ImgPtr canvas = cv.create_blank(512, 512);
+        ImgPtr sprite = cv.create_blank(64, 64);
+        bench.run("OpenCvImg::draw_on/64x64", [&]
+                  { sprite->draw_on(*canvas, 192, 256); });
+        // The profiler HUD: a dozen lines of unchanged text
+        std::vector<std::string> hud = game->profiler.hud_lines();
+        bench.run("OpenCvImg::put_text/hud", [&]
+                  {
+                      int y = 16;
+                      for (const auto &line : hud)
+                      {
+                          canvas->put_text(line, 8, y, 0.4);
+                          y += 14;
+                      } });
+    }
+#else
+    bench.skip("OpenCvImg::draw_on/64x64", "built without OpenCV");
+    bench.skip("OpenCvImg::put_text/hud", "built without OpenCV");
+#endif
+    play_opening(*game);
+    bench.run(std::string("Game::render_frame/") + img, [&]
+              {
+                  Board frame = game->render_frame(game->sim_time_ms());
+                  do_not_optimize(frame); });
+
+    // --- startup -----------------------------------------------------------
+    bench.run(std::string("create_game/") + img, [&]
+              {
+                  Game g = create_game(pieces_root, factory);
+                  do_not_optimize(g); });
+
+    nlohmann::json context = {{"img", img}, {"samples", opt.samples}, {"min_sample_ms", opt.min_sample_ms}};
+    if (!json_out.empty())
+    {
+        std::ofstream out(json_out);
+        out << bench.to_json(context).dump(2) << std::endl;
+    }
+    if (!baseline.empty())
+        return bench.compare(baseline, threshold) > 0 ? 1 : 0;
+    return 0;
+}
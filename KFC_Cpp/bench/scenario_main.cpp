@@ -0,0 +1,291 @@
+// kungfu_chess_scenarios – scripted full games run end to end through Game.
+//
+// Usage: kungfu_chess_scenarios [--pieces DIR] [--filter TEXT] [--repeat N]
+//                               [--render mock|opencv|both] [--step-ms 16]
+//                               [--json OUT.json] [--baseline BASE.json]
+//
+// Every scenario is played headless on a virtual clock.  "mock" runs the
+// simulation alone with MockImgFactory; "opencv" also composes every frame
+// offscreen with OpenCvImgFactory, timing simulation and rendering apart.
+// With --baseline the final-state hashes are compared against a previous
+// --json file and the exit code is 1 when any game ended differently.
+// Built without OpenCV the opencv runs are reported as skipped.
+#include "Bench.hpp"
+#include "Scenarios.hpp"
+
+#include "Game.hpp"
+#include "Log.hpp"
+#include "img/MockImg.hpp"
+#ifdef KFC_HAVE_OPENCV
+#include "img/OpenCvImg.hpp"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+struct ScenarioResult
+{
+    std::string scenario;
+    std::string render;
+    int ticks{0};
+    int commands{0};
+    int captures{0};
+    double sim_s{0};    // best run
+    double render_s{0}; // best run, 0 without rendering
+    // getrusage reports the process's high-water mark, not a scenario's:
+    // the peak so far and how far this scenario raised it
+    long process_peak_kb{0};
+    long peak_growth_kb{0};
+    uint64_t state_hash{0};
+};
+
+// Process-wide peak resident set size so far (0 where unsupported)
+long peak_rss_kb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024; // bytes there
+#else
+    return ru.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::string hex(uint64_t v)
+{
+    char buf[17];
+    std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+struct Options
+{
+    std::string pieces_root = "../../pieces/";
+    std::string filter;
+    std::string render = "both";
+    int repeat{3};
+    int step_ms{16};
+};
+
+// One play-through; returns the game for the final-state figures
+std::unique_ptr<Game> play(const Scenario &sc, const Options &opt, const ImgFactoryPtr &factory, bool render,
+                           ScenarioResult &r, double &sim_s, double &render_s)
+{
+    using clock = std::chrono::steady_clock;
+    fs::path board_csv = fs::path(opt.pieces_root) / "board.csv";
+    std::ifstream in(board_csv);
+    if (!in)
+        throw std::runtime_error("Cannot open " + board_csv.string());
+    GameSetup setup = load_game_setup(in, opt.pieces_root, factory);
+    auto game = std::make_unique<Game>(setup.pieces, setup.board);
+    game->reset_pieces(0);
+    const size_t start_pieces = game->pieces.size();
+
+    sim_s = render_s = 0;
+    size_t next = 0;
+    int ticks = 0;
+    for (int t = 0; t <= sc.duration_ms; t += opt.step_ms)
+    {
+        auto t0 = clock::now();
+        while (next < sc.commands.size() && sc.commands[next].timestamp <= t)
+            game->enqueue_command(sc.commands[next++]);
+        game->advance(t);
+        auto t1 = clock::now();
+        sim_s += std::chrono::duration<double>(t1 - t0).count();
+        if (render)
+        {
+            Board frame = game->render_frame(t);
+            do_not_optimize(frame);
+            render_s += std::chrono::duration<double>(clock::now() - t1).count();
+        }
+        ++ticks;
+    }
+    r.ticks = ticks;
+    r.commands = static_cast<int>(next);
+    r.captures = static_cast<int>(start_pieces - game->pieces.size());
+    return game;
+}
+
+ScenarioResult run_scenario(const Scenario &sc, const Options &opt, const ImgFactoryPtr &factory,
+                            const std::string &render_name)
+{
+    bool render = render_name == "opencv";
+    ScenarioResult r;
+    r.scenario = sc.name;
+    r.render = render_name;
+    r.sim_s = r.render_s = 1e30;
+    const long peak_before = peak_rss_kb();
+    for (int i = 0; i < opt.repeat; ++i)
+    {
+        double sim_s, render_s;
+        auto game = play(sc, opt, factory, render, r, sim_s, render_s);
+        r.sim_s = std::min(r.sim_s, sim_s);
+        r.render_s = render ? std::min(r.render_s, render_s) : 0.0;
+        std::vector<uint8_t> state = game->snapshot();
+        uint64_t h = fnv1a(state.data(), state.size());
+        if (i > 0 && h != r.state_hash)
+            std::cerr << sc.name << ": run " << i << " ended in a different state" << std::endl;
+        r.state_hash = h;
+    }
+    r.process_peak_kb = peak_rss_kb();
+    r.peak_growth_kb = r.process_peak_kb - peak_before;
+    return r;
+}
+
+void print_header()
+{
+    std::printf("%-14s %-7s %7s %5s %4s %12s %12s %12s %13s %10s  %s\n", "scenario", "render", "ticks", "cmds",
+                "capt", "sim ticks/s", "cmds/s", "render fps", "peak so far", "growth", "final state");
+}
+
+void print(const ScenarioResult &r)
+{
+    double tps = r.sim_s > 0 ? r.ticks / r.sim_s : 0;
+    double cps = r.sim_s > 0 ? r.commands / r.sim_s : 0;
+    double fps = r.render_s > 0 ? r.ticks / r.render_s : 0;
+    std::printf("%-14s %-7s %7d %5d %4d %12.0f %12.0f %12.0f %10ld KB %7ld KB  %s\n", r.scenario.c_str(),
+                r.render.c_str(), r.ticks, r.commands, r.captures, tps, cps, fps, r.process_peak_kb, r.peak_growth_kb,
+                hex(r.state_hash).c_str());
+}
+
+nlohmann::json to_json(const ScenarioResult &r)
+{
+    nlohmann::json j = {{"scenario", r.scenario},
+                        {"render", r.render},
+                        {"ticks", r.ticks},
+                        {"commands", r.commands},
+                        {"captures", r.captures},
+                        {"sim_s", r.sim_s},
+                        {"ticks_per_s", r.sim_s > 0 ? r.ticks / r.sim_s : 0.0},
+                        {"commands_per_s", r.sim_s > 0 ? r.commands / r.sim_s : 0.0},
+                        {"process_peak_rss_kb", r.process_peak_kb},
+                        {"peak_growth_kb", r.peak_growth_kb},
+                        {"state_hash", hex(r.state_hash)}};
+    if (r.render_s > 0)
+    {
+        j["render_s"] = r.render_s;
+        j["render_fps"] = r.ticks / r.render_s;
+    }
+    return j;
+}
+
+// Number of scenarios whose final state differs from the baseline
+int compare_hashes(const std::vector<ScenarioResult> &results, const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open baseline " + path);
+    nlohmann::json base = nlohmann::json::parse(in);
+    std::map<std::string, std::string> old;
+    for (const auto &s : base.at("scenarios"))
+        old[s.at("scenario").get<std::string>() + "/" + s.at("render").get<std::string>()] =
+            s.at("state_hash").get<std::string>();
+    int diverged = 0;
+    for (const auto &r : results)
+    {
+        auto it = old.find(r.scenario + "/" + r.render);
+        if (it == old.end() || it->second == hex(r.state_hash))
+            continue;
+        std::cout << r.scenario << "/" << r.render << ": final state " << hex(r.state_hash) << ", baseline "
+                  << it->second << std::endl;
+        ++diverged;
+    }
+    std::cout << diverged << " scenario(s) diverged from the baseline" << std::endl;
+    return diverged;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::string json_out, baseline;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--pieces")
+            opt.pieces_root = val;
+        else if (arg == "--filter")
+            opt.filter = val;
+        else if (arg == "--repeat")
+            opt.repeat = std::max(1, std::stoi(val));
+        else if (arg == "--render")
+            opt.render = val;
+        else if (arg == "--step-ms")
+            opt.step_ms = std::max(1, std::stoi(val));
+        else if (arg == "--json")
+            json_out = val;
+        else if (arg == "--baseline")
+            baseline = val;
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (opt.render != "mock" && opt.render != "opencv" && opt.render != "both")
+    {
+        std::cerr << "--render must be mock, opencv or both" << std::endl;
+        return 2;
+    }
+
+    set_log_enabled(false);
+    std::vector<std::pair<std::string, ImgFactoryPtr>> modes;
+    if (opt.render != "opencv")
+        modes.emplace_back("mock", std::make_shared<MockImgFactory>());
+#ifdef KFC_HAVE_OPENCV
+    if (opt.render != "mock")
+        modes.emplace_back("opencv", std::make_shared<OpenCvImgFactory>());
+#endif
+
+    std::vector<ScenarioResult> results;
+    print_header();
+#ifndef KFC_HAVE_OPENCV
+    if (opt.render != "mock")
+        std::printf("%-14s %-7s skipped: built without OpenCV\n", "*", "opencv");
+#endif
+    for (const auto &mode : modes)
+        for (const auto &sc : all_scenarios())
+        {
+            if (!opt.filter.empty() && sc.name.find(opt.filter) == std::string::npos)
+                continue;
+            try
+            {
+                results.push_back(run_scenario(sc, opt, mode.second, mode.first));
+                print(results.back());
+            }
+            catch (const std::exception &e)
+            {
+                std::printf("%-14s %-7s skipped: %s\n", sc.name.c_str(), mode.first.c_str(), e.what());
+            }
+        }
+
+    if (!json_out.empty())
+    {
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto &r : results)
+            list.push_back(to_json(r));
+        nlohmann::json doc = {{"context", {{"repeat", opt.repeat}, {"step_ms", opt.step_ms}}}, {"scenarios", list}};
+        std::ofstream out(json_out);
+        out << doc.dump(2) << std::endl;
+    }
+    if (!baseline.empty())
+        return compare_hashes(results, baseline) > 0 ? 1 : 0;
+    return 0;
+}
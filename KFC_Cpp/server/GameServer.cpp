@@ -0,0 +1,552 @@
+#include "GameServer.hpp"
+#include "img/MockImg.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void check(bool ok, const char *what)
+{
+    if (!ok)
+        throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+} // namespace
+
+GameServer::GameServer(ServerConfig c) : cfg(std::move(c)) {}
+
+GameServer::~GameServer()
+{
+    stop();
+    for (auto &w : workers)
+        if (w->thread.joinable())
+            w->thread.join();
+    for (auto &kv : clients)
+        close(kv.second.fd);
+    if (listen_fd >= 0)
+        close(listen_fd);
+    if (wake_fd >= 0)
+        close(wake_fd);
+    if (epoll_fd >= 0)
+        close(epoll_fd);
+}
+
+void GameServer::stop()
+{
+    running = false;
+    if (wake_fd >= 0)
+    {
+        uint64_t one = 1;
+        (void)!write(wake_fd, &one, sizeof one);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// epoll thread
+// ---------------------------------------------------------------------------
+void GameServer::run()
+{
+    // Parsing the pieces tree takes a while: do it once, not per match on a
+    // worker that is ticking other matches
+    match_template = std::make_unique<MatchTemplate>(cfg.pieces_root, std::make_shared<MockImgFactory>());
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    check(listen_fd >= 0, "socket");
+    int yes = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(cfg.port);
+    check(bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) == 0, "bind");
+    check(listen(listen_fd, 512) == 0, "listen");
+    socklen_t len = sizeof addr;
+    getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    set_nonblocking(listen_fd);
+
+    epoll_fd = epoll_create1(0);
+    check(epoll_fd >= 0, "epoll_create1");
+    wake_fd = eventfd(0, EFD_NONBLOCK);
+    check(wake_fd >= 0, "eventfd");
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    started_at = std::chrono::steady_clock::now();
+    running = true;
+    for (int i = 0; i < std::max(1, cfg.workers); ++i)
+        workers.push_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i]->thread = std::thread(&GameServer::worker_loop, this, i);
+
+    std::vector<epoll_event> events(256);
+    while (running.load())
+    {
+        int n = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 100);
+        if (n < 0 && errno != EINTR)
+            break;
+        for (int i = 0; i < n; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd)
+            {
+                accept_clients();
+                continue;
+            }
+            if (fd == wake_fd)
+            {
+                uint64_t count;
+                (void)!read(wake_fd, &count, sizeof count);
+                drain_outbox();
+                continue;
+            }
+            auto it = fd_to_client.find(fd);
+            if (it == fd_to_client.end())
+                continue;
+            uint64_t id = it->second;
+            if (events[i].events & (EPOLLHUP | EPOLLERR))
+            {
+                close_client(id);
+                continue;
+            }
+            if (events[i].events & EPOLLIN)
+                read_client(clients[id]);
+            auto c = clients.find(id);
+            if (c != clients.end() && (events[i].events & EPOLLOUT))
+                flush_client(c->second);
+        }
+    }
+    running = false;
+    for (auto &w : workers)
+        if (w->thread.joinable())
+            w->thread.join();
+}
+
+void GameServer::accept_clients()
+{
+    while (true)
+    {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            return; // EAGAIN – backlog drained
+        set_nonblocking(fd);
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+        Connection c;
+        c.fd = fd;
+        c.id = next_client_id++;
+        fd_to_client[fd] = c.id;
+        clients.emplace(c.id, std::move(c));
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void GameServer::read_client(Connection &c)
+{
+    uint8_t chunk[16 * 1024];
+    uint64_t id = c.id;
+    while (true)
+    {
+        ssize_t n = recv(c.fd, chunk, sizeof chunk, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            close_client(id);
+            return;
+        }
+        if (n < 0)
+            break;
+        c.in.append(chunk, static_cast<size_t>(n));
+    }
+    try
+    {
+        MsgType type;
+        ByteReader payload(nullptr, 0);
+        while (c.in.next(type, payload))
+            handle_frame(c, type, payload);
+    }
+    catch (const std::exception &)
+    {
+        close_client(id); // malformed stream – drop the client
+    }
+}
+
+void GameServer::handle_frame(Connection &c, MsgType type, ByteReader &payload)
+{
+    switch (type)
+    {
+    case MsgType::Join:
+    {
+        if (c.match)
+            return;
+        Inbound in{};
+        in.conn = c.id;
+        if (waiting_match)
+        {
+            in.kind = Inbound::Seat;
+            in.match = waiting_match;
+            in.player = 2;
+            waiting_match = 0;
+        }
+        else
+        {
+            in.kind = Inbound::NewMatch;
+            in.match = next_match_id++;
+            in.player = 1;
+            match_worker[in.match] = in.match % workers.size();
+            waiting_match = in.match;
+        }
+        c.match = in.match;
+        c.player = in.player;
+        auto &w = *workers[match_worker[in.match]];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        w.inbox.push_back(std::move(in));
+        return;
+    }
+    case MsgType::Cmd:
+    {
+        CmdMsg cmd = read_cmd(payload);
+        if (!c.match)
+        {
+            ByteWriter w;
+            w.varint(cmd.seq);
+            w.u8(static_cast<uint8_t>(Verdict::NotInMatch));
+            w.svarint(0);
+            send_to(c, MsgType::Ack, w);
+            return;
+        }
+        Inbound in{};
+        in.kind = Inbound::Command;
+        in.match = c.match;
+        in.conn = c.id;
+        in.player = c.player;
+        in.cmd = cmd;
+        auto &w = *workers[match_worker[c.match]];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        w.inbox.push_back(std::move(in));
+        return;
+    }
+    case MsgType::StatsReq:
+    {
+        ServerStatsMsg s;
+        s.games = live_games.load();
+        s.workers = workers.size();
+        s.busy_us = busy_ns.load() / 1000;
+        s.wall_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                              std::chrono::steady_clock::now() - started_at)
+                                              .count());
+        s.ticks = ticks_total.load();
+        s.commands = commands_total.load();
+        ByteWriter w;
+        write_stats(w, s);
+        send_to(c, MsgType::Stats, w);
+        return;
+    }
+    default:
+        return; // server-to-client types are ignored
+    }
+}
+
+void GameServer::send_to(Connection &c, MsgType type, const ByteWriter &payload)
+{
+    append_frame(c.out, type, payload);
+    flush_client(c);
+}
+
+void GameServer::flush_client(Connection &c)
+{
+    while (c.out_head < c.out.size())
+    {
+        ssize_t n = send(c.fd, c.out.data() + c.out_head, c.out.size() - c.out_head, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EINTR)
+                continue;
+            // Broken pipe: let epoll report the hang-up and close it there,
+            // callers may still be walking this connection's input.
+            shutdown(c.fd, SHUT_RDWR);
+            c.out.clear();
+            c.out_head = 0;
+            return;
+        }
+        c.out_head += static_cast<size_t>(n);
+    }
+    bool pending = c.out_head < c.out.size();
+    if (!pending)
+    {
+        c.out.clear();
+        c.out_head = 0;
+    }
+    if (pending != c.want_write)
+    {
+        c.want_write = pending;
+        epoll_event ev{};
+        ev.events = EPOLLIN | (pending ? uint32_t(EPOLLOUT) : 0u);
+        ev.data.fd = c.fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c.fd, &ev);
+    }
+}
+
+void GameServer::close_client(uint64_t id)
+{
+    auto it = clients.find(id);
+    if (it == clients.end())
+        return;
+    Connection &c = it->second;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, nullptr);
+    close(c.fd);
+    fd_to_client.erase(c.fd);
+    if (c.match)
+    {
+        if (waiting_match == c.match)
+            waiting_match = 0;
+        Inbound in{};
+        in.kind = Inbound::Leave;
+        in.match = c.match;
+        in.conn = c.id;
+        in.player = c.player;
+        auto &w = *workers[match_worker[c.match]];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        w.inbox.push_back(std::move(in));
+    }
+    clients.erase(it);
+}
+
+void GameServer::drain_outbox()
+{
+    std::vector<Outbound> batch;
+    std::vector<Ended> done;
+    {
+        std::lock_guard<std::mutex> lock(outbox_mtx);
+        batch.swap(outbox);
+        done.swap(ended);
+    }
+    // Free the players before their GameOver goes out, so a Join sent in
+    // reply to it starts a new match
+    for (const Ended &e : done)
+    {
+        match_worker.erase(e.match);
+        if (waiting_match == e.match)
+            waiting_match = 0;
+        for (uint64_t p : e.players)
+        {
+            auto it = clients.find(p);
+            if (it != clients.end() && it->second.match == e.match)
+            {
+                it->second.match = 0;
+                it->second.player = 0;
+            }
+        }
+    }
+    std::vector<uint64_t> touched;
+    for (auto &o : batch)
+    {
+        auto it = clients.find(o.conn);
+        if (it == clients.end())
+            continue; // client left in the meantime
+        auto &out = it->second.out;
+        out.insert(out.end(), o.bytes.begin(), o.bytes.end());
+        touched.push_back(o.conn);
+    }
+    for (uint64_t id : touched)
+    {
+        auto it = clients.find(id);
+        if (it != clients.end() && it->second.out_head < it->second.out.size())
+            flush_client(it->second);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Simulation workers
+// ---------------------------------------------------------------------------
+void GameServer::post(uint64_t conn, MsgType type, const ByteWriter &payload)
+{
+    Outbound o{conn, {}};
+    append_frame(o.bytes, type, payload);
+    {
+        std::lock_guard<std::mutex> lock(outbox_mtx);
+        outbox.push_back(std::move(o));
+    }
+}
+
+void GameServer::worker_loop(size_t index)
+{
+    using clock = std::chrono::steady_clock;
+    Worker &self = *workers[index];
+    const auto period = std::chrono::nanoseconds(1000000000LL / std::max(1, cfg.tick_hz));
+    auto next_tick = clock::now();
+    std::vector<Inbound> batch;
+    ByteWriter scratch;
+
+    auto game_ms = [](const MatchSlot &m)
+    {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - m.started).count());
+    };
+    auto find = [&](uint32_t id) -> MatchSlot *
+    {
+        for (auto &m : self.matches)
+            if (m.id == id)
+                return &m;
+        return nullptr;
+    };
+    auto joined = [&](const MatchSlot &m, uint64_t conn, int player)
+    {
+        const Board &b = m.match->game().board;
+        ByteWriter w;
+        w.varint(m.id);
+        w.u8(static_cast<uint8_t>(player));
+        w.varint(static_cast<uint64_t>(b.H_cells));
+        w.varint(static_cast<uint64_t>(b.W_cells));
+        post(conn, MsgType::Joined, w);
+    };
+    // Queued ahead of the GameOver, which the epoll thread drains after it
+    auto finish = [&](MatchSlot &m)
+    {
+        m.finished = true;
+        std::lock_guard<std::mutex> lock(outbox_mtx);
+        ended.push_back(Ended{m.id, {m.players[0], m.players[1]}});
+    };
+
+    while (running.load())
+    {
+        next_tick += period;
+        auto now = clock::now();
+        if (next_tick < now - period)
+            next_tick = now; // fell behind – do not try to catch up in a burst
+        std::this_thread::sleep_until(next_tick);
+        auto work_start = clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(self.mtx);
+            batch.swap(self.inbox);
+        }
+        bool produced = false;
+        for (auto &in : batch)
+        {
+            switch (in.kind)
+            {
+            case Inbound::NewMatch:
+            {
+                MatchSlot slot;
+                slot.id = in.match;
+                slot.match = match_template->create();
+                slot.players[0] = in.conn;
+                slot.started = clock::now();
+                self.matches.push_back(std::move(slot));
+                ++live_games;
+                joined(self.matches.back(), in.conn, 1);
+                produced = true;
+                break;
+            }
+            case Inbound::Seat:
+                if (auto *m = find(in.match))
+                {
+                    m->players[1] = in.conn;
+                    m->stream.request_keyframe();
+                    joined(*m, in.conn, 2);
+                    produced = true;
+                }
+                break;
+            case Inbound::Command:
+            {
+                auto *m = find(in.match);
+                int t = m ? game_ms(*m) : 0;
+                Verdict v = m && !m->finished ? m->match->submit(in.player, in.cmd, t) : Verdict::NotInMatch;
+                ByteWriter w;
+                w.varint(in.cmd.seq);
+                w.u8(static_cast<uint8_t>(v));
+                w.svarint(t);
+                post(in.conn, MsgType::Ack, w);
+                ++commands_total;
+                produced = true;
+                break;
+            }
+            case Inbound::Leave:
+                if (auto *m = find(in.match); m && !m->finished)
+                {
+                    finish(*m);
+                    uint64_t other = m->players[0] == in.conn ? m->players[1] : m->players[0];
+                    if (other)
+                    {
+                        ByteWriter w;
+                        w.u8(0);
+                        post(other, MsgType::GameOver, w);
+                    }
+                    produced = true;
+                }
+                break;
+            }
+        }
+        batch.clear();
+
+        for (auto &m : self.matches)
+        {
+            if (m.finished)
+                continue;
+            m.match->tick(game_ms(m));
+            ++m.ticks;
+            bool over = m.match->over();
+            if (over || m.ticks % static_cast<uint64_t>(std::max(1, cfg.broadcast_every)) == 0)
+            {
+                scratch.clear();
+                if (m.stream.encode(m.match->game(), scratch) > 0)
+                {
+                    for (uint64_t p : m.players)
+                        if (p)
+                            post(p, MsgType::State, scratch);
+                    produced = true;
+                }
+            }
+            if (over)
+            {
+                finish(m);
+                ByteWriter w;
+                w.u8(static_cast<uint8_t>(m.match->winner()));
+                for (uint64_t p : m.players)
+                    if (p)
+                        post(p, MsgType::GameOver, w);
+                produced = true;
+            }
+        }
+        size_t before = self.matches.size();
+        self.matches.erase(std::remove_if(self.matches.begin(), self.matches.end(),
+                                          [](const MatchSlot &m)
+                                          { return m.finished; }),
+                           self.matches.end());
+        live_games -= before - self.matches.size();
+
+        if (produced)
+        {
+            uint64_t one = 1;
+            (void)!write(wake_fd, &one, sizeof one);
+        }
+        busy_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - work_start).count());
+        ++ticks_total;
+    }
+}
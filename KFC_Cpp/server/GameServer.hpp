@@ -0,0 +1,148 @@
+#pragma once
+
+#include "net/Match.hpp"
+#include "net/Protocol.hpp"
+#include "net/SpectatorStream.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ServerConfig
+{
+    uint16_t port{7777};
+    int workers{2};           // simulation threads
+    int tick_hz{60};          // simulation rate of every match
+    int broadcast_every{6};   // ticks between state broadcasts (10 Hz at 60 Hz)
+    std::string pieces_root{"../../pieces/"};
+};
+
+// ---------------------------------------------------------------------------
+// Headless authoritative server.  One epoll thread owns every socket; matches
+// are sharded over a small pool of simulation workers, each of which owns its
+// matches outright (no locking inside a tick).  The two sides talk through a
+// locked inbox per worker and a shared outbox drained by the epoll thread,
+// which an eventfd wakes up.
+// ---------------------------------------------------------------------------
+class GameServer
+{
+public:
+    explicit GameServer(ServerConfig cfg);
+    ~GameServer();
+
+    GameServer(const GameServer &) = delete;
+    GameServer &operator=(const GameServer &) = delete;
+
+    // Bind, start the workers and serve until stop() is called.
+    void run();
+    // Thread-safe; run() returns shortly after.
+    void stop();
+
+    uint16_t bound_port() const { return port.load(); }
+
+private:
+    struct Connection
+    {
+        int fd{-1};
+        uint64_t id{0};
+        FrameBuffer in;
+        std::vector<uint8_t> out;
+        size_t out_head{0};
+        bool want_write{false};
+        uint32_t match{0};
+        int player{0};
+    };
+
+    // Work handed from the epoll thread to a simulation worker
+    struct Inbound
+    {
+        enum Kind
+        {
+            NewMatch, // create the match, conn becomes player 1
+            Seat,     // conn joins as player 2
+            Command,
+            Leave
+        } kind;
+        uint32_t match;
+        uint64_t conn;
+        int player;
+        CmdMsg cmd;
+    };
+
+    struct Outbound
+    {
+        uint64_t conn;
+        std::vector<uint8_t> bytes;
+    };
+
+    // A match a worker has dropped; its players may join another one
+    struct Ended
+    {
+        uint32_t match;
+        uint64_t players[2];
+    };
+
+    struct MatchSlot
+    {
+        uint32_t id;
+        std::unique_ptr<Match> match;
+        SpectatorEncoder stream;
+        uint64_t players[2]{0, 0};
+        std::chrono::steady_clock::time_point started;
+        uint64_t ticks{0};
+        bool finished{false};
+    };
+
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex mtx;
+        std::vector<Inbound> inbox;
+        std::vector<MatchSlot> matches; // owned by the worker thread
+    };
+
+    // epoll thread
+    void accept_clients();
+    void read_client(Connection &c);
+    void handle_frame(Connection &c, MsgType type, ByteReader &payload);
+    void flush_client(Connection &c);
+    void close_client(uint64_t id);
+    void drain_outbox();
+    void send_to(Connection &c, MsgType type, const ByteWriter &payload);
+
+    // worker threads
+    void worker_loop(size_t index);
+    void post(uint64_t conn, MsgType type, const ByteWriter &payload);
+
+    ServerConfig cfg;
+    std::atomic<bool> running{false};
+    std::atomic<uint16_t> port{0};
+    int listen_fd{-1};
+    int epoll_fd{-1};
+    int wake_fd{-1};
+
+    std::unordered_map<uint64_t, Connection> clients; // by connection id
+    std::unordered_map<int, uint64_t> fd_to_client;
+    uint64_t next_client_id{1};
+    uint32_t next_match_id{1};
+    uint32_t waiting_match{0}; // match with one seated player, if any
+    std::unordered_map<uint32_t, size_t> match_worker;
+
+    std::unique_ptr<MatchTemplate> match_template; // assets, parsed in run()
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex outbox_mtx;
+    std::vector<Outbound> outbox;
+    std::vector<Ended> ended; // under outbox_mtx
+
+    // Statistics
+    std::chrono::steady_clock::time_point started_at;
+    std::atomic<uint64_t> busy_ns{0};
+    std::atomic<uint64_t> ticks_total{0};
+    std::atomic<uint64_t> commands_total{0};
+    std::atomic<uint64_t> live_games{0};
+};
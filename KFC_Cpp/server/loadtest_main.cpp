@@ -0,0 +1,323 @@
+// Load generator for kungfu_chess_server.
+//
+// Opens two connections per game, pairs them through Join and fires commands
+// at a fixed rate from both seats, measuring the time from send to Ack.  At
+// the end it asks the server for its statistics and reports how many games
+// one fully busy core could host.
+//
+// Usage: kungfu_chess_loadtest [--host 127.0.0.1] [--port 7777] [--games 100]
+//                              [--seconds 10] [--rate 5]   (commands/s/player)
+#include "net/Protocol.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+struct Client
+{
+    int fd{-1};
+    int player{0};
+    FrameBuffer in;
+    std::vector<uint8_t> out;
+    size_t out_head{0};
+    uint64_t next_seq{1};
+    std::unordered_map<uint64_t, clock_type::time_point> pending;
+    clock_type::time_point next_send;
+    int opening{0}; // legal pawn pushes sent so far
+    bool over{false};
+};
+
+struct Totals
+{
+    std::vector<double> latency_us;
+    uint64_t accepted{0}, refused{0};
+    uint64_t state_msgs{0}, state_bytes{0};
+    uint64_t games_over{0};
+};
+
+int connect_to(const std::string &host, uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+void flush(Client &c)
+{
+    while (c.out_head < c.out.size())
+    {
+        ssize_t n = send(c.fd, c.out.data() + c.out_head, c.out.size() - c.out_head, MSG_NOSIGNAL);
+        if (n <= 0)
+            break;
+        c.out_head += static_cast<size_t>(n);
+    }
+    if (c.out_head == c.out.size())
+    {
+        c.out.clear();
+        c.out_head = 0;
+    }
+}
+
+void send_msg(Client &c, MsgType type, const ByteWriter &payload)
+{
+    append_frame(c.out, type, payload);
+    flush(c);
+}
+
+// Opening pawn pushes are always legal, the rest is random traffic from the
+// player's own home rows so the server has to reject a share of it.
+CmdMsg next_command(Client &c, std::mt19937 &rng)
+{
+    CmdMsg m;
+    m.seq = c.next_seq++;
+    bool white = c.player == 1;
+    if (c.opening < 8)
+    {
+        int col = c.opening++;
+        m.from = {white ? 6 : 1, col};
+        m.to = {white ? 5 : 2, col};
+        return m;
+    }
+    std::uniform_int_distribution<int> col(0, 7), row(0, 7), kind(0, 9);
+    m.kind = kind(rng) == 0 ? CmdKind::Jump : CmdKind::Move;
+    m.from = {white ? 6 + (col(rng) & 1) : (col(rng) & 1), col(rng)};
+    m.to = m.kind == CmdKind::Jump ? m.from : std::make_pair(row(rng), col(rng));
+    return m;
+}
+
+// Blocking request/response on the control connection
+bool fetch_stats(int fd, ServerStatsMsg &stats)
+{
+    std::vector<uint8_t> out;
+    append_frame(out, MsgType::StatsReq, ByteWriter{});
+    if (send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size()))
+        return false;
+    FrameBuffer in;
+    uint8_t chunk[4096];
+    MsgType type;
+    ByteReader r(nullptr, 0);
+    while (true)
+    {
+        ssize_t got = recv(fd, chunk, sizeof chunk, 0);
+        if (got <= 0)
+            return false;
+        in.append(chunk, static_cast<size_t>(got));
+        while (in.next(type, r))
+            if (type == MsgType::Stats)
+            {
+                stats = read_stats(r);
+                return true;
+            }
+    }
+}
+
+double percentile(std::vector<double> &v, double p)
+{
+    if (v.empty())
+        return 0.0;
+    size_t k = static_cast<size_t>(p * static_cast<double>(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+    return v[k];
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 7777;
+    int games = 100;
+    double seconds = 10.0;
+    double rate = 5.0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--host")
+            host = val;
+        else if (arg == "--port")
+            port = static_cast<uint16_t>(std::stoi(val));
+        else if (arg == "--games")
+            games = std::stoi(val);
+        else if (arg == "--seconds")
+            seconds = std::stod(val);
+        else if (arg == "--rate")
+            rate = std::stod(val);
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    // Control connection: never joins, only samples the server counters so
+    // that the idle time before this run does not count.
+    int control = connect_to(host, port);
+    if (control < 0)
+    {
+        std::cerr << "connect failed: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    fcntl(control, F_SETFL, fcntl(control, F_GETFL, 0) & ~O_NONBLOCK);
+    ServerStatsMsg before;
+    fetch_stats(control, before);
+
+    int ep = epoll_create1(0);
+    std::vector<Client> clients(static_cast<size_t>(games) * 2);
+    auto start = clock_type::now();
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        Client &c = clients[i];
+        c.fd = connect_to(host, port);
+        if (c.fd < 0)
+        {
+            std::cerr << "connect failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, c.fd, &ev);
+        ByteWriter w;
+        w.varint(0);
+        send_msg(c, MsgType::Join, w);
+        // Spread the first command of each client over one send period
+        c.next_send = start + std::chrono::microseconds(static_cast<int64_t>(1e6 / rate * i / clients.size()));
+    }
+
+    const auto period = std::chrono::microseconds(static_cast<int64_t>(1e6 / rate));
+    const auto end = start + std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6));
+    Totals totals;
+    std::mt19937 rng(12345);
+    std::vector<epoll_event> events(512);
+    uint8_t chunk[64 * 1024];
+
+    auto on_frame = [&](Client &c, MsgType type, ByteReader &r)
+    {
+        switch (type)
+        {
+        case MsgType::Joined:
+            r.varint();
+            c.player = r.u8();
+            break;
+        case MsgType::Ack:
+        {
+            uint64_t seq = r.varint();
+            auto v = static_cast<Verdict>(r.u8());
+            auto it = c.pending.find(seq);
+            if (it != c.pending.end())
+            {
+                totals.latency_us.push_back(
+                    std::chrono::duration<double, std::micro>(clock_type::now() - it->second).count());
+                c.pending.erase(it);
+            }
+            (v == Verdict::Accepted ? totals.accepted : totals.refused)++;
+            break;
+        }
+        case MsgType::State:
+            ++totals.state_msgs;
+            totals.state_bytes += r.remaining() + 5;
+            break;
+        case MsgType::GameOver:
+            c.over = true;
+            ++totals.games_over;
+            break;
+        default:
+            break;
+        }
+    };
+
+    while (clock_type::now() < end)
+    {
+        auto now = clock_type::now();
+        for (auto &c : clients)
+        {
+            if (c.player == 0 || c.over || now < c.next_send)
+                continue;
+            CmdMsg m = next_command(c, rng);
+            c.pending[m.seq] = now;
+            ByteWriter w;
+            write_cmd(w, m);
+            send_msg(c, MsgType::Cmd, w);
+            c.next_send += period;
+        }
+
+        int n = epoll_wait(ep, events.data(), static_cast<int>(events.size()), 1);
+        for (int i = 0; i < n; ++i)
+        {
+            Client &c = clients[events[i].data.u64];
+            ssize_t got;
+            while ((got = recv(c.fd, chunk, sizeof chunk, 0)) > 0)
+            {
+                c.in.append(chunk, static_cast<size_t>(got));
+                MsgType type;
+                ByteReader r(nullptr, 0);
+                while (c.in.next(type, r))
+                    on_frame(c, type, r);
+            }
+            if (got == 0)
+            {
+                epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+                c.over = true;
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    ServerStatsMsg after;
+    bool have_stats = fetch_stats(control, after);
+    close(control);
+    for (auto &c : clients)
+        close(c.fd);
+    close(ep);
+
+    auto &lat = totals.latency_us;
+    std::cout << "games            " << games << " (" << clients.size() << " connections, "
+              << totals.games_over << " game-over notices)\n";
+    std::cout << "commands         " << lat.size() << " acked, " << totals.accepted << " accepted, "
+              << totals.refused << " refused in " << elapsed << " s\n";
+    std::cout << "ack latency us   p50 " << percentile(lat, 0.50) << "  p90 " << percentile(lat, 0.90)
+              << "  p99 " << percentile(lat, 0.99) << "  max "
+              << (lat.empty() ? 0.0 : *std::max_element(lat.begin(), lat.end())) << "\n";
+    std::cout << "state broadcast  " << totals.state_msgs << " msgs, "
+              << static_cast<double>(totals.state_bytes) / elapsed / 1024.0 << " KiB/s\n";
+    if (have_stats && after.busy_us > before.busy_us)
+    {
+        double busy = static_cast<double>(after.busy_us - before.busy_us);
+        double wall = static_cast<double>(after.wall_us - before.wall_us);
+        double cores_busy = busy / wall;
+        std::cout << "server           " << after.workers << " workers, " << after.ticks - before.ticks
+                  << " worker ticks, " << cores_busy * 100.0 << "% of one core busy\n";
+        std::cout << "games per core   " << static_cast<double>(games) / cores_busy << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "GameServer.hpp"
+#include "Log.hpp"
+
+#include <csignal>
+#include <iostream>
+#include <string>
+
+namespace
+{
+GameServer *g_server = nullptr;
+
+void on_signal(int)
+{
+    if (g_server)
+        g_server->stop();
+}
+} // namespace
+
+// Usage: kungfu_chess_server [--port N] [--workers N] [--tick-hz N]
+//                            [--broadcast-every N] [--pieces DIR]
+int main(int argc, char **argv)
+{
+    ServerConfig cfg;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--port")
+            cfg.port = static_cast<uint16_t>(std::stoi(val));
+        else if (arg == "--workers")
+            cfg.workers = std::stoi(val);
+        else if (arg == "--tick-hz")
+            cfg.tick_hz = std::stoi(val);
+        else if (arg == "--broadcast-every")
+            cfg.broadcast_every = std::stoi(val);
+        else if (arg == "--pieces")
+            cfg.pieces_root = val;
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    set_log_enabled(false);
+    GameServer server(cfg);
+    g_server = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cout << "KungFuChess server: port " << cfg.port << ", " << cfg.workers << " workers, "
+              << cfg.tick_hz << " Hz" << std::endl;
+    server.run();
+    g_server = nullptr;
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Counting replacements of the global allocation functions (see AllocStats.hpp).
+// They forward to malloc / free; only the thread-local counters are added.
+// Built as its own object library: only the tests and KFC_COUNT_ALLOCS builds
+// link it, the game and server keep the standard allocator.
+#include "AllocStats.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+inline void count_alloc(std::size_t n)
+{
+    auto &c = alloc_detail::t_counters;
+    ++c.allocs;
+    c.bytes += n;
+}
+
+inline void count_free(void *p)
+{
+    if (p)
+        ++alloc_detail::t_counters.frees;
+}
+
+void *alloc_or_throw(std::size_t n)
+{
+    count_alloc(n);
+    for (;;)
+    {
+        if (void *p = std::malloc(n ? n : 1))
+            return p;
+        std::new_handler h = std::get_new_handler();
+        if (!h)
+            throw std::bad_alloc();
+        h();
+    }
+}
+
+void *aligned_alloc_or_throw(std::size_t n, std::align_val_t al)
+{
+    count_alloc(n);
+    std::size_t a = static_cast<std::size_t>(al);
+    if (a < sizeof(void *))
+        a = sizeof(void *);
+    std::size_t size = (n + a - 1) / a * a; // aligned_alloc wants a multiple
+    if (size == 0)
+        size = a;
+    for (;;)
+    {
+#ifdef _WIN32
+        void *p = _aligned_malloc(size, a);
+#else
+        void *p = std::aligned_alloc(a, size);
+#endif
+        if (p)
+            return p;
+        std::new_handler h = std::get_new_handler();
+        if (!h)
+            throw std::bad_alloc();
+        h();
+    }
+}
+
+inline void aligned_free(void *p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// Tells alloc_hook_installed() this object was linked
+const bool g_registered = (alloc_detail::hook_linked = true);
+} // namespace
+
+void *operator new(std::size_t n) { return alloc_or_throw(n); }
+void *operator new[](std::size_t n) { return alloc_or_throw(n); }
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return alloc_or_throw(n);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return alloc_or_throw(n);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new(std::size_t n, std::align_val_t al) { return aligned_alloc_or_throw(n, al); }
+void *operator new[](std::size_t n, std::align_val_t al) { return aligned_alloc_or_throw(n, al); }
+
+void *operator new(std::size_t n, std::align_val_t al, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return aligned_alloc_or_throw(n, al);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t n, std::align_val_t al, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return aligned_alloc_or_throw(n, al);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+void operator delete[](void *p) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+void operator delete[](void *p, std::size_t) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    count_free(p);
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    count_free(p);
+    aligned_free(p);
+}
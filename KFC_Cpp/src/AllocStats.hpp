@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Heap allocation accounting.
+//
+// AllocHook.cpp replaces the global operator new / delete; every call bumps
+// counters owned by the calling thread, so counting is a couple of plain
+// increments and another thread's allocations never show up in a scope.
+// The hook is opt-in (the kungfu_chess_alloc_hook object library: the tests
+// and KFC_COUNT_ALLOCS builds); without it every count stays zero.
+// AllocScope measures the allocations of the enclosing block, which is how
+// the profiler attributes them to tick phases.
+// ---------------------------------------------------------------------------
+struct AllocCounters
+{
+    uint64_t allocs{0};
+    uint64_t frees{0};
+    uint64_t bytes{0}; // requested by allocations
+};
+
+namespace alloc_detail
+{
+inline thread_local AllocCounters t_counters;
+inline bool hook_linked = false; // set while AllocHook.cpp initialises
+} // namespace alloc_detail
+
+// Totals of the calling thread since it started
+inline const AllocCounters &thread_alloc_counters() { return alloc_detail::t_counters; }
+
+// True when the counting operator new is linked in
+inline bool alloc_hook_installed() { return alloc_detail::hook_linked; }
+
+class AllocScope
+{
+public:
+    AllocScope() : start(alloc_detail::t_counters) {}
+
+    // Allocations made by this thread since construction
+    AllocCounters delta() const
+    {
+        const AllocCounters &now = alloc_detail::t_counters;
+        return AllocCounters{now.allocs - start.allocs, now.frees - start.frees, now.bytes - start.bytes};
+    }
+
+private:
+    AllocCounters start;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// The game's single monotonic clock.  Game time, input timestamps and the
+// latency figures are all read from it, so stamps taken on different
+// threads can be subtracted directly.
+// ---------------------------------------------------------------------------
+using GameClock = std::chrono::steady_clock;
+
+// Nanoseconds since the clock's epoch
+inline uint64_t clock_ns(GameClock::time_point t)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+inline uint64_t clock_now_ns() { return clock_ns(GameClock::now()); }
+
+// Milliseconds from origin to t – game time when origin is the game start
+inline int clock_ms_since(GameClock::time_point origin, GameClock::time_point t = GameClock::now())
+{
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(t - origin).count());
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <ostream>
 #include <utility>  // בשביל std::pair
+#include <cstdint>
 
 
 struct Command {
@@ -12,6 +13,10 @@ struct Command {
     std::string type;              // e.g., "move", "jump", "done"...
     std::vector<std::pair<int,int>> params;  // payload – board cells etc.
 
+    // Input latency stamps, GameClock ns (0 = not from a live key press)
+    uint64_t captured_ns{0};  // key event that completed the command
+    uint64_t queued_ns{0};    // pushed to the game's input queue
+
     Command(int ts, std::string pid, std::string t, std::vector<std::pair<int,int>> p)
         : timestamp(ts), piece_id(pid), type(t), params(p) {}
 
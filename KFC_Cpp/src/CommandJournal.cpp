@@ -0,0 +1,203 @@
+#include "CommandJournal.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+const char kMagic[4] = {'K', 'F', 'C', 'J'};
+const size_t kFlushThreshold = 4096;
+
+uint64_t zigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+std::string slurp(const fs::path &p)
+{
+    std::ifstream in(p, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open " + p.string());
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+CommandJournal::CommandJournal(const std::string &path, const std::string &board_csv, uint64_t asset_hash)
+    : out(path, std::ios::binary | std::ios::trunc)
+{
+    if (!out)
+        throw std::runtime_error("Cannot open journal for writing: " + path);
+    buf.bytes(kMagic, sizeof kMagic);
+    buf.u8(kVersion);
+    buf.u64(asset_hash);
+    buf.str(board_csv);
+    flush();
+}
+
+CommandJournal::~CommandJournal()
+{
+    flush();
+}
+
+void CommandJournal::put_header(uint64_t delta_zigzag, int kind)
+{
+    buf.varint((delta_zigzag << 2) | static_cast<uint64_t>(kind));
+}
+
+void CommandJournal::record_reset(int start_ms)
+{
+    put_header(zigzag(start_ms - last_tick_ms), JournalRecord::Reset);
+    last_tick_ms = start_ms;
+    flush();
+}
+
+void CommandJournal::record_tick(int now_ms)
+{
+    put_header(zigzag(now_ms - last_tick_ms), JournalRecord::Tick);
+    last_tick_ms = now_ms;
+    if (buf.size() >= kFlushThreshold)
+        flush();
+}
+
+void CommandJournal::record_command(const Command &cmd)
+{
+    put_header(zigzag(cmd.timestamp - last_tick_ms), JournalRecord::Cmd);
+    auto it = piece_slots.find(cmd.piece_id);
+    if (it != piece_slots.end())
+    {
+        buf.varint(it->second);
+    }
+    else
+    {
+        size_t slot = piece_slots.size();
+        piece_slots.emplace(cmd.piece_id, slot);
+        buf.varint(slot);
+        buf.str(cmd.piece_id);
+    }
+    write_command_body(buf, cmd);
+    // Commands are rare and are what an incident report needs – push them
+    // to the OS right away so a crash does not lose the last moves.
+    flush();
+}
+
+void CommandJournal::flush()
+{
+    if (buf.size() == 0)
+        return;
+    out.write(reinterpret_cast<const char *>(buf.data().data()), static_cast<std::streamsize>(buf.size()));
+    out.flush();
+    written += buf.size();
+    buf.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+JournalReader::JournalReader(const std::string &path)
+{
+    std::string raw = slurp(path);
+    data.assign(raw.begin(), raw.end());
+    reader = ByteReader(data);
+
+    char magic[4];
+    reader.bytes(magic, sizeof magic);
+    if (!std::equal(magic, magic + 4, kMagic))
+        throw std::runtime_error("Not a command journal: " + path);
+    uint8_t version = reader.u8();
+    if (version != CommandJournal::kVersion)
+        throw std::runtime_error("Unsupported journal version " + std::to_string(version));
+    hash = reader.u64();
+    csv = reader.str();
+}
+
+bool JournalReader::next(JournalRecord &rec)
+{
+    if (reader.done())
+        return false;
+    uint64_t head = reader.varint();
+    int kind = static_cast<int>(head & 3);
+    int time_ms = last_tick_ms + static_cast<int>(unzigzag(head >> 2));
+
+    switch (kind)
+    {
+    case JournalRecord::Tick:
+    case JournalRecord::Reset:
+        rec.kind = static_cast<JournalRecord::Kind>(kind);
+        rec.time_ms = time_ms;
+        last_tick_ms = time_ms;
+        return true;
+    case JournalRecord::Cmd:
+    {
+        size_t slot = static_cast<size_t>(reader.varint());
+        if (slot == piece_slots.size())
+            piece_slots.push_back(reader.str());
+        else if (slot > piece_slots.size())
+            throw std::runtime_error("Corrupt journal: bad piece slot");
+        rec.kind = JournalRecord::Cmd;
+        rec.time_ms = time_ms;
+        rec.cmd.timestamp = time_ms;
+        rec.cmd.piece_id = piece_slots[slot];
+        read_command_body(reader, rec.cmd);
+        return true;
+    }
+    default:
+        throw std::runtime_error("Corrupt journal: unknown record kind");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+uint64_t hash_piece_assets(const std::string &pieces_root)
+{
+    fs::path root(pieces_root);
+    std::vector<fs::path> files;
+    for (const auto &entry : fs::recursive_directory_iterator(root))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        const auto &p = entry.path();
+        auto ext = p.extension().string();
+        if (ext != ".json" && ext != ".txt" && ext != ".csv")
+            continue;
+        if (p.filename() == "board.csv")
+            continue;
+        files.push_back(fs::relative(p, root));
+    }
+    std::sort(files.begin(), files.end());
+
+    uint64_t h = fnv1a(nullptr, 0);
+    for (const auto &rel : files)
+    {
+        std::string name = rel.generic_string();
+        std::string body = slurp(root / rel);
+        h = fnv1a(name.data(), name.size(), h);
+        h = fnv1a(body.data(), body.size(), h);
+    }
+    return h;
+}
+
+std::string read_board_csv(const std::string &pieces_root)
+{
+    return slurp(fs::path(pieces_root) / "board.csv");
+}
+
+std::shared_ptr<CommandJournal> create_journal(const std::string &path,
+                                               const std::string &pieces_root)
+{
+    return std::make_shared<CommandJournal>(path, read_board_csv(pieces_root),
+                                            hash_piece_assets(pieces_root));
+}
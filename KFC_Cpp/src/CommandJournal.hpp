@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Command.hpp"
+#include "Serialization.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Append-only binary journal of everything the simulation consumed.
+//
+//   header : "KFCJ" | u8 version | u64 asset hash | str board.csv
+//   record : varint (zigzag(dt) << 2 | kind) followed by the kind payload
+//            kind 0 – tick    : dt = now - previous tick
+//            kind 1 – command : dt = cmd.timestamp - previous tick,
+//                               piece slot (new ids inlined once), body
+//            kind 2 – reset   : dt = start_ms - previous tick
+//
+// Ticks are only journaled while something is in motion or a command is
+// processed; ticks where every piece is idle cannot change the simulation.
+// ---------------------------------------------------------------------------
+class CommandJournal
+{
+public:
+    static constexpr uint8_t kVersion = 1;
+
+    CommandJournal(const std::string &path, const std::string &board_csv, uint64_t asset_hash);
+    ~CommandJournal();
+
+    CommandJournal(const CommandJournal &) = delete;
+    CommandJournal &operator=(const CommandJournal &) = delete;
+
+    void record_reset(int start_ms);
+    void record_tick(int now_ms);
+    void record_command(const Command &cmd);
+    void flush();
+
+    size_t bytes_written() const { return written + buf.size(); }
+
+private:
+    void put_header(uint64_t delta_zigzag, int kind);
+
+    std::ofstream out;
+    ByteWriter buf;
+    size_t written{0};
+    int last_tick_ms{0};
+    std::unordered_map<std::string, size_t> piece_slots;
+};
+
+// A single decoded journal entry.
+struct JournalRecord
+{
+    enum Kind
+    {
+        Tick = 0,
+        Cmd = 1,
+        Reset = 2
+    };
+    Kind kind{Tick};
+    int time_ms{0};
+    Command cmd{0, "", "", {}};
+};
+
+class JournalReader
+{
+public:
+    explicit JournalReader(const std::string &path);
+
+    uint64_t asset_hash() const { return hash; }
+    const std::string &board_csv() const { return csv; }
+
+    // Decode the next record; false at end of journal.
+    bool next(JournalRecord &rec);
+
+private:
+    std::vector<uint8_t> data;
+    ByteReader reader{nullptr, 0};
+    uint64_t hash{0};
+    std::string csv;
+    int last_tick_ms{0};
+    std::vector<std::string> piece_slots;
+};
+
+// Fingerprint of the rule assets under pieces_root (configs, moves,
+// transitions).  Sprites and board.csv are excluded – the layout is stored
+// verbatim in the journal and images never affect the simulation.
+uint64_t hash_piece_assets(const std::string &pieces_root);
+
+// Raw contents of <pieces_root>/board.csv.
+std::string read_board_csv(const std::string &pieces_root);
+
+// Journal pre-filled with the layout and asset hash of pieces_root.
+std::shared_ptr<CommandJournal> create_journal(const std::string &path,
+                                               const std::string &pieces_root);
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Profiler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Deadline-based frame pacing for the game loop.  Frames are scheduled at
+// fixed deadlines (start + n * period) rather than "work, then sleep 16 ms",
+// so the rate does not drift with the work done per frame.  wait() sleeps
+// coarsely until shortly before the deadline and spin-yields the rest, which
+// takes the scheduler's wake-up slop out of the frame time.
+//
+// When the loop falls more than a period behind, begin_frame() tells it to
+// skip rendering: the simulation still steps on game time, so it stays
+// correct while the renderer catches up.  Far behind (a debugger pause, a
+// stall) the schedule restarts from now instead of racing to make up for
+// the lost frames.
+// ---------------------------------------------------------------------------
+class FramePacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit FramePacer(double fps = 60.0, std::chrono::microseconds spin = std::chrono::microseconds(500))
+        : spin(spin)
+    {
+        set_rate(fps);
+    }
+
+    void set_rate(double fps)
+    {
+        target_fps = fps > 0 ? fps : 60.0;
+        period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / target_fps));
+    }
+    double rate() const { return target_fps; }
+    // How long before a deadline wait() stops sleeping and starts spinning
+    void set_spin(std::chrono::microseconds s) { spin = s; }
+
+    // Start of a frame; false when this frame's render should be dropped
+    bool begin_frame(clock::time_point now = clock::now())
+    {
+        if (frames++ == 0)
+            deadline = now;
+        else
+            record_interval(now - last_begin);
+        last_begin = now;
+
+        auto lateness = now - deadline;
+        bool render = lateness <= period;
+        if (!render)
+            ++dropped;
+        if (lateness > kResyncPeriods * period)
+        {
+            deadline = now + period; // start over rather than catch up
+            ++resyncs;
+        }
+        else
+            deadline += period;
+        return render;
+    }
+
+    // Wait for the next frame's deadline; returns at once when it passed
+    void wait()
+    {
+        auto now = clock::now();
+        if (now >= deadline)
+            return;
+        if (deadline - now > spin)
+            std::this_thread::sleep_until(deadline - spin);
+        while ((now = clock::now()) < deadline)
+            std::this_thread::yield();
+        jitter.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count()));
+    }
+
+    // wait(), calling poll() now and every `every` while it sleeps: for
+    // work that must stay on the loop's thread (a window's event queue)
+    template <class Poll>
+    void wait(clock::duration every, Poll &&poll)
+    {
+        poll();
+        for (auto now = clock::now(); deadline - now > spin + every; now = clock::now())
+        {
+            std::this_thread::sleep_until(now + every);
+            poll();
+        }
+        wait();
+    }
+
+    // --- statistics ---
+    uint64_t frame_count() const { return frames; }
+    uint64_t dropped_frames() const { return dropped; }
+    uint64_t resync_count() const { return resyncs; }
+    // Time past the deadline at which wait() returned
+    const LatencyHistogram &wake_jitter() const { return jitter; }
+    // Time between consecutive frame starts
+    const LatencyHistogram &frame_intervals() const { return intervals; }
+    double interval_mean_ms() const { return n_intervals ? mean_ms : 0.0; }
+    double interval_stddev_ms() const { return n_intervals > 1 ? std::sqrt(m2 / (n_intervals - 1)) : 0.0; }
+
+    void dump(std::ostream &os) const
+    {
+        char line[160];
+        os << "=== Frame pacing ===\n";
+        std::snprintf(line, sizeof line, "target %.1f fps  frames %llu  dropped renders %llu  resyncs %llu\n",
+                      target_fps, static_cast<unsigned long long>(frames), static_cast<unsigned long long>(dropped),
+                      static_cast<unsigned long long>(resyncs));
+        os << line;
+        std::snprintf(line, sizeof line, "interval mean %.3f ms  stddev %.3f ms  p99 %.3f ms\n", interval_mean_ms(),
+                      interval_stddev_ms(), intervals.percentile(0.99) / 1e6);
+        os << line;
+        std::snprintf(line, sizeof line, "wake jitter p50 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+                      jitter.percentile(0.50) / 1e6, jitter.percentile(0.99) / 1e6, jitter.max() / 1e6);
+        os << line;
+    }
+
+private:
+    static constexpr int kResyncPeriods = 4;
+
+    void record_interval(clock::duration d)
+    {
+        intervals.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+        // Welford's running mean and variance
+        double ms = std::chrono::duration<double, std::milli>(d).count();
+        ++n_intervals;
+        double delta = ms - mean_ms;
+        mean_ms += delta / static_cast<double>(n_intervals);
+        m2 += delta * (ms - mean_ms);
+    }
+
+    double target_fps{60.0};
+    clock::duration period{};
+    std::chrono::microseconds spin;
+    clock::time_point deadline{};
+    clock::time_point last_begin{};
+
+    uint64_t frames{0};
+    uint64_t dropped{0};
+    uint64_t resyncs{0};
+    LatencyHistogram jitter;
+    LatencyHistogram intervals;
+    uint64_t n_intervals{0};
+    double mean_ms{0};
+    double m2{0};
+};
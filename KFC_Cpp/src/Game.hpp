@@ -1,7 +1,7 @@
 #pragma once
 #include "Common.hpp"
+#include "Log.hpp"
 
-#include <opencv2/opencv.hpp>
 #include "Board.hpp"
 #include "PieceFactory.hpp"
 #include <memory>
@@ -10,7 +10,7 @@
 #include <unordered_set>
 #include "img/Img.hpp"
 #include "img/ImgFactory.hpp"
-#include "img/OpenCvImg.hpp"
+#include "KeyInput.hpp"
 #include <fstream>
 #include <sstream>
 #include "GraphicsFactory.hpp"
@@ -18,12 +18,22 @@
 #include <thread>
 #include <queue>
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <unordered_map>
 #include <iostream>
 #include <atomic>
 #include <mutex>
 #include "KeyboardProcessor.hpp"
 #include "KeyboardProducer.hpp"
+#include "CommandJournal.hpp"
+#include "Profiler.hpp"
+#include "Clock.hpp"
+#include "InputLatency.hpp"
+#include "PieceIndex.hpp"
+#include "ReservationTable.hpp"
+#include "InputSource.hpp"
+#include "FramePacer.hpp"
 #include <utility> // בשביל std::pair
 
 #if __has_include(<filesystem>)
@@ -42,22 +52,26 @@ public:
     explicit InvalidBoard(const std::string &msg) : std::runtime_error(msg) {}
 };
 
-struct PlayerData
-{
-    int player;
-    std::shared_ptr<KeyboardProcessor> kp;
-    std::pair<int, int> *last_cursor; // שינוי: pointer רגיל במקום shared_ptr
-
-    PlayerData(int p, std::shared_ptr<KeyboardProcessor> k, std::pair<int, int> *l)
-        : player(p), kp(k), last_cursor(l) {}
-};
-
 class Game
 {
 public:
     Game(std::vector<PiecePtr> pcs, Board board);
     std::atomic<bool> running{true};
-    std::mutex input_mutex;
+    mutable std::mutex input_mutex;
+    // Per-phase tick timing; run() enables it and dumps it on exit
+    FrameProfiler profiler;
+    // Profiler overlay, toggled with 'p' while playing
+    std::atomic<bool> hud_visible{false};
+    // Key press to screen latency of live input, per stage
+    InputLatency input_latency;
+    // Frame rate run() paces the loop at (pacer.set_rate); renders are
+    // dropped, not simulation steps, when it cannot keep up
+    FramePacer pacer;
+    // Polls per second of the key queue while run() plays: the window's by
+    // the game loop between frames (its events belong to the thread that
+    // created it), the terminal's by an InputPump thread; 0 reads keys once
+    // per frame, after it is shown
+    int input_poll_hz{1000};
     // --- main public API ---
     int game_time_ms() const;
     Board clone_board() const;
@@ -73,48 +87,210 @@ public:
     std::shared_ptr<KeyboardProducer> kb_prod_1;
     std::shared_ptr<KeyboardProducer> kb_prod_2;
 
-    std::pair<int, int> last_cursor1 = {-1, -1};
-    std::pair<int, int> last_cursor2 = {-1, -1};
     // helper for tests to inject commands
     void enqueue_command(const Command &cmd);
+    // Create both players' keymaps, cursors and producers (once); nothing
+    // is started
+    void setup_players();
+    // Hand every key src has due by now_ms to the players, on this thread.
+    // Their commands are stamped with the key's time and applied by the
+    // next advance().  Returns the number of keys.
+    size_t feed_input(InputSource &src, int now_ms);
+
+    // --- simulation stepping (used by the loop and by journal replay) ---
+    void reset_pieces(int start_ms);
+    // One simulation step at game time now_ms: piece updates, queued input,
+    // collisions.  Rendering is left to the caller.
+    //
+    // Only the active pieces (moving, jumping, resting; see `active`) are
+    // stepped: an idle piece cannot change until a command reaches it, so a
+    // tick costs the pieces in play, not the size of the board.
+    void advance(int now_ms);
+    // True when every piece rests in an idle state – such ticks are no-ops.
+    bool all_idle() const;
+    // One of the kings has been captured
+    bool is_win() const;
+    // Pieces not resting in an idle state
+    size_t active_count() const { return active.size(); }
+
+    // Record every reset, relevant tick and processed command
+    void set_journal(std::shared_ptr<CommandJournal> j) { journal = std::move(j); }
+
+    // --- snapshots (crash recovery, rollback) ---
+    // Versioned binary image of the simulation: live pieces, their current
+    // state, physics timing and position, animation timing, player cursors,
+    // selections and not yet processed commands.
+    std::vector<uint8_t> snapshot() const;
+    void save_snapshot(ByteWriter &w) const;
+    // Restore a snapshot taken from a game built from the same layout.
+    void restore(const std::vector<uint8_t> &data);
+    void restore(ByteReader &r);
+    // Game time of the last simulated step
+    int sim_time_ms() const { return last_tick_ms; }
+    // Piece positions as of the last step, for readers on other threads
+    const PieceIndex &piece_index() const { return index; }
+    // The pieces on each cell as of the last step, in roster order; a cell
+    // with an empty list is free (game thread)
+    const Cell2Pieces &cell_pieces() const { return pos; }
+    // The cells every moving piece will pass through and when (game thread)
+    const ReservationTable &reservations() const { return reserved; }
+    // Neither a resting piece nor a move in flight will be on cell at
+    // t_ms, as far as the moves started so far tell (game thread)
+    bool cell_free_at(std::pair<int, int> cell, int t_ms) const;
+
+    // --- single steps of advance()/_draw(), for benchmarks and tools ---
+    // Bring the cell map up to date with the pieces that can have moved
+    void update_cell2piece_map();
+    void resolve_collisions();
+    // Compose the board, the pieces at their animation frame for now_ms and
+    // the player cursors into an image.  Nothing is shown.  The image is
+    // reused by the next call.
+    //
+    // Three layers: the board (board.img, drawn at load), the pieces over
+    // it, redrawn only when a sprite changes frame or moves, and the overlay
+    // (cursors, selections, HUD), redrawn over a copy of the piece layer
+    // only when it or the pieces changed.  A frame where nothing changed
+    // costs the sprite check alone.
+    Board render_frame(int now_ms);
+    // Draw cells px wide (0 = the board's own cell size).  The board image
+    // is scaled once here; sprites come from the pre-scaled level of that
+    // size (see SpriteLevels), or are scaled once here from the next larger
+    // one, so a zoomed frame costs what a native one does.  Returns false
+    // when an image cannot scale.
+    bool set_view_cell_px(int px);
+    int view_cell_px() const { return view_px ? view_px : board.cell_W_pix; }
+    struct LayerStats
+    {
+        uint64_t frames{0};
+        uint64_t piece_redraws{0};
+        uint64_t overlay_redraws{0};
+    };
+    LayerStats layer_stats;
 
 private:
     // --- helpers mirroring Python implementation ---
     void start_user_input_thread(); // no-op stub for now
     void run_game_loop(int num_iterations, bool is_with_graphics);
-    void update_cell2piece_map();
-    void process_input(const Command &cmd);
-    void resolve_collisions();
+    // True when the command made its piece change state
+    bool process_input(const Command &cmd);
+    // p changed state: reserve its path if it set off, release it if not
+    void track_motion(const Piece &p);
+    // slot changed state or took a command: step it while it is not idle,
+    // and look at its cell again either way
+    void wake(int slot);
+    // List slot under the cell it is on now (none once captured)
+    void place(int slot);
+    // Recompute everything below from `pieces` (reset, restore, or when
+    // `pieces` was edited from outside)
+    void rebuild_tracking();
+    // The board as it stands, for PieceIndex::publish_changes
+    struct LiveCells
+    {
+        const Game &game;
+        std::pair<int, int> cell_of(int slot) const;
+        int first_at(std::pair<int, int> cell, char color) const;
+    };
     void announce_win() const;
 
     void validate();
-    bool is_win() const;
     void _draw();
     void _show() const;
 
     std::unordered_map<std::string, PiecePtr> piece_by_id;
-    // Map from board cell to list of occupying pieces
+    // Map from board cell to list of occupying pieces, in roster order.
+    // Kept up to date piece by piece: only pieces in `active` or `settled`
+    // can have moved since their last place().
     std::unordered_map<std::pair<int, int>, std::vector<PiecePtr>, PairHash> pos;
+    // render_frame layers: the last composed frame, the piece layer and
+    // what each was drawn from
+    struct SpriteKey
+    {
+        Img *sprite;
+        int x, y;
+        bool operator==(const SpriteKey &o) const { return sprite == o.sprite && x == o.x && y == o.y; }
+        bool operator!=(const SpriteKey &o) const { return !(*this == o); }
+    };
+    struct OverlayKey
+    {
+        std::array<std::pair<int, int>, 2> cursors{{{-1, -1}, {-1, -1}}};
+        std::array<std::pair<int, int>, 2> selections{{{-1, -1}, {-1, -1}}};
+        bool operator==(const OverlayKey &o) const { return cursors == o.cursors && selections == o.selections; }
+    };
+    void draw_overlay(Img &img, const OverlayKey &overlay, int cell_w, int cell_h) const;
+    int view_px{0};      // 0 = native
+    ImgPtr view_board;   // board.img at view_px, when zoomed
+    // Sprite frames scaled to exactly view_px, by the level frame they were
+    // made from; only for sprites with no level of that size
+    std::unordered_map<const Img *, ImgPtr> view_sprites;
+    ImgPtr frame_img;
+    ImgPtr piece_layer;
+    std::vector<SpriteKey> drawn_sprites, next_sprites;
+    OverlayKey drawn_overlay;
+    std::vector<std::string> hud_text, drawn_hud;
     std::vector<Command> user_input_queue;
 
-    std::chrono::steady_clock::time_point start_tp;
+    GameClock::time_point start_tp;
+    std::shared_ptr<CommandJournal> journal;
+
+    // Every piece the game started with, in board order; `pieces` is always
+    // an ordered subset of it.
+    std::vector<PiecePtr> roster;
+    InputPump input_pump;
+    // Published at the end of every step; read by the keyboard producers
+    PieceIndex index;
+    ReservationTable reserved;
+    int last_tick_ms{0};
+
+    // By roster slot
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> is_active;
+    std::vector<uint8_t> is_settled;
+    std::vector<uint8_t> is_king;
+    std::vector<std::pair<int, int>> listed; // the cell pos lists it under
+    // Slots not in an idle state, stepped every tick
+    std::vector<int> active;
+    // Slots that went idle or took a command since the last collision
+    // check: placed and checked once more
+    std::vector<int> settled;
+    // Slots whose cell changed since the last publication
+    std::vector<int> moved;
+    int live_kings{0};
+    size_t tracked_pieces{0}; // pieces.size() as last seen here
 };
 
 // ---------------- Implementation inline --------------------
 inline Game::Game(std::vector<PiecePtr> pcs, Board board)
-    : pieces(pcs), board(board)
+    : pieces(pcs), board(board), roster(pcs), index(pcs, board.H_cells, board.W_cells),
+      reserved(board.H_cells, board.W_cells, pcs.size())
 {
     validate();
     for (const auto &p : pieces)
         piece_by_id[p->id] = p;
-    start_tp = std::chrono::steady_clock::now();
+    // One list per cell up front; pieces only move between them
+    pos.reserve(static_cast<size_t>(this->board.W_cells) * this->board.H_cells);
+    for (int r = 0; r < this->board.H_cells; ++r)
+        for (int c = 0; c < this->board.W_cells; ++c)
+            pos[{r, c}].reserve(2);
+    drawn_sprites.reserve(roster.size());
+    next_sprites.reserve(roster.size());
+    const size_t n = roster.size();
+    alive.assign(n, 0);
+    is_active.assign(n, 0);
+    is_settled.assign(n, 0);
+    is_king.assign(n, 0);
+    listed.assign(n, {-1, -1});
+    for (size_t i = 0; i < n; ++i)
+        is_king[i] = roster[i]->id.rfind("KW", 0) == 0 || roster[i]->id.rfind("KB", 0) == 0;
+    active.reserve(n);
+    settled.reserve(n);
+    moved.reserve(2 * n);
+    rebuild_tracking();
+    start_tp = GameClock::now();
 }
 
 inline int Game::game_time_ms() const
 {
-    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                std::chrono::steady_clock::now() - start_tp)
-                                .count());
+    return clock_ms_since(start_tp);
 }
 
 inline Board Game::clone_board() const
@@ -125,21 +301,58 @@ inline Board Game::clone_board() const
 inline void Game::run(int num_iterations, bool is_with_graphics)
 {
     start_user_input_thread();
-    int start_ms = game_time_ms();
-    for (auto &p : pieces)
-    {
-        p->reset(start_ms);
-    }
+#if defined(__unix__) || defined(__APPLE__)
+    // Without a window, keys come from the terminal (if there is one)
+    if (!is_with_graphics)
+        set_window_key_poller(terminal_key_poller());
+#endif
+    if (input_poll_hz > 0 && !is_with_graphics)
+        input_pump.start(input_poll_hz);
+    reset_pieces(game_time_ms());
 
+    profiler.set_enabled(true);
     run_game_loop(num_iterations, is_with_graphics);
+    input_pump.stop();
+#if defined(__unix__) || defined(__APPLE__)
+    if (!is_with_graphics)
+    {
+        set_window_key_poller(nullptr);
+        restore_terminal_keys();
+    }
+#endif
 
     announce_win();
+    profiler.dump(std::cout);
+    pacer.dump(std::cout);
+    if (input_latency.histogram(InputStage::Apply).count())
+        input_latency.dump(std::cout);
     int x = 0;
     // std::cin >> x;
 }
 
 inline void Game::start_user_input_thread()
 {
+    setup_players();
+    // הגדרת handler למקשים מ-OpenCV
+    // Called on the input pump's thread, or after each frame without one
+    set_global_key_handler([this](int key, uint64_t captured_ns) {
+        KFC_LOG("[DEBUG] Global key handler received: " << key);
+        if (key == 'p')
+        {
+            hud_visible = !hud_visible;
+            return;
+        }
+        kb_prod_1->handle_opencv_key(key, captured_ns);
+    });
+
+    kb_prod_1->start(); // או אפשר להריץ ב־ctor אם זה אוטומטי
+    kb_prod_2->start();
+}
+
+inline void Game::setup_players()
+{
+    if (kb_prod_1)
+        return;
     std::unordered_map<std::string, std::string> p1_map = {
         {"up", "up"}, {"down", "down"}, {"left", "left"}, {"right", "right"}, {"enter", "select"}, {"+", "jump"}};
 
@@ -162,58 +375,62 @@ inline void Game::start_user_input_thread()
     kb_prod_2->set_other_player(kb_prod_1);
     
     // העבר reference לרשימת הכלים
-    kb_prod_1->set_pieces_reference(&pieces);
-    kb_prod_2->set_pieces_reference(&pieces);
-    
-    // הגדרת handler למקשים מ-OpenCV
-    set_global_key_handler([this](int key) {
-        std::cout << "[DEBUG] Global key handler received: " << key << std::endl;
-        kb_prod_1->handle_opencv_key(key);
-    });
+    kb_prod_1->set_piece_index(&index);
+    kb_prod_2->set_piece_index(&index);
 
-    kb_prod_1->start(); // או אפשר להריץ ב־ctor אם זה אוטומטי
-    kb_prod_2->start();
+    // Stamp commands in game time
+    kb_prod_1->set_time_origin(start_tp);
+    kb_prod_2->set_time_origin(start_tp);
+}
+
+inline size_t Game::feed_input(InputSource &src, int now_ms)
+{
+    setup_players();
+    size_t n = 0;
+    InputEvent ev;
+    while (src.poll(now_ms, ev))
+    {
+        kb_prod_1->set_virtual_time(ev.time_ms);
+        kb_prod_2->set_virtual_time(ev.time_ms);
+        kb_prod_1->route_key(ev.key);
+        ++n;
+    }
+    kb_prod_1->set_virtual_time(-1);
+    kb_prod_2->set_virtual_time(-1);
+    return n;
 }
 
 inline void Game::run_game_loop(int num_iterations, bool is_with_graphics)
 {
     int it_counter = 0;
+    trace_thread_name("game loop");
     while (!is_win())
     {
-        int now = game_time_ms();
-        for (auto &p : pieces)
-            p->update(now, pos);
-
-        update_cell2piece_map();
-
-        // עיבוד פקודות מהתור
+        bool render = pacer.begin_frame();
         {
-            std::lock_guard<std::mutex> guard(input_mutex);
-            while (!user_input_queue.empty())
+            ProfileScope tick(profiler, TickPhase::Tick);
+            advance(game_time_ms());
+
+            if (is_with_graphics && render)
             {
-                auto cmd = user_input_queue.front();
-                user_input_queue.erase(user_input_queue.begin());
-                std::cout << "[GAME] Processing command: " << cmd << std::endl;
-                process_input(cmd);
+                _draw();
             }
         }
 
-        if (is_with_graphics)
-        {
-            _draw();
-        }
-
-        resolve_collisions();
-
         if (num_iterations >= 0)
         {
             ++it_counter;
             if (it_counter >= num_iterations)
                 return;
         }
-        
-        // הוספת sleep קצר כדי לא לערבל את ה-CPU
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+
+        // המתנה עד מועד הפריים הבא.  The window's keys are read here, on
+        // the thread that owns the window, at input_poll_hz
+        if (is_with_graphics && input_poll_hz > 0)
+            pacer.wait(std::chrono::nanoseconds(1000000000LL / input_poll_hz), []
+                       { drain_window_keys(); });
+        else
+            pacer.wait();
     }
     if (is_with_graphics)
     {
@@ -221,47 +438,248 @@ inline void Game::run_game_loop(int num_iterations, bool is_with_graphics)
     }
 }
 
+inline void Game::reset_pieces(int start_ms)
+{
+    for (auto &p : pieces)
+    {
+        p->reset(start_ms);
+    }
+    reserved.clear();
+    rebuild_tracking();
+    last_tick_ms = start_ms;
+    index.publish(pieces, start_ms);
+    if (journal)
+        journal->record_reset(start_ms);
+}
+
+inline bool Game::all_idle() const
+{
+    if (pieces.size() != tracked_pieces) // edited from outside, not seen yet
+        return std::all_of(pieces.begin(), pieces.end(), [](const PiecePtr &p)
+                           { return p->state->physics->is_idle(); });
+    return active.empty();
+}
+
+inline void Game::advance(int now_ms)
+{
+    if (pieces.size() != tracked_pieces)
+    {
+        rebuild_tracking();
+        index.publish(pieces, last_tick_ms);
+    }
+    // Idle ticks cannot change the simulation, so they are only journaled
+    // once they turn out to carry a command.
+    bool tick_journaled = false;
+    if (journal && !all_idle())
+    {
+        journal->record_tick(now_ms);
+        tick_journaled = true;
+    }
+
+    last_tick_ms = now_ms;
+    {
+        ProfileScope scope(profiler, TickPhase::Pieces);
+        // In roster order, as the full piece list would be
+        std::sort(active.begin(), active.end());
+        size_t still_active = 0;
+        for (int slot : active)
+        {
+            const auto &p = roster[static_cast<size_t>(slot)];
+            const State *before = p->state.get();
+            p->update(now_ms, pos);
+            if (p->state.get() != before)
+                track_motion(*p);
+            if (!p->state->physics->is_idle())
+                active[still_active++] = slot;
+            else
+            {
+                // Placed and checked for collisions once more, then left alone
+                is_active[static_cast<size_t>(slot)] = 0;
+                wake(slot);
+            }
+        }
+        active.resize(still_active);
+
+        update_cell2piece_map();
+    }
+
+    // עיבוד פקודות מהתור
+    {
+        ProfileScope scope(profiler, TickPhase::Commands);
+        std::lock_guard<std::mutex> guard(input_mutex);
+        while (!user_input_queue.empty())
+        {
+            auto cmd = user_input_queue.front();
+            user_input_queue.erase(user_input_queue.begin());
+            KFC_LOG("[GAME] Processing command: " << cmd);
+            if (journal)
+            {
+                if (!tick_journaled)
+                {
+                    journal->record_tick(now_ms);
+                    tick_journaled = true;
+                }
+                journal->record_command(cmd);
+            }
+            uint64_t dequeued_ns = cmd.captured_ns ? clock_now_ns() : 0;
+            bool changed = process_input(cmd);
+            if (cmd.captured_ns)
+                input_latency.command_processed(cmd, dequeued_ns, clock_now_ns(), changed);
+        }
+    }
+
+    ProfileScope scope(profiler, TickPhase::Collisions);
+    resolve_collisions();
+    index.publish_changes(moved, LiveCells{*this}, now_ms);
+    moved.clear();
+}
+
 inline void Game::update_cell2piece_map()
 {
-    pos.clear();
+    // Idle pieces stay where they were listed.  Lists are never removed, so
+    // moving between them does not allocate; readers skip empty lists.
+    for (int slot : active)
+        place(slot);
+    for (int slot : settled)
+        place(slot);
+}
+
+inline void Game::place(int slot)
+{
+    const size_t i = static_cast<size_t>(slot);
+    const PiecePtr &p = roster[i];
+    std::pair<int, int> cell = alive[i] ? p->current_cell() : std::make_pair(-1, -1);
+    if (cell == listed[i])
+        return;
+    if (listed[i].first >= 0)
+    {
+        auto &from = pos[listed[i]];
+        auto it = std::find(from.begin(), from.end(), p);
+        if (it != from.end())
+            from.erase(it);
+    }
+    if (cell.first >= 0)
+    {
+        auto &to = pos[cell];
+        auto at = std::find_if(to.begin(), to.end(), [&](const PiecePtr &q)
+                               { return index.slot_of(q.get()) > slot; });
+        to.insert(at, p);
+    }
+    listed[i] = cell;
+    moved.push_back(slot);
+}
+
+inline void Game::wake(int slot)
+{
+    if (slot < 0)
+        return;
+    const size_t i = static_cast<size_t>(slot);
+    if (!alive[i])
+        return;
+    if (!roster[i]->state->physics->is_idle())
+    {
+        if (!is_active[i])
+        {
+            is_active[i] = 1;
+            active.push_back(slot);
+        }
+    }
+    else if (!is_settled[i])
+    {
+        is_settled[i] = 1;
+        settled.push_back(slot);
+    }
+}
+
+inline void Game::rebuild_tracking()
+{
+    for (size_t i = 0; i < roster.size(); ++i)
+    {
+        if (listed[i].first >= 0)
+            pos[listed[i]].clear();
+        listed[i] = {-1, -1};
+        alive[i] = is_active[i] = is_settled[i] = 0;
+    }
+    active.clear();
+    settled.clear();
+    live_kings = 0;
     for (const auto &p : pieces)
     {
-        pos[p->current_cell()].push_back(p);
+        int slot = index.slot_of(p.get());
+        const size_t i = static_cast<size_t>(slot);
+        alive[i] = 1;
+        live_kings += is_king[i];
+        if (!p->state->physics->is_idle())
+        {
+            is_active[i] = 1;
+            active.push_back(slot);
+        }
+        listed[i] = p->current_cell();
+        pos[listed[i]].push_back(p); // `pieces` is in roster order
     }
+    moved.clear();
+    tracked_pieces = pieces.size();
 }
 
-inline void Game::process_input(const Command &cmd)
+inline std::pair<int, int> Game::LiveCells::cell_of(int slot) const
 {
-    std::cout << "[GAME] Looking for piece: " << cmd.piece_id << std::endl;
+    return game.listed[static_cast<size_t>(slot)];
+}
+
+inline int Game::LiveCells::first_at(std::pair<int, int> cell, char color) const
+{
+    auto it = game.pos.find(cell);
+    if (it == game.pos.end())
+        return PieceIndex::kNone;
+    for (const auto &p : it->second)
+        if (p->id.size() > 1 && p->id[1] == color)
+            return game.index.slot_of(p.get());
+    return PieceIndex::kNone;
+}
+
+inline bool Game::process_input(const Command &cmd)
+{
+    KFC_LOG("[GAME] Looking for piece: " << cmd.piece_id);
     auto it = piece_by_id.find(cmd.piece_id);
     if (it == piece_by_id.end()) {
-        std::cout << "[GAME] ERROR: Piece not found: " << cmd.piece_id << std::endl;
-        return;
+        KFC_LOG("[GAME] ERROR: Piece not found: " << cmd.piece_id);
+        return false;
     }
     
     auto piece = it->second;
     auto old_cell = piece->current_cell();
-    std::cout << "[GAME] Piece " << cmd.piece_id << " before command at: (" << old_cell.first << "," << old_cell.second << ")" << std::endl;
+    KFC_LOG("[GAME] Piece " << cmd.piece_id << " before command at: (" << old_cell.first << "," << old_cell.second << ")");
     
+    const State *old_state = piece->state.get();
     piece->on_command(cmd, pos);
+    if (piece->state.get() != old_state)
+        track_motion(*piece);
+    wake(index.slot_of(piece.get()));
     
     auto new_cell = piece->current_cell();
-    std::cout << "[GAME] Piece " << cmd.piece_id << " after command at: (" << new_cell.first << "," << new_cell.second << ")" << std::endl;
+    KFC_LOG("[GAME] Piece " << cmd.piece_id << " after command at: (" << new_cell.first << "," << new_cell.second << ")");
     
     auto pos_pix = piece->state->physics->get_pos_pix();
-    std::cout << "[GAME] Piece pixel position: (" << pos_pix.first << "," << pos_pix.second << ")" << std::endl;
+    KFC_LOG("[GAME] Piece pixel position: (" << pos_pix.first << "," << pos_pix.second << ")");
+    return piece->state.get() != old_state;
 }
 
 inline void Game::resolve_collisions()
 {
     update_cell2piece_map();
-    std::vector<PiecePtr> to_remove;
+    static thread_local std::vector<PiecePtr> to_remove;
+    to_remove.clear();
 
-    for (const auto &kv : pos)
+    // Two pieces can only have met on the cell of one that is in play or
+    // just stopped; the lists there hold everyone else on those cells
+    auto check = [&](int slot)
     {
-        const auto &plist = kv.second;
+        const auto cell = listed[static_cast<size_t>(slot)];
+        if (cell.first < 0)
+            return;
+        const auto &plist = pos[cell];
         if (plist.size() < 2)
-            continue;
+            return;
         auto winner = *std::max_element(plist.begin(), plist.end(),
                                         [](const PiecePtr &a, const PiecePtr &b)
                                         {
@@ -271,17 +689,62 @@ inline void Game::resolve_collisions()
         {
             if (p == winner)
                 continue;
-            if (p->state->can_be_captured())
+            if (p->state->can_be_captured() && std::find(to_remove.begin(), to_remove.end(), p) == to_remove.end())
             {
                 to_remove.push_back(p);
             }
         }
+    };
+    for (int slot : active)
+        check(slot);
+    for (int slot : settled)
+    {
+        check(slot);
+        is_settled[static_cast<size_t>(slot)] = 0;
     }
+    settled.clear();
 
     for (const auto &p : to_remove)
     {
+        int slot = index.slot_of(p.get());
+        const size_t i = static_cast<size_t>(slot);
         pieces.erase(std::remove(pieces.begin(), pieces.end(), p), pieces.end());
+        reserved.release(slot);
+        alive[i] = 0;
+        live_kings -= is_king[i];
+        if (is_active[i])
+        {
+            is_active[i] = 0;
+            active.erase(std::find(active.begin(), active.end(), slot));
+        }
+        place(slot);
+    }
+    tracked_pieces = pieces.size();
+}
+
+inline void Game::track_motion(const Piece &p)
+{
+    int slot = index.slot_of(&p);
+    const auto *move = dynamic_cast<const MovePhysics *>(p.state->physics.get());
+    if (!move)
+    {
+        reserved.release(slot);
+        return;
+    }
+    reserved.reserve_move(slot, move->get_start_cell(), move->get_end_cell(), move->get_start_ms(),
+                          static_cast<int>(std::lround(move->get_duration_s() * 1000.0)));
+}
+
+inline bool Game::cell_free_at(std::pair<int, int> cell, int t_ms) const
+{
+    PieceIndex::Reader snap(index);
+    for (char color : {'W', 'B'})
+    {
+        int slot = snap->piece_at(cell, color);
+        if (slot != PieceIndex::kNone && !reserved.moving(slot))
+            return false; // resting there, and nothing says it will leave
     }
+    return reserved.is_free(cell, t_ms);
 }
 
 inline void Game::announce_win() const
@@ -292,13 +755,10 @@ inline void Game::announce_win() const
 
 inline bool Game::is_win() const
 {
-    int kings = 0;
-    for (const auto &p : pieces)
-    {
-        if (p->id.rfind("KW", 0) == 0 || p->id.rfind("KB", 0) == 0)
-            ++kings;
-    }
-    return kings < 2;
+    if (pieces.size() != tracked_pieces) // edited from outside, not seen yet
+        return std::count_if(pieces.begin(), pieces.end(), [](const PiecePtr &p)
+                             { return p->id.rfind("KW", 0) == 0 || p->id.rfind("KB", 0) == 0; }) < 2;
+    return live_kings < 2;
 }
 
 inline void Game::validate()
@@ -322,6 +782,290 @@ inline void Game::validate()
 inline void Game::enqueue_command(const Command &cmd)
 {
     user_input_queue.push_back(cmd);
+    if (cmd.captured_ns && !cmd.queued_ns)
+        user_input_queue.back().queued_ns = clock_now_ns();
+}
+
+// ---------------------------------------------------------------------------
+// Snapshots
+// ---------------------------------------------------------------------------
+namespace snapshot_format
+{
+const char kMagic[4] = {'K', 'F', 'C', 'S'};
+const uint8_t kVersion = 1;
+} // namespace snapshot_format
+
+inline std::vector<uint8_t> Game::snapshot() const
+{
+    ByteWriter w;
+    save_snapshot(w);
+    return w.data();
+}
+
+inline void Game::save_snapshot(ByteWriter &w) const
+{
+    w.bytes(snapshot_format::kMagic, sizeof snapshot_format::kMagic);
+    w.u8(snapshot_format::kVersion);
+    w.svarint(last_tick_ms);
+
+    // Alive bitmap in roster order
+    w.varint(roster.size());
+    size_t j = 0;
+    for (size_t i = 0; i < roster.size(); i += 8)
+    {
+        uint8_t bits = 0;
+        for (size_t b = 0; b < 8 && i + b < roster.size(); ++b)
+        {
+            if (j < pieces.size() && pieces[j] == roster[i + b])
+            {
+                bits |= static_cast<uint8_t>(1u << b);
+                ++j;
+            }
+        }
+        w.u8(bits);
+    }
+
+    for (const auto &p : pieces)
+    {
+        w.u8(static_cast<uint8_t>(p->state_index()));
+        const auto &phys = *p->state->physics;
+        phys.save_state(w);
+        const auto &gfx = *p->state->graphics;
+        w.svarint(gfx.start_time() - phys.get_start_ms());
+        // Idle pieces are not stepped: their frame as of the last tick
+        w.varint(phys.is_idle() ? gfx.frame_at(last_tick_ms) : gfx.current_frame());
+    }
+
+    // Player input state
+    auto roster_slot = [this](const std::string &id) -> size_t
+    {
+        for (size_t i = 0; i < roster.size(); ++i)
+            if (roster[i]->id == id)
+                return i + 1;
+        return 0;
+    };
+    bool has_players = kp1 && kp2 && kb_prod_1 && kb_prod_2;
+    w.u8(has_players ? 1 : 0);
+    if (has_players)
+    {
+        auto save_player = [&](const KeyboardProcessor &kp, const KeyboardProducer &prod)
+        {
+            auto selection = prod.get_selection(); // id and cell from one key
+            w.cell(kp.get_cursor());
+            w.varint(roster_slot(selection.first));
+            w.cell(selection.second);
+        };
+        save_player(*kp1, *kb_prod_1);
+        save_player(*kp2, *kb_prod_2);
+    }
+
+    std::lock_guard<std::mutex> guard(input_mutex);
+    w.varint(user_input_queue.size());
+    for (const auto &cmd : user_input_queue)
+        write_command(w, cmd);
+}
+
+inline void Game::restore(const std::vector<uint8_t> &data)
+{
+    ByteReader r(data);
+    restore(r);
+}
+
+inline void Game::restore(ByteReader &r)
+{
+    char magic[4];
+    r.bytes(magic, sizeof magic);
+    if (!std::equal(magic, magic + 4, snapshot_format::kMagic))
+        throw std::runtime_error("Not a game snapshot");
+    uint8_t version = r.u8();
+    if (version != snapshot_format::kVersion)
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(version));
+
+    last_tick_ms = static_cast<int>(r.svarint());
+    start_tp = GameClock::now() - std::chrono::milliseconds(last_tick_ms);
+
+    size_t n = static_cast<size_t>(r.varint());
+    if (n != roster.size())
+        throw std::runtime_error("Snapshot was taken from a different board");
+    pieces.clear();
+    for (size_t i = 0; i < n; i += 8)
+    {
+        uint8_t bits = r.u8();
+        for (size_t b = 0; b < 8 && i + b < n; ++b)
+            if (bits & (1u << b))
+                pieces.push_back(roster[i + b]);
+    }
+
+    for (const auto &p : pieces)
+    {
+        const auto &states = p->state_list();
+        size_t idx = r.u8();
+        if (idx >= states.size())
+            throw std::runtime_error("Snapshot refers to an unknown state of " + p->id);
+        p->state = states[idx];
+        auto &phys = *p->state->physics;
+        phys.load_state(r);
+        int gfx_start = phys.get_start_ms() + static_cast<int>(r.svarint());
+        size_t frame = static_cast<size_t>(r.varint());
+        p->state->graphics->restore_timing(gfx_start, frame);
+    }
+    reserved.clear();
+    for (const auto &p : pieces)
+        track_motion(*p);
+
+    if (r.u8() & 1)
+    {
+        for (int player = 1; player <= 2; ++player)
+        {
+            auto cursor = r.cell();
+            size_t slot = static_cast<size_t>(r.varint());
+            auto sel_cell = r.cell();
+            auto kp = (player == 1) ? kp1 : kp2;
+            auto prod = (player == 1) ? kb_prod_1 : kb_prod_2;
+            if (kp)
+                kp->set_cursor(cursor);
+            if (prod)
+                prod->set_selection(slot ? roster.at(slot - 1)->id : std::string(), sel_cell);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(input_mutex);
+    size_t queued = static_cast<size_t>(r.varint());
+    user_input_queue.clear();
+    for (size_t i = 0; i < queued; ++i)
+        user_input_queue.push_back(read_command(r));
+    rebuild_tracking();
+    index.publish(pieces, last_tick_ms);
+}
+
+// ---------------------------------------------------------------------------
+// Pieces and board described by a board.csv layout stream
+// ---------------------------------------------------------------------------
+struct GameSetup
+{
+    std::vector<PiecePtr> pieces;
+    Board board;
+};
+
+// Cell size for a board of rows x cols: 64 px up to 64 cells a side, then
+// smaller so the board image stays within 4096 px (sprites follow)
+inline int layout_cell_px(int rows, int cols)
+{
+    return std::max(8, std::min(64, 4096 / std::max({rows, cols, 1})));
+}
+
+// A board.csv layout with its assets parsed once: the board, and a piece
+// factory that keeps every type's configs, moves and sprites.  Each
+// create_pieces() builds a fresh roster without touching the disk again
+// (servers start many matches from one layout).
+//
+// The board is as large as the layout: one row per line, one column per
+// comma separated field (an 8x8 board.csv gives the classic board)
+class GameLayout
+{
+public:
+    GameLayout(std::istream &in, const std::string &pieces_root, const ImgFactoryPtr &img_factory)
+        : lines(read_lines(in)), board_(make_board(lines, pieces_root, img_factory)), gfx_factory(img_factory),
+          factory(board_, pieces_root, gfx_factory)
+    {
+    }
+
+    GameLayout(const GameLayout &) = delete;
+    GameLayout &operator=(const GameLayout &) = delete;
+
+    const Board &board() const { return board_; }
+
+    std::vector<PiecePtr> create_pieces()
+    {
+        std::vector<PiecePtr> out;
+        for (int row = 0; row < static_cast<int>(lines.size()); ++row)
+        {
+            std::stringstream ss(lines[static_cast<size_t>(row)]);
+            std::string cell;
+            int col = 0;
+            while (std::getline(ss, cell, ','))
+            {
+                //  הסרת רווחים מיותרים
+                cell.erase(0, cell.find_first_not_of(" \t\r\n"));
+                cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
+
+                if (!cell.empty())
+                {
+                    try
+                    {
+                        KFC_LOG("Creating piece '" << cell << "' at board position (row=" << row << ", col=" << col << ")");
+                        auto piece = factory.create_piece(cell, {row, col});
+                        if (piece)
+                        {
+                            KFC_LOG("SUCCESS: Created piece " << piece->id << " at (" << col << "," << row << ")");
+                            out.push_back(piece);
+                        }
+                        else
+                        {
+                            KFC_LOG("ERROR: create_piece returned nullptr for '" << cell << "'");
+                        }
+                    }
+                    catch (const std::exception &e)
+                    {
+                        KFC_LOG("    EXCEPTION: " << e.what());
+                    }
+                }
+                ++col;
+            }
+        }
+        return out;
+    }
+
+private:
+    static std::vector<std::string> read_lines(std::istream &in)
+    {
+        std::vector<std::string> out;
+        std::string line;
+        while (std::getline(in, line))
+            out.push_back(line);
+        while (!out.empty() && out.back().find_first_not_of(" \t\r\n") == std::string::npos)
+            out.pop_back();
+        return out;
+    }
+
+    static Board make_board(const std::vector<std::string> &lines,
+                            const std::string &pieces_root,
+                            const ImgFactoryPtr &img_factory)
+    {
+        int rows = lines.empty() ? 8 : static_cast<int>(lines.size());
+        int cols = lines.empty() ? 8 : 1;
+        for (const auto &l : lines)
+            cols = std::max(cols, static_cast<int>(std::count(l.begin(), l.end(), ',')) + 1);
+
+        fs::path board_png = fs::path(pieces_root) / "board.png";
+        int cell_px = layout_cell_px(rows, cols);
+        auto board_img = img_factory->load(board_png.string(), {cols * cell_px, rows * cell_px});
+        return Board(cell_px, cell_px, cols, rows, board_img, 1.0, 1.0);
+    }
+
+    std::vector<std::string> lines;
+    Board board_;
+    GraphicsFactory gfx_factory;
+    PieceFactory factory; // refers to board_ and gfx_factory
+};
+
+inline GameSetup load_game_setup(std::istream &in,
+                                 const std::string &pieces_root,
+                                 const ImgFactoryPtr &img_factory)
+{
+    GameLayout layout(in, pieces_root, img_factory);
+    return GameSetup{layout.create_pieces(), layout.board()};
+}
+
+// ---------------------------------------------------------------------------
+// Helper to build a full game from a board.csv layout stream
+// ---------------------------------------------------------------------------
+inline Game create_game(std::istream &in,
+                        const std::string &pieces_root,
+                        const ImgFactoryPtr &img_factory)
+{
+    GameSetup setup = load_game_setup(in, pieces_root, img_factory);
+    return Game(setup.pieces, setup.board);
 }
 
 // ---------------------------------------------------------------------------
@@ -332,9 +1076,7 @@ inline Game create_game(const std::string &pieces_root,
 {
     // std::cout << "=== DEBUG: Creating game ===" << std::endl;
     // std::cout << "Pieces root: " << pieces_root << std::endl;
-    GraphicsFactory gfx_factory(img_factory);
-    fs::path root = fs::path(pieces_root);
-    fs::path board_csv = root / "board.csv";
+    fs::path board_csv = fs::path(pieces_root) / "board.csv";
     // בדיקת קיום קבצים
     // std::cout << "Board CSV path: " << board_csv.string() << std::endl;
     // std::cout << "Board CSV exists: " << fs::exists(board_csv) << std::endl;
@@ -345,114 +1087,159 @@ inline Game create_game(const std::string &pieces_root,
         std::cerr << "Error: Cannot open board.csv at " << board_csv << std::endl;
         throw std::runtime_error("Cannot open board.csv");
     }
-    fs::path board_png = root / "board.png";
-
-    auto board_img = img_factory->load(board_png.string(), {512, 512});
-    Board board(64, 64, 8, 8, board_img, 1.0, 1.0);
-
-    PieceFactory pf(board, pieces_root, gfx_factory);
-    std::vector<PiecePtr> out;
-
-    std::string line;
-    int row = 0;
-    // std::cout << "=== Reading board.csv ===" << std::endl;
-    while (std::getline(in, line))
+    return create_game(in, pieces_root, img_factory);
+}
+inline void Game::_draw()
+{
+    Board frame = [&]
     {
-        // std::cout << "Line " << row << ": '" << line << "'" << std::endl;
-
-        std::stringstream ss(line);
-        std::string cell;
-        int col = 0;
-        while (std::getline(ss, cell, ','))
-        {
-            // std::cout << "Line " << row << ": '" << line << "'" << std::endl;
-            //  הסרת רווחים מיותרים
-            cell.erase(0, cell.find_first_not_of(" \t\r\n"));
-            cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
+        ProfileScope scope(profiler, TickPhase::Render);
+        return render_frame(game_time_ms());
+    }();
+    {
+        ProfileScope scope(profiler, TickPhase::Show);
+        frame.show();
+    }
+    profiler.frame_presented();
+    input_latency.frame_presented(clock_now_ns());
+}
 
-            if (!cell.empty())
+inline bool Game::set_view_cell_px(int px)
+{
+    ImgPtr scaled;
+    std::unordered_map<const Img *, ImgPtr> sprites;
+    if (px > 0 && px != board.cell_W_pix)
+    {
+        scaled = board.img->resized(board.W_cells * px, board.H_cells * px);
+        if (!scaled)
+            return false;
+        // Sprites must be the cell's size: a larger one overlaps its
+        // neighbours and does not fit in the last row and column.  Sizes
+        // without a level are scaled once here, from the next larger level
+        int h = px * board.cell_H_pix / board.cell_W_pix;
+        for (const auto &p : roster)
+            for (const auto &st : p->state_list())
             {
-                // std::cout << "  Creating piece: '" << cell << "' at (" << col << "," << row << ")" << std::endl;
-                try
-                {
-                    std::cout << "Creating piece '" << cell << "' at board position (row=" << row << ", col=" << col << ")" << std::endl;
-                    auto piece = pf.create_piece(cell, {row, col});
-                    if (piece)
-                    {
-                        std::cout << "SUCCESS: Created piece " << piece->id << " at (" << col << "," << row << ")" << std::endl;
-                        out.push_back(piece);
-                    }
-                    else
+                const Graphics *g = st->graphics.get();
+                size_t level = g ? g->source_level(px) : 0;
+                if (!g || g->level_px(level) == px)
+                    continue;
+                for (const auto &frame : g->level_frames(level))
+                    if (frame && !sprites.count(frame.get()))
                     {
-                        std::cout << "ERROR: create_piece returned nullptr for '" << cell << "'" << std::endl;
+                        ImgPtr exact = frame->resized(px, h);
+                        if (!exact)
+                            return false;
+                        sprites.emplace(frame.get(), std::move(exact));
                     }
-                }
-                catch (const std::exception &e)
-                {
-                    std::cout << "    EXCEPTION: " << e.what() << std::endl;
-                }
             }
-            ++col;
-        }
-        ++row;
     }
-    return Game(out, board);
+    else
+        px = 0;
+    view_px = px;
+    view_board = std::move(scaled);
+    view_sprites = std::move(sprites);
+    // Rebuild both layers at the new size
+    piece_layer.reset();
+    frame_img.reset();
+    drawn_sprites.clear();
+    return true;
 }
-inline void Game::_draw()
+
+inline Board Game::render_frame(int now)
 {
-    Board display_board = clone_board();
-    int now = game_time_ms();
+    ++layer_stats.frames;
+    const Img &background = view_board ? *view_board : *board.img;
+    int cell_w = view_px ? view_px : board.cell_W_pix;
+    int cell_h = view_px ? view_px * board.cell_H_pix / board.cell_W_pix : board.cell_H_pix;
+
+    // --- piece layer: the board with every sprite, redrawn only when a
+    // sprite changed frame or moved
+    next_sprites.clear();
     for (const auto &p : pieces)
     {
         auto pos_pix = p->state->physics->get_pos_pix();
         p->state->graphics->update(now);
-        ImgPtr sprite = p->state->graphics->get_img();
-        sprite->draw_on(*display_board.img, pos_pix.first, pos_pix.second);
+        if (view_px)
+        {
+            const Graphics &g = *p->state->graphics;
+            Img *sprite = g.level_img(g.source_level(view_px)).get();
+            auto scaled = view_sprites.find(sprite);
+            if (scaled != view_sprites.end())
+                sprite = scaled->second.get();
+            next_sprites.push_back(SpriteKey{sprite, pos_pix.first * view_px / board.cell_W_pix,
+                                             pos_pix.second * cell_h / board.cell_H_pix});
+        }
+        else
+            next_sprites.push_back(SpriteKey{p->state->graphics->get_img().get(), pos_pix.first, pos_pix.second});
+    }
+    bool pieces_dirty = !piece_layer || next_sprites != drawn_sprites;
+    if (pieces_dirty)
+    {
+        // The board layer is the background itself, drawn (and scaled) once
+        if (!piece_layer || !background.copy_to(*piece_layer))
+            piece_layer = background.clone();
+        for (const auto &s : next_sprites)
+            s.sprite->draw_on(*piece_layer, s.x, s.y);
+        drawn_sprites.swap(next_sprites);
+        ++layer_stats.piece_redraws;
     }
 
+    // --- overlay: cursors, selections and the HUD over the piece layer
+    OverlayKey overlay;
     if (kp1 && kp2)
     {
-        std::vector<PlayerData> players = {
-            PlayerData{1, kp1, &last_cursor1},
-            PlayerData{2, kp2, &last_cursor2}};
+        overlay.cursors = {kp1->get_cursor(), kp2->get_cursor()};
+        overlay.selections = {kb_prod_1->get_display_selection(), kb_prod_2->get_display_selection()};
+    }
+    bool hud = hud_visible && profiler.enabled();
+    if (hud)
+        hud_text = profiler.hud_lines();
+    else
+        hud_text.clear();
+    if (pieces_dirty || !frame_img || !(overlay == drawn_overlay) || hud_text != drawn_hud)
+    {
+        if (!frame_img || !piece_layer->copy_to(*frame_img))
+            frame_img = piece_layer->clone();
+        draw_overlay(*frame_img, overlay, cell_w, cell_h);
+        drawn_overlay = overlay;
+        drawn_hud = hud_text;
+        ++layer_stats.overlay_redraws;
+    }
 
-        for (const auto &data : players)
+    Board display_board = board;
+    display_board.cell_W_pix = cell_w;
+    display_board.cell_H_pix = cell_h;
+    display_board.img = frame_img;
+    return display_board;
+}
+
+inline void Game::draw_overlay(Img &img, const OverlayKey &overlay, int cell_w, int cell_h) const
+{
+    if (kp1 && kp2)
+    {
+        static const std::vector<uint8_t> green{0, 255, 0}; // ירוק לשחקן 1
+        static const std::vector<uint8_t> blue{0, 0, 255};  // כחול לשחקן 2
+        int inset = std::max(1, cell_w / 16);
+        for (int i = 0; i < 2; ++i)
         {
-            int player = data.player;
-            std::shared_ptr<KeyboardProcessor> kp = data.kp;
-            std::pair<int, int> *last = data.last_cursor; // שינוי כאן - pointer רגיל
-
-            // קבלת מיקום הסמן
-            std::pair<int, int> pos = kp->get_cursor();
-            int r = pos.first;
-            int c = pos.second;
-
-            // חישוב גבולות המלבן
-            int y1 = r * board.cell_H_pix;
-            int x1 = c * board.cell_W_pix;
-            int y2 = y1 + board.cell_H_pix - 1;
-            int x2 = x1 + board.cell_W_pix - 1;
-
-            // צבע לפי שחקן
-            std::vector<uint8_t> color = (player == 1) ? std::vector<uint8_t>{0, 255, 0} : // ירוק לשחקן 1
-                                             std::vector<uint8_t>{0, 0, 255};              // כחול לשחקן 2
-
-            // חישוב רוחב וגובה
-            int width = x2 - x1 + 1;
-            int height = y2 - y1 + 1;
-
-            // ציור המלבן
-            display_board.img->draw_rect(x1, y1, width, height, color);
-
-            // הדפסת לוג רק אם הסמן השתנה
-            if (*last != pos)
-            {
-                // logger.debug("Marker P%d moved to (%d, %d)", player, r, c);
-                *last = pos;
-            }
+            const std::vector<uint8_t> &color = (i == 0) ? green : blue;
+            // מלבן הסמן על התא כולו
+            auto pos = overlay.cursors[i];
+            img.draw_rect(pos.second * cell_w, pos.first * cell_h, cell_w, cell_h, color);
+            // The selected piece's cell, inset
+            auto sel = overlay.selections[i];
+            if (sel.first >= 0)
+                img.draw_rect(sel.second * cell_w + inset, sel.first * cell_h + inset,
+                              cell_w - 2 * inset, cell_h - 2 * inset, color);
         }
     }
-    display_board.show();
+    int y = 16;
+    for (const auto &line : hud_text)
+    {
+        img.put_text(line, 8, y, 0.4);
+        y += 14;
+    }
 }
 inline void Game::_show() const
 {
@@ -1,34 +1,59 @@
 #include "Graphics.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <chrono>
 #include <stdexcept>
 #include <filesystem>
 
-Graphics::Graphics(const std::string& sprites_folder,
+std::shared_ptr<SpriteLevels> SpriteLevels::load(const std::string& sprites_folder,
 	std::pair<int, int> cell_size,
-	ImgFactoryPtr img_factory,
-	bool loop_, double fps_)
-
-	: loop(loop_), fps(fps_), frame_duration_ms(1000.0 / fps_) {
+	const ImgFactoryPtr& img_factory,
+	const std::vector<double>& scales) {
 
     namespace fs = std::filesystem;
-    if(!sprites_folder.empty() && img_factory) {
-        std::vector<fs::path> pngs;
-        fs::path root(sprites_folder);
-        if(fs::exists(root) && fs::is_directory(root)) {
-            for(const auto& entry : fs::directory_iterator(root)) {
-                if(entry.is_regular_file() && entry.path().extension() == ".png") {
-                    pngs.push_back(entry.path());
-                }
+    auto out = std::make_shared<SpriteLevels>();
+    for(double scale : scales) {
+        out->px.push_back(static_cast<int>(std::lround(cell_size.first * scale)));
+        out->frames.emplace_back();
+    }
+    if(sprites_folder.empty() || !img_factory) return out;
+
+    std::vector<fs::path> pngs;
+    fs::path root(sprites_folder);
+    if(fs::exists(root) && fs::is_directory(root)) {
+        for(const auto& entry : fs::directory_iterator(root)) {
+            if(entry.is_regular_file() && entry.path().extension() == ".png") {
+                pngs.push_back(entry.path());
             }
-            std::sort(pngs.begin(), pngs.end());
-            for(const auto& p : pngs) {
-                auto img_ptr = img_factory->load(p.string(), cell_size);
-                if(img_ptr) frames.push_back(img_ptr); // copy into value vector
+        }
+        std::sort(pngs.begin(), pngs.end());
+        for(const auto& p : pngs) {
+            // Decode once at full size and scale down (or up) per level
+            ImgPtr full = scales.size() > 1 ? img_factory->load(p.string()) : nullptr;
+            for(size_t l = 0; l < scales.size(); ++l) {
+                std::pair<int, int> size{
+                    static_cast<int>(std::lround(cell_size.first * scales[l])),
+                    static_cast<int>(std::lround(cell_size.second * scales[l]))};
+                ImgPtr img = full ? full->resized(size.first, size.second) : nullptr;
+                if(!img) img = img_factory->load(p.string(), size);
+                if(img) out->frames[l].push_back(img);
             }
         }
     }
+    return out;
+}
+
+Graphics::Graphics(const std::string& sprites_folder,
+	std::pair<int, int> cell_size,
+	ImgFactoryPtr img_factory,
+	bool loop_, double fps_)
+	: Graphics(SpriteLevels::load(sprites_folder, cell_size, img_factory), loop_, fps_) {}
+
+Graphics::Graphics(std::shared_ptr<const SpriteLevels> levels_, bool loop_, double fps_)
+	: levels(std::move(levels_)), loop(loop_), fps(fps_), frame_duration_ms(1000.0 / fps_) {
+    if(levels && !levels->frames.empty()) frames = levels->frames[0];
 }
 
 void Graphics::reset(const Command& cmd) {
@@ -37,15 +62,48 @@ void Graphics::reset(const Command& cmd) {
 }
 
 void Graphics::update(int now_ms) {
+	cur_frame = frame_at(now_ms);
+}
+
+size_t Graphics::frame_at(int now_ms) const {
+	if (frames.empty()) return 0;
 	int elapsed = now_ms - start_ms;
 	int frames_passed = static_cast<int>(elapsed / frame_duration_ms);
 	if (loop)
-		cur_frame = frames_passed % frames.size();
-	else
-		cur_frame = std::min<size_t>(frames_passed, frames.size() - 1);
+		return frames_passed % frames.size();
+	return std::min<size_t>(frames_passed, frames.size() - 1);
 }
 
 const ImgPtr Graphics::get_img() const {
 	if (frames.empty()) throw std::runtime_error("Graphics has no frames loaded");
 	return frames[cur_frame];
-}
\ No newline at end of file
+}
+
+size_t Graphics::source_level(int cell_px) const {
+	if (!levels) return 0;
+	size_t best = 0;
+	for (size_t l = 0; l < levels->px.size(); ++l) {
+		if (l > 0 && levels->frames[l].size() != frames.size()) continue;
+		int px = levels->px[l], best_px = levels->px[best];
+		bool fits = px >= cell_px, best_fits = best_px >= cell_px;
+		// Prefer a level that fits, then the smallest that fits, then the largest
+		if (fits != best_fits ? fits : (fits ? px < best_px : px > best_px)) best = l;
+	}
+	return best;
+}
+
+int Graphics::level_px(size_t level) const {
+	if (levels && level < levels->px.size()) return levels->px[level];
+	return frames.empty() ? 0 : frames[0]->size().first;
+}
+
+const std::vector<ImgPtr>& Graphics::level_frames(size_t level) const {
+	// Level 0 is `frames`, which set_frames may have replaced
+	if (level == 0 || !levels) return frames;
+	return levels->frames[level];
+}
+
+const ImgPtr& Graphics::level_img(size_t level) const {
+	if (frames.empty()) throw std::runtime_error("Graphics has no frames loaded");
+	return level_frames(level)[cur_frame];
+}
@@ -7,6 +7,19 @@
 #include <utility>  // בשביל std::pair
 
 
+// The frames of one sprite folder at several sizes, made once at load time
+// and shared by every piece using the folder.  Level 0 is the board's cell
+// size; the others are scales of it for larger or smaller views.
+struct SpriteLevels {
+	std::vector<int> px;                       // cell width of each level
+	std::vector<std::vector<ImgPtr>> frames;   // [level][frame]
+
+	static std::shared_ptr<SpriteLevels> load(const std::string& sprites_folder,
+		std::pair<int, int> cell_size,
+		const ImgFactoryPtr& img_factory,
+		const std::vector<double>& scales = {1.0});
+};
+
 class Graphics {
 public:
 	Graphics(const std::string& sprites_folder,
@@ -14,17 +27,32 @@ public:
 		ImgFactoryPtr img_factory,
 		bool loop = true,
 		double fps = 6.0);
+	Graphics(std::shared_ptr<const SpriteLevels> levels, bool loop = true, double fps = 6.0);
 
 	void reset(const Command& cmd);
 	void update(int now_ms);
+	// The frame update(now_ms) would show, without changing anything
+	size_t frame_at(int now_ms) const;
 	const ImgPtr get_img() const;
+	size_t level_count() const { return levels ? levels->px.size() : 1; }
+	// The level to draw a cell_px view from: the one that size, else the
+	// smallest larger one (scaling down keeps detail), else the largest
+	size_t source_level(int cell_px) const;
+	int level_px(size_t level) const;
+	// Every frame of a level, and its current one
+	const std::vector<ImgPtr>& level_frames(size_t level) const;
+	const ImgPtr& level_img(size_t level) const;
 
 	// Test helpers ---------------------------------------------------------
 	size_t current_frame() const { return cur_frame; }
+	int start_time() const { return start_ms; }
+	// Snapshot restore: reinstate animation timing without a command
+	void restore_timing(int start, size_t frame) { start_ms = start; cur_frame = frame; }
 	void set_frames(const std::vector<ImgPtr>& new_frames) { frames = new_frames; }
 
 private:
-	std::vector<ImgPtr> frames;
+	std::vector<ImgPtr> frames;                  // level 0
+	std::shared_ptr<const SpriteLevels> levels;  // all levels, when loaded so
 	bool loop{ true };
 	double fps{ 6.0 };
 	int start_ms{ 0 };
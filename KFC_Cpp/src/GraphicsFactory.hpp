@@ -6,27 +6,39 @@
 #include "img/ImgFactory.hpp"
 #include "nlohmann/json_fwd.hpp"
 #include <utility>  // בשביל std::pair
+#include <unordered_map>
+#include <vector>
 
 
 // Simple GraphicsFactory that forwards an image loader placeholder to
 // Graphics.  In this head-less C++ port, the img_loader is unused but the
 // factory mirrors the Python API expected by the unit tests.
+//
+// Sprites are loaded at every scale in sprite_scales (see SpriteLevels) and
+// each folder only once: pieces of the same kind share their images.
 class GraphicsFactory
 {
 public:
-    explicit GraphicsFactory(ImgFactoryPtr factory_ptr = nullptr)
-        : img_factory(factory_ptr) {}
+    explicit GraphicsFactory(ImgFactoryPtr factory_ptr = nullptr,
+                             std::vector<double> scales = default_sprite_scales())
+        : img_factory(factory_ptr), sprite_scales(std::move(scales)) {}
+
+    // Board cell size, half and double: small windows to high-DPI views
+    static std::vector<double> default_sprite_scales() { return {1.0, 0.5, 2.0}; }
 
     std::shared_ptr<Graphics> load(const std::string &sprites_dir,
                                    const nlohmann::json & /*cfg*/, // ignored
                                    std::pair<int, int> cell_size) const
     {
-        // For now, create a Graphics object with blank frames produced by img_factory
-        auto gfx = std::make_shared<Graphics>(sprites_dir, cell_size, img_factory, /*loop*/ true, /*fps*/ 6.0);
-        (void)cell_size; // unused for now
-        return gfx;
+        std::string key = sprites_dir + "@" + std::to_string(cell_size.first) + "x" + std::to_string(cell_size.second);
+        auto &levels = cache[key];
+        if (!levels)
+            levels = SpriteLevels::load(sprites_dir, cell_size, img_factory, sprite_scales);
+        return std::make_shared<Graphics>(levels, /*loop*/ true, /*fps*/ 6.0);
     }
 
 private:
     ImgFactoryPtr img_factory;
+    std::vector<double> sprite_scales;
+    mutable std::unordered_map<std::string, std::shared_ptr<const SpriteLevels>> cache;
 };
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Receives keys from the dispatcher thread
+class KeySink
+{
+public:
+    virtual ~KeySink() = default;
+    // captured_ns: when the key was read (GameClock ns)
+    virtual void on_key(const std::string &key, uint64_t captured_ns) = 0;
+};
+
+// ---------------------------------------------------------------------------
+// One input thread for all players.  post() queues a key and wakes the
+// thread through a condition variable, so a key is handled as soon as it
+// arrives and an idle dispatcher sleeps without waking up.  The thread runs
+// only while at least one sink is attached.
+// ---------------------------------------------------------------------------
+class InputDispatcher
+{
+public:
+    InputDispatcher() = default;
+    ~InputDispatcher()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        sinks.clear();
+        stop_thread(lock);
+    }
+
+    InputDispatcher(const InputDispatcher &) = delete;
+    InputDispatcher &operator=(const InputDispatcher &) = delete;
+
+    // The dispatcher the game's keyboard producers share
+    static InputDispatcher &shared()
+    {
+        static InputDispatcher d;
+        return d;
+    }
+
+    void attach(KeySink *sink)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        // Never two threads: let one that is shutting down finish first
+        idle.wait(lock, [&]
+                  { return !retiring; });
+        if (std::find(sinks.begin(), sinks.end(), sink) != sinks.end())
+            return;
+        sinks.push_back(sink);
+        if (!worker.joinable())
+            worker = std::thread(&InputDispatcher::run, this, generation);
+    }
+
+    // Drops the sink's queued keys and waits for a call in progress to
+    // return; the thread exits with the last sink.  A sink may detach from
+    // inside its own on_key: that call is the one in progress, so there is
+    // nothing to wait for, and the thread cannot join itself; it then stays
+    // idle until the next detach or the dispatcher's destruction.
+    void detach(KeySink *sink)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [sink](const Item &i)
+                                     { return i.sink == sink; }),
+                      pending.end());
+        if (std::this_thread::get_id() == worker.get_id())
+            return;
+        idle.wait(lock, [&]
+                  { return busy != sink; });
+        if (sinks.empty())
+            stop_thread(lock);
+    }
+
+    // Queue a key for an attached sink; ignored otherwise
+    void post(KeySink *sink, std::string key, uint64_t captured_ns)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (std::find(sinks.begin(), sinks.end(), sink) == sinks.end())
+                return;
+            pending.push_back(Item{sink, std::move(key), captured_ns});
+        }
+        wake.notify_one();
+    }
+
+    bool running() const
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return worker.joinable();
+    }
+
+private:
+    struct Item
+    {
+        KeySink *sink;
+        std::string key;
+        uint64_t captured_ns;
+    };
+
+    // gen: the generation this thread serves; a newer one means stop
+    void run(uint64_t gen)
+    {
+        trace_thread_name("input dispatch");
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;)
+        {
+            wake.wait(lock, [&]
+                      { return generation != gen || !pending.empty(); });
+            if (generation != gen)
+                return;
+            Item item = std::move(pending.front());
+            pending.pop_front();
+            busy = item.sink;
+            lock.unlock();
+            item.sink->on_key(item.key, item.captured_ns);
+            lock.lock();
+            busy = nullptr;
+            idle.notify_all();
+        }
+    }
+
+    // Called with the lock held; releases it while joining
+    void stop_thread(std::unique_lock<std::mutex> &lock)
+    {
+        if (!worker.joinable())
+            return;
+        ++generation;
+        retiring = true;
+        std::thread t = std::move(worker);
+        lock.unlock();
+        wake.notify_all();
+        t.join();
+        lock.lock();
+        retiring = false;
+        idle.notify_all();
+    }
+
+    mutable std::mutex mtx;
+    std::condition_variable wake; // keys queued or the thread retired
+    std::condition_variable idle; // a sink call returned or the thread retired
+    std::vector<KeySink *> sinks;
+    std::deque<Item> pending;
+    KeySink *busy{nullptr};
+    uint64_t generation{0};
+    bool retiring{false};
+    std::thread worker;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Clock.hpp"
+#include "Command.hpp"
+#include "Profiler.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+// Stages a key press goes through before the player sees its effect
+enum class InputStage
+{
+    Produce, // key captured -> command pushed to the input queue
+    Queue,   // waiting in the queue for the game loop
+    Apply,   // process_input up to the piece's state transition
+    Display, // transition -> first presented frame showing it
+    Total,   // key captured -> presented
+    Count
+};
+
+inline const char *input_stage_name(InputStage s)
+{
+    static const char *names[] = {"produce", "queue", "apply", "display", "total"};
+    return names[static_cast<int>(s)];
+}
+
+// ---------------------------------------------------------------------------
+// Input-to-display latency, one histogram per stage.  Only commands stamped
+// with a capture time (live key presses) are measured.  A key is stamped
+// when it is read (KeyInput.hpp): from the window after each frame
+// (OpenCvImg::show) and by drain_window_keys while the game loop waits for
+// the next one, from the terminal by the InputPump.  Time a key spends
+// queued in the window system before that read is not included.
+//
+// Called from the game loop thread only; the histograms may be read from
+// anywhere.
+// ---------------------------------------------------------------------------
+class InputLatency
+{
+public:
+    static constexpr size_t kMaxPending = 64;
+
+    InputLatency() { pending.reserve(kMaxPending); }
+
+    // The loop finished processing cmd, dequeued at dequeued_ns.  changed:
+    // the piece made a state transition (a rejected move does not).
+    void command_processed(const Command &cmd, uint64_t dequeued_ns, uint64_t done_ns, bool changed)
+    {
+        if (!cmd.captured_ns)
+            return;
+        if (cmd.queued_ns)
+        {
+            record(InputStage::Produce, cmd.queued_ns, cmd.captured_ns);
+            record(InputStage::Queue, dequeued_ns, cmd.queued_ns);
+        }
+        if (!changed)
+        {
+            ++rejected_;
+            return;
+        }
+        record(InputStage::Apply, done_ns, dequeued_ns);
+        if (pending.size() < kMaxPending)
+            pending.push_back(Pending{cmd.captured_ns, done_ns});
+        else
+            ++unshown_; // nothing is presenting frames (headless)
+    }
+
+    // A frame was put on screen; everything applied before it is now visible
+    void frame_presented(uint64_t now_ns)
+    {
+        for (const auto &p : pending)
+        {
+            record(InputStage::Display, now_ns, p.applied_ns);
+            record(InputStage::Total, now_ns, p.captured_ns);
+        }
+        pending.clear();
+    }
+
+    const LatencyHistogram &histogram(InputStage s) const { return hist[static_cast<int>(s)]; }
+    size_t pending_count() const { return pending.size(); }
+    uint64_t rejected() const { return rejected_; }
+
+    void dump(std::ostream &os) const
+    {
+        os << "=== Input latency (ms) ===\n";
+        char line[128];
+        for (int i = 0; i < static_cast<int>(InputStage::Count); ++i)
+        {
+            const auto &h = hist[i];
+            std::snprintf(line, sizeof line, "%-8s n %6llu  mean %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f\n",
+                          input_stage_name(static_cast<InputStage>(i)), static_cast<unsigned long long>(h.count()),
+                          h.mean() / 1e6, h.percentile(0.50) / 1e6, h.percentile(0.90) / 1e6,
+                          h.percentile(0.99) / 1e6, h.max() / 1e6);
+            os << line;
+        }
+        std::snprintf(line, sizeof line, "rejected %llu  never shown %llu\n",
+                      static_cast<unsigned long long>(rejected_), static_cast<unsigned long long>(unshown_));
+        os << line;
+    }
+
+    void reset()
+    {
+        for (auto &h : hist)
+            h.reset();
+        pending.clear();
+        rejected_ = 0;
+        unshown_ = 0;
+    }
+
+private:
+    struct Pending
+    {
+        uint64_t captured_ns;
+        uint64_t applied_ns;
+    };
+
+    void record(InputStage s, uint64_t later, uint64_t earlier)
+    {
+        hist[static_cast<int>(s)].record(later > earlier ? later - earlier : 0);
+    }
+
+    std::array<LatencyHistogram, static_cast<size_t>(InputStage::Count)> hist;
+    std::vector<Pending> pending;
+    uint64_t rejected_{0};
+    uint64_t unshown_{0};
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "KeyCodes.hpp"
+#include "KeyInput.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Where key presses come from.  Game::feed_input pulls every event due by
+// the game time it is given and hands it to the players' producers on the
+// calling thread, so a source drives the game in virtual time: no input
+// threads, no sleeping, as many keys per game millisecond as the source
+// produces.
+//
+//   KeyboardSource  keys pressed in the window (or terminal), stamped now
+//   ScriptedSource  "<ms> <key>" lines at absolute game times
+//   SessionPlayer   a RecordingSource capture, moved to a new start and speed
+//   FuzzSource      seeded random keys at a fixed rate
+// ---------------------------------------------------------------------------
+struct InputEvent
+{
+    int time_ms{0};
+    KeyCode key{key_code::None};
+};
+
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+    // The next event due at or before now_ms; false when none is due yet
+    virtual bool poll(int now_ms, InputEvent &ev) = 0;
+    // No event will ever come again
+    virtual bool finished() const { return false; }
+};
+
+// Keys waiting in the window's event queue (see set_window_key_poller).
+// Do not run it next to an InputPump: both read the same queue.
+class KeyboardSource : public InputSource
+{
+public:
+    bool poll(int now_ms, InputEvent &ev) override
+    {
+        for (int raw = poll_window_key(); raw != -1; raw = poll_window_key())
+        {
+            KeyCode code = key_code_from_raw(raw);
+            if (code == key_code::None)
+                continue;
+            ev = InputEvent{now_ms, code};
+            return true;
+        }
+        return false;
+    }
+};
+
+namespace input_source_detail
+{
+// "space" stands for the key a script cannot write literally
+inline KeyCode parse_key(const std::string &name)
+{
+    return name == "space" ? KeyCode(' ') : key_code_from_name(name);
+}
+
+inline std::string key_token(KeyCode code)
+{
+    return code == ' ' ? std::string("space") : key_name(code);
+}
+
+// "<ms> <key>" per line; blank lines and '#' comments are skipped.  Sorted
+// by time, keeping the file's order within a millisecond.
+inline std::vector<InputEvent> parse_events(std::istream &in)
+{
+    std::vector<InputEvent> events;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line))
+    {
+        ++line_no;
+        auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        std::istringstream ls(line);
+        int t;
+        std::string name;
+        if (!(ls >> t >> name))
+            throw std::runtime_error("Bad key line " + std::to_string(line_no) + ": " + line);
+        KeyCode code = parse_key(name);
+        if (code == key_code::None)
+            throw std::runtime_error("Unknown key '" + name + "' on line " + std::to_string(line_no));
+        events.push_back(InputEvent{t, code});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const InputEvent &a, const InputEvent &b)
+                     { return a.time_ms < b.time_ms; });
+    return events;
+}
+} // namespace input_source_detail
+
+// A fixed list of events, played at their own times
+class ScriptedSource : public InputSource
+{
+public:
+    explicit ScriptedSource(std::vector<InputEvent> events) : events(std::move(events))
+    {
+        std::stable_sort(this->events.begin(), this->events.end(), [](const InputEvent &a, const InputEvent &b)
+                         { return a.time_ms < b.time_ms; });
+    }
+    explicit ScriptedSource(std::istream &in) : events(input_source_detail::parse_events(in)) {}
+
+    bool poll(int now_ms, InputEvent &ev) override
+    {
+        if (next >= events.size() || events[next].time_ms > now_ms)
+            return false;
+        ev = events[next++];
+        return true;
+    }
+    bool finished() const override { return next >= events.size(); }
+    size_t size() const { return events.size(); }
+
+private:
+    std::vector<InputEvent> events;
+    size_t next{0};
+};
+
+// Passes another source through and writes every event it yields in the
+// script format, for SessionPlayer (or ScriptedSource) to play back.
+class RecordingSource : public InputSource
+{
+public:
+    RecordingSource(InputSource &inner, std::ostream &out) : inner(inner), out(out)
+    {
+        out << "# kfc keys 1\n";
+    }
+
+    bool poll(int now_ms, InputEvent &ev) override
+    {
+        if (!inner.poll(now_ms, ev))
+            return false;
+        out << ev.time_ms << ' ' << input_source_detail::key_token(ev.key) << '\n';
+        return true;
+    }
+    bool finished() const override { return inner.finished(); }
+
+private:
+    InputSource &inner;
+    std::ostream &out;
+};
+
+// A recorded session, its first key moved to start_ms and its pace scaled
+// by speed (2 = twice as fast)
+class SessionPlayer : public InputSource
+{
+public:
+    SessionPlayer(std::istream &recording, int start_ms = 0, double speed = 1.0)
+        : script(retime(input_source_detail::parse_events(recording), start_ms, speed))
+    {
+    }
+
+    bool poll(int now_ms, InputEvent &ev) override { return script.poll(now_ms, ev); }
+    bool finished() const override { return script.finished(); }
+
+private:
+    static std::vector<InputEvent> retime(std::vector<InputEvent> events, int start_ms, double speed)
+    {
+        if (speed <= 0)
+            throw std::invalid_argument("SessionPlayer speed must be positive");
+        if (events.empty())
+            return events;
+        int first = events.front().time_ms;
+        for (auto &e : events)
+            e.time_ms = start_ms + static_cast<int>((e.time_ms - first) / speed);
+        return events;
+    }
+
+    ScriptedSource script;
+};
+
+// keys_per_ms random keys from `keys` every game millisecond, the same
+// sequence for the same seed
+class FuzzSource : public InputSource
+{
+public:
+    explicit FuzzSource(uint64_t seed, int keys_per_ms = 1, std::vector<KeyCode> keys = default_keys())
+        : state(seed ? seed : 0x9e3779b97f4a7c15ull), keys_per_ms(std::max(1, keys_per_ms)), keys(std::move(keys))
+    {
+        if (this->keys.empty())
+            throw std::invalid_argument("FuzzSource needs at least one key");
+    }
+
+    // Both players' keys
+    static std::vector<KeyCode> default_keys()
+    {
+        return {key_code::Up, key_code::Down, key_code::Left, key_code::Right, key_code::Enter, '+',
+                'w', 's', 'a', 'd', 'f', 'g'};
+    }
+
+    bool poll(int now_ms, InputEvent &ev) override
+    {
+        if (next_ms > now_ms)
+            return false;
+        ev = InputEvent{next_ms, keys[static_cast<size_t>(next_random() % keys.size())]};
+        if (++emitted_in_ms == keys_per_ms)
+        {
+            emitted_in_ms = 0;
+            ++next_ms;
+        }
+        return true;
+    }
+
+    // Start emitting at this game time
+    void skip_to(int ms) { next_ms = std::max(next_ms, ms); }
+
+private:
+    // xorshift64*
+    uint64_t next_random()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ull;
+    }
+
+    uint64_t state;
+    int keys_per_ms;
+    std::vector<KeyCode> keys;
+    int next_ms{0};
+    int emitted_in_ms{0};
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// One byte per key, so keymaps compile into 256-entry tables.  Printable
+// keys are their lower-case ASCII code, enter/esc their control codes and
+// the arrows take the unused device-control codes 0x11-0x14.  Code 0 is
+// "no key".
+// ---------------------------------------------------------------------------
+using KeyCode = uint8_t;
+
+namespace key_code
+{
+constexpr KeyCode None = 0;
+constexpr KeyCode Enter = 13;
+constexpr KeyCode Esc = 27;
+constexpr KeyCode Up = 0x11;
+constexpr KeyCode Down = 0x12;
+constexpr KeyCode Left = 0x13;
+constexpr KeyCode Right = 0x14;
+} // namespace key_code
+
+namespace key_code_detail
+{
+inline KeyCode from_char(int c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return static_cast<KeyCode>(c + 32); // המרה לאות קטנה
+    if (c >= 32 && c < 127)
+        return static_cast<KeyCode>(c);
+    return key_code::None;
+}
+
+// Raw OpenCV waitKey codes below 256
+inline const std::array<KeyCode, 256> &raw_table()
+{
+    static const std::array<KeyCode, 256> table = []
+    {
+        std::array<KeyCode, 256> t{};
+        for (int c = 0; c < 256; ++c)
+            t[c] = from_char(c);
+        t[13] = key_code::Enter;
+        t[27] = key_code::Esc;
+        // מקשים שראינו בפלט עם פריסת מקלדת עברית
+        t[249] = 'a';
+        t[227] = 's';
+        t[226] = 'd';
+        t[39] = 'w';
+        t[235] = 'f';
+        return t;
+    }();
+    return table;
+}
+
+inline const std::array<std::string, 256> &name_table()
+{
+    static const std::array<std::string, 256> table = []
+    {
+        std::array<std::string, 256> t;
+        for (int c = 32; c < 127; ++c)
+            if (from_char(c) == c)
+                t[c] = std::string(1, static_cast<char>(c));
+        t[key_code::Enter] = "enter";
+        t[key_code::Esc] = "esc";
+        t[key_code::Up] = "up";
+        t[key_code::Down] = "down";
+        t[key_code::Left] = "left";
+        t[key_code::Right] = "right";
+        return t;
+    }();
+    return table;
+}
+} // namespace key_code_detail
+
+// A raw key from the window (OpenCV waitKey); extended arrows come as
+// 1000 + scan code.  None for keys the game does not know.
+inline KeyCode key_code_from_raw(int raw)
+{
+    if (raw >= 0 && raw < 256)
+        return key_code_detail::raw_table()[raw];
+    switch (raw)
+    {
+    case 1072:
+        return key_code::Up; // 1000 + 72 = חץ עליון
+    case 1080:
+        return key_code::Down; // 1000 + 80 = חץ תחתון
+    case 1075:
+        return key_code::Left; // 1000 + 75 = חץ שמאל
+    case 1077:
+        return key_code::Right; // 1000 + 77 = חץ ימין
+    default:
+        return key_code::None;
+    }
+}
+
+// A key name as used in keymaps ("up", "enter", "w", "+"); None if unknown
+inline KeyCode key_code_from_name(const std::string &name)
+{
+    if (name.size() == 1)
+        return key_code_detail::from_char(static_cast<unsigned char>(name[0]));
+    const auto &names = key_code_detail::name_table();
+    for (KeyCode c : {key_code::Enter, key_code::Esc, key_code::Up, key_code::Down, key_code::Left, key_code::Right})
+        if (names[c] == name)
+            return c;
+    return key_code::None;
+}
+
+// The keymap name of a code; empty for None
+inline const std::string &key_name(KeyCode code)
+{
+    return key_code_detail::name_table()[code];
+}
@@ -0,0 +1,207 @@
+#include "KeyInput.hpp"
+
+#include "Clock.hpp"
+#include "Tracer.hpp"
+
+#include <chrono>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Keys may be dispatched from the pump while the game installs a handler
+std::mutex &handler_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+KeyHandler &handler_slot()
+{
+    static KeyHandler handler;
+    return handler;
+}
+
+std::mutex &poller_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+KeyPoller &poller_slot()
+{
+    static KeyPoller poller;
+    return poller;
+}
+
+bool g_poller_owner_thread = false; // under poller_mutex
+
+std::atomic<int> g_active_pumps{0};
+} // namespace
+
+void set_global_key_handler(KeyHandler handler)
+{
+    std::lock_guard<std::mutex> lock(handler_mutex());
+    handler_slot() = std::move(handler);
+}
+
+void dispatch_key(int key, uint64_t captured_ns)
+{
+    if (!captured_ns)
+        captured_ns = clock_now_ns();
+    std::lock_guard<std::mutex> lock(handler_mutex());
+    auto &h = handler_slot();
+    if (h)
+        h(key, captured_ns);
+}
+
+void set_window_key_poller(KeyPoller poller, bool owner_thread)
+{
+    std::lock_guard<std::mutex> lock(poller_mutex());
+    poller_slot() = std::move(poller);
+    g_poller_owner_thread = owner_thread;
+}
+
+int poll_window_key()
+{
+    std::lock_guard<std::mutex> lock(poller_mutex());
+    auto &p = poller_slot();
+    return p ? p() : -1;
+}
+
+size_t drain_window_keys(bool from_pump)
+{
+    size_t n = 0;
+    for (;;)
+    {
+        int key;
+        {
+            std::lock_guard<std::mutex> lock(poller_mutex());
+            auto &p = poller_slot();
+            if (!p || (from_pump && g_poller_owner_thread))
+                return n;
+            key = p();
+        }
+        if (key == -1)
+            return n;
+        if (key == 255)
+            continue;
+        uint64_t captured_ns = clock_now_ns();
+        TraceScope scope("input", "window_key");
+        dispatch_key(key, captured_ns);
+        ++n;
+    }
+}
+
+bool input_pump_active()
+{
+    return g_active_pumps.load(std::memory_order_acquire) > 0;
+}
+
+// ---------------- InputPump --------------------
+void InputPump::start(int hz)
+{
+    if (worker.joinable())
+        return;
+    stopping = false;
+    key_count = 0;
+    g_active_pumps.fetch_add(1, std::memory_order_acq_rel);
+    worker = std::thread(&InputPump::run, this, hz < 1 ? 1 : hz);
+}
+
+void InputPump::stop()
+{
+    if (!worker.joinable())
+        return;
+    stopping = true;
+    worker.join();
+    g_active_pumps.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void InputPump::run(int hz)
+{
+    trace_thread_name("input pump");
+    const auto period = std::chrono::nanoseconds(1000000000LL / hz);
+    auto next = std::chrono::steady_clock::now();
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+        // Drain everything that queued up since the last poll
+        key_count.fetch_add(drain_window_keys(/*from_pump*/ true), std::memory_order_relaxed);
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now)
+            next = now; // fell behind: do not try to catch up
+        std::this_thread::sleep_until(next);
+    }
+}
+
+// ---------------- terminal keys --------------------
+#if defined(__unix__) || defined(__APPLE__)
+namespace
+{
+std::mutex g_term_mutex;
+bool g_term_raw = false;
+termios g_term_saved{};
+
+int read_byte()
+{
+    unsigned char c;
+    return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+}
+} // namespace
+
+KeyPoller terminal_key_poller()
+{
+    std::lock_guard<std::mutex> lock(g_term_mutex);
+    if (!::isatty(STDIN_FILENO))
+        return {};
+    if (!g_term_raw)
+    {
+        if (::tcgetattr(STDIN_FILENO, &g_term_saved) != 0)
+            return {};
+        termios raw = g_term_saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0; // reads never block
+        raw.c_cc[VTIME] = 0;
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        g_term_raw = true;
+    }
+    return []
+    {
+        int c = read_byte();
+        if (c == '\n')
+            return 13; // enter, as the window reports it
+        if (c != 27)
+            return c;
+        // ESC [ A..D are the arrows; a lone ESC is esc
+        int c1 = read_byte();
+        if (c1 != '[')
+            return 27;
+        switch (read_byte())
+        {
+        case 'A':
+            return 1072;
+        case 'B':
+            return 1080;
+        case 'C':
+            return 1077;
+        case 'D':
+            return 1075;
+        default:
+            return -1;
+        }
+    };
+}
+
+void restore_terminal_keys()
+{
+    std::lock_guard<std::mutex> lock(g_term_mutex);
+    if (g_term_raw)
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &g_term_saved);
+    g_term_raw = false;
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Raw key codes from whatever window shows the game.  The renderer reads
+// keys and hands them to dispatch_key; the game installs the handler.  Kept
+// out of the renderer so the simulation core does not depend on an image
+// library.
+//
+// Keys are read by the renderer after each frame (OpenCvImg::show) and, so
+// input does not wait for a frame to finish, at a fixed rate in between:
+// a window's queue by the game loop while it waits for the next frame
+// (drain_window_keys), the terminal by an InputPump on its own thread.
+// ---------------------------------------------------------------------------
+
+// captured_ns: when the key was read (GameClock ns)
+using KeyHandler = std::function<void(int key, uint64_t captured_ns)>;
+// Returns the next pending key code, or -1 when there is none
+using KeyPoller = std::function<int()>;
+
+// פונקציה גלובלית להגדרת handler למקשים
+void set_global_key_handler(KeyHandler handler);
+
+// Pass one key code to the installed handler, if any; captured_ns 0 stamps
+// it now
+void dispatch_key(int key, uint64_t captured_ns = 0);
+
+// Where keys are read from.  The renderer installs its window's event queue
+// when it opens the window; an empty poller clears it.  owner_thread: only
+// the thread that created the window may read it (HighGUI; on Win32 a
+// window's messages go to that thread's queue alone), so InputPump leaves
+// it to the game loop.
+void set_window_key_poller(KeyPoller poller, bool owner_thread = false);
+// Next key from the installed poller, -1 when none is pending or installed
+int poll_window_key();
+// Reads and dispatches every pending key, stamped as read; returns how many.
+// from_pump: skip an owner_thread poller.
+size_t drain_window_keys(bool from_pump = false);
+
+// A pump is running: renderers leave the window's keys to it
+bool input_pump_active();
+
+#if defined(__unix__) || defined(__APPLE__)
+// Keys typed into the controlling terminal, for headless play.  Puts the
+// terminal in raw mode until restore_terminal_keys(); arrows arrive as the
+// extended codes the window reports (1000 + scan code).  Returns an empty
+// poller when stdin is not a terminal.
+KeyPoller terminal_key_poller();
+void restore_terminal_keys();
+#endif
+
+// Reads the window poller on its own thread, hz times a second, and stamps
+// and dispatches every key as it arrives.  Pollers bound to their window's
+// thread are skipped.
+class InputPump
+{
+public:
+    InputPump() = default;
+    ~InputPump() { stop(); }
+    InputPump(const InputPump &) = delete;
+    InputPump &operator=(const InputPump &) = delete;
+
+    void start(int hz = 1000);
+    void stop();
+    bool running() const { return worker.joinable(); }
+    // Keys dispatched since start()
+    uint64_t keys() const { return key_count.load(std::memory_order_relaxed); }
+
+private:
+    void run(int hz);
+
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> key_count{0};
+};
@@ -1,47 +1,119 @@
 #pragma once
 
+#include "KeyCodes.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
-#include <mutex>
+#include <vector>
 #include <utility>  // בשביל std::pair
 
+// What a bound key does; Other is any action the processor only reports
+enum class KeyAction : uint8_t { None, Up, Down, Left, Right, Select, Jump, Other };
+
+inline KeyAction key_action_from_name(const std::string& action) {
+    if(action == "up") return KeyAction::Up;
+    if(action == "down") return KeyAction::Down;
+    if(action == "left") return KeyAction::Left;
+    if(action == "right") return KeyAction::Right;
+    if(action == "select") return KeyAction::Select;
+    if(action == "jump") return KeyAction::Jump;
+    return action.empty() ? KeyAction::None : KeyAction::Other;
+}
 
+// The keymap is compiled into a 256-entry table indexed by KeyCode, and the
+// cursor is one packed atomic word: a key is a table load plus a CAS, and
+// get_cursor() (render path, snapshots) never blocks.
 class KeyboardProcessor {
 public:
     KeyboardProcessor(int rows=0, int cols=0,
                       std::unordered_map<std::string,std::string> keymap={})
-        : rows(rows), cols(cols), keymap(keymap) {
-        cursor[0] = 0; cursor[1] = 0;
+        : rows(rows), cols(cols) {
+        action_names.emplace_back(); // 0 = unbound
+        for(const auto& kv : keymap) {
+            KeyCode code = key_code_from_name(kv.first);
+            if(code == key_code::None) continue; // not a key we can read
+            Binding& b = table[code];
+            b.action = key_action_from_name(kv.second);
+            b.name = intern(kv.second);
+        }
     }
 
     // Return action string when special key, otherwise returns action mapping (up/down etc) or nullopt
     std::string process_key(const std::string& key) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = keymap.find(key);
-        if(it == keymap.end()) return "";
-        const std::string& action = it->second;
-        if(action == "up") {
-            if(cursor[0] > 0) cursor[0] -= 1;
-        } else if(action == "down") {
-            if(cursor[0] < rows-1) cursor[0] += 1;
-        } else if(action == "left") {
-            if(cursor[1] > 0) cursor[1] -= 1;
-        } else if(action == "right") {
-            if(cursor[1] < cols-1) cursor[1] += 1;
-        }
+        KeyCode code = key_code_from_name(key);
+        if(code == key_code::None) return "";
+        process_code(code);
         // Return the action (choose, jump or move directions) so tests can assert.
+        return action_names[table[code].name];
+    }
+
+    // The fast path: moves the cursor for direction keys and returns the action
+    KeyAction process_code(KeyCode code) {
+        KeyAction action = table[code].action;
+        switch(action) {
+        case KeyAction::Up:    step(-1, 0); break;
+        case KeyAction::Down:  step(1, 0); break;
+        case KeyAction::Left:  step(0, -1); break;
+        case KeyAction::Right: step(0, 1); break;
+        default: break;
+        }
         return action;
-    };
+    }
+
+    // Whether this player's keymap binds the key
+    bool binds(KeyCode code) const { return table[code].action != KeyAction::None; }
+    KeyAction action_for(KeyCode code) const { return table[code].action; }
 
     std::pair<int,int> get_cursor() const {
-        std::lock_guard<std::mutex> lock(mtx);
-        return {cursor[0], cursor[1]};
+        return unpack(cursor.load(std::memory_order_acquire));
+    }
+
+    void set_cursor(const std::pair<int,int>& cell) {
+        cursor.store(pack(cell.first, cell.second), std::memory_order_release);
     }
 
 private:
+    struct Binding {
+        KeyAction action{KeyAction::None};
+        uint8_t name{0}; // index into action_names
+    };
+
+    // Row in the high half, column in the low half, each a signed 16 bit value
+    static uint32_t pack(int r, int c) {
+        return (uint32_t(uint16_t(int16_t(r))) << 16) | uint16_t(int16_t(c));
+    }
+    static std::pair<int,int> unpack(uint32_t v) {
+        return {int16_t(uint16_t(v >> 16)), int16_t(uint16_t(v & 0xffff))};
+    }
+
+    void step(int dr, int dc) {
+        uint32_t cur = cursor.load(std::memory_order_relaxed);
+        for(;;) {
+            auto rc = unpack(cur);
+            if((dr < 0 && rc.first <= 0) || (dr > 0 && rc.first >= rows-1) ||
+               (dc < 0 && rc.second <= 0) || (dc > 0 && rc.second >= cols-1))
+                return; // stays at the edge
+            int r = rc.first + dr, c = rc.second + dc;
+            if(cursor.compare_exchange_weak(cur, pack(r, c), std::memory_order_acq_rel,
+                                            std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    uint8_t intern(const std::string& action) {
+        for(size_t i = 0; i < action_names.size(); ++i)
+            if(action_names[i] == action) return uint8_t(i);
+        action_names.push_back(action);
+        return uint8_t(action_names.size() - 1);
+    }
+
     int rows;
     int cols;
-    int cursor[2];
-    std::unordered_map<std::string,std::string> keymap;
-    mutable std::mutex mtx;
-}; 
\ No newline at end of file
+    std::atomic<uint32_t> cursor{0};
+    std::array<Binding, 256> table{};
+    std::vector<std::string> action_names;
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "cursor reads must not lock");
+};
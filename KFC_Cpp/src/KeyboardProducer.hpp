@@ -1,7 +1,12 @@
 #pragma once
 
 #include "KeyboardProcessor.hpp"
+#include "KeyCodes.hpp"
 #include "Command.hpp"
+#include "Log.hpp"
+#include "Tracer.hpp"
+#include "Clock.hpp"
+#include "InputDispatcher.hpp"
 #include <thread>
 #include <vector>
 #include <memory>
@@ -12,92 +17,108 @@
 #include <mutex>
 #include <queue>
 #include <utility> // בשביל std::pair
-#include <opencv2/opencv.hpp>
-#include "Game.hpp"
-#include "Piece.hpp"
+#include "PieceIndex.hpp"
 
-typedef std::shared_ptr<Piece> PiecePtr;
-
-class KeyboardProducer
+class KeyboardProducer : public KeySink
 {
 private:
     std::vector<Command> &user_input_queue; // reference לתור הפקודות של המשחק
     std::mutex &input_mutex;                // reference למutex של המשחק
     KeyboardProcessor &processor;           // reference לprocessor
     int player;                             // מספר השחקן (1 או 2)
-    std::string selected_id;                // ID של הכלי הנבחר
-    std::pair<int, int> selected_cell;      // התא שנבחר
-    std::thread worker_thread;              // thread עבור keyboard polling
-    std::atomic<bool> running;              // האם הthread רץ
-
-    // משתנים עבור דמוי keyboard events (לטסטים)
-    std::queue<std::string> simulated_keys;
+    // Keys reach a producer from the dispatcher thread, the input pump and
+    // the game thread, and snapshots read the selection on the game thread
+    mutable std::mutex selection_mutex;
+    std::string selected_id;                // ID של הכלי הנבחר (selection_mutex)
+    std::pair<int, int> selected_cell;      // התא שנבחר (selection_mutex)
+    std::atomic<uint32_t> display_selection{kNoSelection}; // selected_cell for the renderer
+    InputDispatcher &dispatcher;            // shared input thread
+    bool running;                           // attached to the dispatcher (guarded by sim_mutex)
+
+    // Keys simulated before start(), with their capture stamps (לטסטים)
+    std::queue<std::pair<std::string, uint64_t>> simulated_keys;
     std::mutex sim_mutex;
 
     // שיתוף בין ה-producers
     std::shared_ptr<KeyboardProducer> other_player_producer;
 
-    // reference לרשימת הכלים
-    std::vector<PiecePtr> *pieces_ref;
+    // מיקומי הכלים, as the game thread last published them
+    const PieceIndex *piece_index;
+
+    // Game start; command timestamps are milliseconds since it
+    GameClock::time_point time_origin{default_time_origin()};
+    // Capture stamp of the key being handled (GameClock ns)
+    uint64_t key_captured_ns{0};
+    // Game time of the key being fed by an InputSource; -1 = use the clock
+    int virtual_now_ms{-1};
 
 public:
     // Constructor שמתאים למה שמשתמש במחלקת Game
     KeyboardProducer(std::vector<Command> &queue, std::mutex &mutex,
-                     KeyboardProcessor &proc, int player_num)
+                     KeyboardProcessor &proc, int player_num,
+                     InputDispatcher &dispatcher = InputDispatcher::shared())
         : user_input_queue(queue), input_mutex(mutex), processor(proc),
-          player(player_num), selected_id(""), selected_cell{-1, -1}, running(false), pieces_ref(nullptr) {}
+          player(player_num), selected_id(""), selected_cell{-1, -1}, dispatcher(dispatcher),
+          running(false), piece_index(nullptr) {}
 
-    ~KeyboardProducer()
+    ~KeyboardProducer() override
     {
         stop();
     }
 
+    // Receive simulated keys on the dispatcher thread; keys simulated
+    // before this are delivered now, in order.
     void start()
     {
-        if (!running.load())
+        std::lock_guard<std::mutex> lock(sim_mutex);
+        if (running)
+            return;
+        dispatcher.attach(this);
+        running = true;
+        KFC_LOG("[DEBUG] KeyboardProducer Player " << player << " started!");
+        while (!simulated_keys.empty())
         {
-            running = true;
-            worker_thread = std::thread(&KeyboardProducer::run, this);
+            auto &key = simulated_keys.front();
+            dispatcher.post(this, std::move(key.first), key.second);
+            simulated_keys.pop();
         }
     }
 
+    // Keys still queued are dropped; returns after a key being handled
     void stop()
     {
-        running = false;
-        if (worker_thread.joinable())
         {
-            worker_thread.join();
+            std::lock_guard<std::mutex> lock(sim_mutex);
+            if (!running)
+                return;
+            running = false;
         }
+        dispatcher.detach(this);
+        KFC_LOG("[DEBUG] KeyboardProducer Player " << player << " stopped!");
+    }
+
+    // KeySink: a simulated key, on the dispatcher thread
+    void on_key(const std::string &key, uint64_t captured_ns) override
+    {
+        TraceScope scope("input", "key");
+        handle_key_event_internal(key, captured_ns);
     }
 
     // פונקציה ציבורית לטיפול באירוע מקלדת - תוכל לקרוא לה מבחוץ
     void handle_key_event(const std::string &key)
     {
-        std::string action = processor.process_key(key);
-
-        // רק select ו-jump מעניינים אותנו כאן
-        if (action != "select" && action != "jump")
-        {
-            return;
-        }
-
-        auto cell = processor.get_cursor();
-
-        if (action == "select")
-        {
-            handle_select_action(cell);
-        }
-        else if (action == "jump")
-        {
-            handle_jump_action(cell);
-        }
+        handle_key_code(key_code_from_name(key));
     }
 
-    // פונקציה לדמוי מקשים (לטסטים)
+    // פונקציה לדמוי מקשים (לטסטים) – handled on the dispatcher thread
+    // right away once started, queued until start() otherwise
     void simulate_key(const std::string &key)
     {
         std::lock_guard<std::mutex> lock(sim_mutex);
-        simulated_keys.push(key);
+        if (running)
+            dispatcher.post(this, key, clock_now_ns());
+        else
+            simulated_keys.emplace(key, clock_now_ns());
     }
 
     // פונקציה להגדרת השחקן השני
@@ -106,170 +127,164 @@ public:
         this->other_player_producer = other;
     }
 
-    // פונקציה להגדרת reference לרשימת הכלים
-    void set_pieces_reference(std::vector<PiecePtr> *pieces)
+    // Share the game's clock origin so commands carry game time
+    void set_time_origin(GameClock::time_point origin) { time_origin = origin; }
+    // Stamp commands with this game time instead of the clock (-1 undoes
+    // it).  For keys fed in virtual time on the game thread.
+    void set_virtual_time(int now_ms) { virtual_now_ms = now_ms; }
+
+    // A key for either player: whichever keymap binds it handles it
+    void route_key(KeyCode code, uint64_t captured_ns = 0)
     {
-        this->pieces_ref = pieces;
+        distribute_key_to_players(code, captured_ns);
     }
 
-    // פונקציה ציבורית לטיפול במקשים
-    void handle_key_event_internal(const std::string &key)
+    // Where selections look pieces up; never Game::pieces, which the game
+    // thread changes while keys are handled
+    void set_piece_index(const PieceIndex *index)
     {
-        std::cout << "[DEBUG] Player " << player << " processing key: " << key << std::endl;
-        std::string action = processor.process_key(key);
-        std::cout << "[DEBUG] Player " << player << " action: " << action << std::endl;
+        this->piece_index = index;
+    }
 
-        auto cell = processor.get_cursor();
+    // Current selection (empty id = nothing selected) – used by snapshots
+    std::pair<std::string, std::pair<int, int>> get_selection() const
+    {
+        std::lock_guard<std::mutex> lock(selection_mutex);
+        return {selected_id, selected_cell};
+    }
+    std::string get_selected_id() const { return get_selection().first; }
+    std::pair<int, int> get_selected_cell() const { return get_selection().second; }
+    void set_selection(const std::string &id, const std::pair<int, int> &cell)
+    {
+        std::lock_guard<std::mutex> lock(selection_mutex);
+        selected_id = id;
+        set_selected_cell(cell);
+    }
+    // The selected cell, {-1,-1} for none; safe from any thread
+    std::pair<int, int> get_display_selection() const
+    {
+        uint32_t v = display_selection.load(std::memory_order_acquire);
+        if (v == kNoSelection)
+            return {-1, -1};
+        return {static_cast<int>(v >> 16), static_cast<int>(v & 0xffff)};
+    }
+
+    // פונקציה ציבורית לטיפול במקשים.  captured_ns: when the key was read
+    // (GameClock ns); 0 stamps it now.
+    void handle_key_event_internal(const std::string &key, uint64_t captured_ns = 0)
+    {
+        KFC_LOG("[DEBUG] Player " << player << " processing key: " << key);
+        handle_key_code(key_code_from_name(key), captured_ns);
+    }
 
-        if (action != "select" && action != "jump")
+    // One key for this player: a table lookup, and a command for select/jump
+    void handle_key_code(KeyCode code, uint64_t captured_ns = 0)
+    {
+        key_captured_ns = captured_ns ? captured_ns : clock_now_ns();
+        KeyAction action = processor.process_code(code);
+        if (action != KeyAction::Select && action != KeyAction::Jump)
         {
-            if (action == "up" || action == "down" || action == "left" || action == "right")
+            if (action != KeyAction::None && action != KeyAction::Other && log_enabled())
             {
-                std::cout << "[DEBUG] Player " << player << " cursor moved to: (" << cell.first << "," << cell.second << ")" << std::endl;
+                auto cell = processor.get_cursor();
+                KFC_LOG("[DEBUG] Player " << player << " cursor moved to: (" << cell.first << "," << cell.second << ")");
             }
             return;
         }
-        std::cout << "[DEBUG] Player " << player << " cursor at: (" << cell.first << "," << cell.second << ")" << std::endl;
+        auto cell = processor.get_cursor();
+        KFC_LOG("[DEBUG] Player " << player << " cursor at: (" << cell.first << "," << cell.second << ")");
 
-        if (action == "select")
+        std::lock_guard<std::mutex> lock(selection_mutex); // before input_mutex
+        if (action == KeyAction::Select)
         {
             handle_select_action(cell);
         }
-        else if (action == "jump")
+        else
         {
             handle_jump_action(cell);
         }
     }
 
-    // פונקציה לטיפול במקשים מ-OpenCV
-    void handle_opencv_key(int key)
+    // פונקציה לטיפול במקשים מ-OpenCV.  captured_ns: when the key was read;
+    // 0 stamps it now.
+    void handle_opencv_key(int key, uint64_t captured_ns = 0)
     {
-        std::string key_str = convert_opencv_key_to_string(key);
-        if (!key_str.empty())
+        if (!captured_ns)
+            captured_ns = clock_now_ns();
+        TraceScope scope("input", "opencv_key");
+        KeyCode code = key_code_from_raw(key);
+        if (code == key_code::None)
         {
-            std::cout << "[DEBUG] OpenCV key converted: " << key_str << std::endl;
-            distribute_key_to_players(key_str);
+            if (key != 255)
+            {
+                KFC_LOG("[DEBUG] Unknown key code: " << key);
+            }
+            return;
         }
+        distribute_key_to_players(code, captured_ns);
     }
 
 private:
-    void run()
-    {
-        std::cout << "[DEBUG] KeyboardProducer Player " << player << " started!" << std::endl;
-        while (running.load())
-        {
-            // בדוק אם יש מקשים מדומים
-            process_simulated_keys();
+    static constexpr uint32_t kNoSelection = 0xffffffffu;
 
-            // המקשים מגיעים מ-OpenCV דרך handle_opencv_key
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-        std::cout << "[DEBUG] KeyboardProducer Player " << player << " stopped!" << std::endl;
-    }
-
-    void process_simulated_keys()
+    // Called with selection_mutex held
+    void set_selected_cell(const std::pair<int, int> &cell)
     {
-        std::lock_guard<std::mutex> lock(sim_mutex);
-        while (!simulated_keys.empty())
-        {
-            std::string key = simulated_keys.front();
-            simulated_keys.pop();
-            // עבד את המקש ללא נעילה (כי כבר יש לנו נעילה)
-            handle_key_event_internal(key);
-        }
+        selected_cell = cell;
+        display_selection.store(cell.first < 0 ? kNoSelection
+                                               : (uint32_t(cell.first) << 16) | uint32_t(cell.second & 0xffff),
+                                std::memory_order_release);
     }
 
-    PiecePtr find_piece_at(const std::pair<int, int> &cell)
+    // Roster slot of this player's piece at cell, or PieceIndex::kNone
+    int find_piece_at(const std::pair<int, int> &cell) const
     {
-        if (!pieces_ref)
-            return nullptr;
-
-        // הקורסור נותן (row,col) והכלים עכשיו גם שמורים ב-(row,col)
-        std::pair<int, int> piece_coords = cell;
-
-        std::cout << "[DEBUG] Looking for piece at cursor (" << cell.first << "," << cell.second << ") -> piece coords (" << piece_coords.first << "," << piece_coords.second << ")" << std::endl;
-
-        for (const auto &piece : *pieces_ref)
-        {
-            auto current = piece->current_cell();
-            std::cout << "[DEBUG] Checking piece " << piece->id << " at (" << current.first << "," << current.second << ")" << std::endl;
-            if (current == piece_coords)
-            {
-                if (is_piece_owned_by_player(piece, player))
-                {
-                    return piece;
-                }
-            }
-        }
-        return nullptr;
+        if (!piece_index)
+            return PieceIndex::kNone;
+        PieceIndex::Reader snap(*piece_index);
+        return snap->piece_at(cell, player_color());
     }
 
-    bool is_piece_owned_by_player(const PiecePtr &piece, int player_num)
-    {
-        if (piece->id.length() < 2)
-            return false;
-
-        char color = piece->id[1];
-        if (player_num == 1 && color == 'W')
-            return true;
-        if (player_num == 2 && color == 'B')
-            return true;
-
-        return false;
-    }
+    char player_color() const { return player == 1 ? 'W' : 'B'; }
 
     void handle_select_action(const std::pair<int, int> &cell)
     {
         if (selected_id.empty())
         {
             // לחיצה ראשונה - נסה לבחור כלי
-            std::cout << "[DEBUG] Looking for piece to select at (" << cell.first << "," << cell.second << ")" << std::endl;
-
-            // הדפס את כל הכלים בתא הזה
-            if (pieces_ref)
-            {
-                std::pair<int, int> piece_coords = {cell.second, cell.first};
-                for (const auto &piece : *pieces_ref)
-                {
-                    if (piece->current_cell() == piece_coords)
-                    {
-                        std::cout << "[DEBUG] Found piece " << piece->id << " at this cell, belongs to player: " << (is_piece_owned_by_player(piece, player) ? "YES" : "NO") << std::endl;
-                    }
-                }
-            }
+            KFC_LOG("[DEBUG] Looking for piece to select at (" << cell.first << "," << cell.second << ")");
 
-            PiecePtr piece = find_piece_at(cell);
-            if (!piece)
+            int slot = find_piece_at(cell);
+            if (slot == PieceIndex::kNone)
             {
-                std::cout << "[WARN] Player " << player << " - No piece at ("
-                          << cell.first << "," << cell.second << ")" << std::endl;
+                KFC_LOG("[WARN] Player " << player << " - No piece at ("
+                          << cell.first << "," << cell.second << ")");
                 return;
             }
 
-            selected_id = piece->id;
-            selected_cell = cell;
+            selected_id = piece_index->id_of(slot);
+            set_selected_cell(cell);
 
-            std::cout << "[KEY] Player " << player << " selected " << piece->id << " at ("
-                      << cell.first << "," << cell.second << ")" << std::endl;
+            KFC_LOG("[KEY] Player " << player << " selected " << selected_id << " at ("
+                      << cell.first << "," << cell.second << ")");
         }
         else if (cell == selected_cell)
         {
             // לחיצה על אותו תא - בטל בחירה
-            std::cout << "[KEY] Player " << player << " deselected piece" << std::endl;
+            KFC_LOG("[KEY] Player " << player << " deselected piece");
             selected_id = "";
-            selected_cell = {-1, -1};
+            set_selected_cell({-1, -1});
         }
         else
         {
             // לחיצה על תא אחר - צור פקודת מהלך
-            std::cout << "[KEY] Player " << player << " moving " << selected_id << " from ("
+            KFC_LOG("[KEY] Player " << player << " moving " << selected_id << " from ("
                       << selected_cell.first << "," << selected_cell.second << ") to ("
-                      << cell.first << "," << cell.second << ")" << std::endl;
+                      << cell.first << "," << cell.second << ")");
             create_move_command(selected_cell, cell);
 
             selected_id = "";
-            selected_cell = {-1, -1};
+            set_selected_cell({-1, -1});
         }
     }
 
@@ -281,26 +296,23 @@ private:
             create_jump_command(selected_cell, cell);
 
             selected_id = "";
-            selected_cell = {-1, -1};
+            set_selected_cell({-1, -1});
         }
     }
 
     void create_move_command(const std::pair<int, int> &from, const std::pair<int, int> &to)
     {
         // הכלי נמצא בקורדינטות אמיתיות - נשתמש בהן
-        PiecePtr piece = nullptr;
-        for (const auto &p : *pieces_ref)
+        if (!piece_index)
+            return;
+        std::pair<int, int> piece_pos;
         {
-            if (p->id == selected_id)
-            {
-                piece = p;
-                break;
-            }
+            PieceIndex::Reader snap(*piece_index);
+            piece_pos = snap->cell_of(piece_index->slot_of(selected_id));
         }
-        if (!piece)
-            return;
+        if (piece_pos.first < 0)
+            return; // captured meanwhile
 
-        auto piece_pos = piece->current_cell();
         std::pair<int, int> from_coords = piece_pos;
         std::pair<int, int> to_coords = to;
 
@@ -310,13 +322,15 @@ private:
             selected_id,
             "move",
             move_params};
+        cmd.captured_ns = key_captured_ns;
 
         {
             std::lock_guard<std::mutex> guard(input_mutex);
+            cmd.queued_ns = clock_now_ns();
             user_input_queue.push_back(cmd);
         }
 
-        std::cout << "[INFO] Player " << player << " queued: " << cmd << std::endl;
+        KFC_LOG("[INFO] Player " << player << " queued: " << cmd);
     }
 
     void create_jump_command(const std::pair<int, int> &from, const std::pair<int, int> &to)
@@ -327,103 +341,44 @@ private:
             selected_id,
             "jump",
             jump_params};
+        cmd.captured_ns = key_captured_ns;
 
         {
             std::lock_guard<std::mutex> guard(input_mutex);
+            cmd.queued_ns = clock_now_ns();
             user_input_queue.push_back(cmd);
         }
 
-        std::cout << "[INFO] Player " << player << " queued jump: " << cmd << std::endl;
+        KFC_LOG("[INFO] Player " << player << " queued jump: " << cmd);
     }
 
-    std::string convert_opencv_key_to_string(int key)
+    // Game time, once set_time_origin was called
+    int get_current_time_ms() const
     {
-        // הדפס את הערך לדיבוג
-        if (key != 255)
-        {
-            std::cout << "[DEBUG] Key pressed: " << key << std::endl;
-        }
-
-        switch (key)
-        {
-        case 27:
-            return "esc";
-        case 13:
-            return "enter";
-        case 32:
-            return " ";
-        case 43:
-            return "+";
-        case 45:
-            return "-";
-        // מקשי חצים מורחבים (1000 + קוד המקש)
-        case 1072:
-            return "up"; // 1000 + 72 = חץ עליון
-        case 1080:
-            return "down"; // 1000 + 80 = חץ תחתון
-        case 1075:
-            return "left"; // 1000 + 75 = חץ שמאל
-        case 1077:
-            return "right"; // 1000 + 77 = חץ ימין
-        case 0:
-            return "unknown_arrow"; // מקש חץ לא מזוהה
-
-        case 249:
-            return "a"; // ראינו 249 בפלט
-        case 227:
-            return "s"; // ראינו 227 בפלט
-        case 226:
-            return "d"; // ראינו 226 בפלט
-        case 39:
-            return "w"; // ראינו 39 בפלט
-        case 235:
-            return "f"; // ראינו 235 בפלט
-        // אותיות רגילות
-        default:
-            if (key >= 'a' && key <= 'z')
-            {
-                return std::string(1, (char)key);
-            }
-            if (key >= 'A' && key <= 'Z')
-            {
-                return std::string(1, (char)(key + 32)); // המרה לאות קטנה
-            }
-            // הדפס מקשים לא מוכרים
-            std::cout << "[DEBUG] Unknown key code: " << key << std::endl;
-            return "";
-        }
+        return virtual_now_ms >= 0 ? virtual_now_ms : clock_ms_since(time_origin);
     }
 
-    int get_current_time_ms()
+    // Shared by producers that were never given the game's origin
+    static GameClock::time_point default_time_origin()
     {
-        static auto start_time = std::chrono::steady_clock::now();
-        auto now = std::chrono::steady_clock::now();
-        auto duration = now - start_time;
-        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+        static const auto start_time = GameClock::now();
+        return start_time;
     }
 
-    void distribute_key_to_players(const std::string &key)
+    // The player whose keymap binds the key gets it (player 1 first)
+    void distribute_key_to_players(KeyCode code, uint64_t captured_ns)
     {
-        // בדוק אילו מקשים שייכים לשחקן 1
-        if (key == "up" || key == "down" || key == "left" || key == "right" ||
-            key == "enter" || key == "+")
+        if (processor.binds(code))
         {
-            std::cout << "[DEBUG] Key '" << key << "' for Player 1" << std::endl;
-            handle_key_event_internal(key);
+            handle_key_code(code, captured_ns);
         }
-        // בדוק אילו מקשים שייכים לשחקן 2
-        else if (key == "w" || key == "s" || key == "a" || key == "d" ||
-                 key == "f" || key == "g")
+        else if (other_player_producer && other_player_producer->processor.binds(code))
         {
-            std::cout << "[DEBUG] Key '" << key << "' for Player 2" << std::endl;
-            if (other_player_producer)
-            {
-                other_player_producer->handle_key_event_internal(key);
-            }
+            other_player_producer->handle_key_code(code, captured_ns);
         }
         else
         {
-            std::cout << "[DEBUG] Unknown key: " << key << std::endl;
+            KFC_LOG("[DEBUG] Unknown key: " << key_name(code));
         }
     }
 };
\ No newline at end of file
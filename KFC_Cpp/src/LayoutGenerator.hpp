@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Generated board.csv layouts, for boards larger than the classic one and
+// for stress runs.
+//
+// rows x cols cells with `pieces` of them taken: one king of each colour in
+// the middle of the back rows, the rest pawns, knights, bishops, rooks and
+// queens (8:2:2:2:1, as in a chess army) on random cells.  White holds the
+// lower half of the board and black the upper one, so pawns face each
+// other as they do in board.csv.  The same arguments give the same layout
+// everywhere (mt19937 is fully specified; no std distributions).
+// ---------------------------------------------------------------------------
+inline std::string generate_layout(int rows, int cols, int pieces, uint32_t seed = 1)
+{
+    if (rows < 2 || cols < 1 || rows > 4096 || cols > 4096)
+        throw std::invalid_argument("Layout must be 2x1 to 4096x4096 cells");
+    const int cells = rows * cols;
+    if (pieces < 2 || pieces > cells)
+        throw std::invalid_argument("Layout needs 2 to " + std::to_string(cells) + " pieces");
+
+    std::vector<std::string> grid(static_cast<size_t>(cells));
+    const int kw = (rows - 1) * cols + cols / 2, kb = cols / 2;
+    grid[static_cast<size_t>(kw)] = "KW";
+    grid[static_cast<size_t>(kb)] = "KB";
+
+    // The other cells in random order (partial Fisher-Yates): the first
+    // pieces - 2 of them get a piece
+    std::vector<int> free_cells;
+    free_cells.reserve(static_cast<size_t>(cells));
+    for (int i = 0; i < cells; ++i)
+        if (i != kw && i != kb)
+            free_cells.push_back(i);
+    std::mt19937 rng(seed);
+    static const char kArmy[] = "PPPPPPPPNNBBRRQ";
+    for (int n = 0; n < pieces - 2; ++n)
+    {
+        size_t pick = n + rng() % (free_cells.size() - n);
+        std::swap(free_cells[static_cast<size_t>(n)], free_cells[pick]);
+        int cell = free_cells[static_cast<size_t>(n)];
+        char color = cell / cols >= rows / 2 ? 'W' : 'B';
+        grid[static_cast<size_t>(cell)] = std::string{kArmy[rng() % (sizeof kArmy - 1)], color};
+    }
+
+    std::string csv;
+    csv.reserve(static_cast<size_t>(cells) * 2);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            if (c)
+                csv += ',';
+            csv += grid[static_cast<size_t>(r * cols + c)];
+        }
+        csv += '\n';
+    }
+    return csv;
+}
+
+// "ROWSxCOLS:PIECES[:SEED]", e.g. "128x128:4000" (command lines, benches)
+struct LayoutSpec
+{
+    int rows{8};
+    int cols{8};
+    int pieces{32};
+    uint32_t seed{1};
+
+    static LayoutSpec parse(const std::string &text)
+    {
+        LayoutSpec spec;
+        unsigned long seed = 1;
+        char x = 0, colon = 0, colon2 = 0;
+        int used = 0, used_seed = 0;
+        int n = std::sscanf(text.c_str(), "%d%c%d%c%d%n%c%lu%n", &spec.rows, &x, &spec.cols, &colon, &spec.pieces,
+                            &used, &colon2, &seed, &used_seed);
+        if (n < 5 || x != 'x' || colon != ':' || (n == 5 && static_cast<size_t>(used) != text.size()) ||
+            (n > 5 && (colon2 != ':' || n != 7 || static_cast<size_t>(used_seed) != text.size())))
+            throw std::invalid_argument("Layout spec must look like 64x64:2000[:seed], not " + text);
+        spec.seed = static_cast<uint32_t>(seed);
+        return spec;
+    }
+    std::string csv() const { return generate_layout(rows, cols, pieces, seed); }
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+
+// ---------------------------------------------------------------------------
+// Debug trace switch.  All engine chatter goes through KFC_LOG so that tools
+// which run the simulation at full speed (journal replay, servers, benches)
+// can silence it – console I/O would otherwise dominate their run time.
+// ---------------------------------------------------------------------------
+inline std::atomic<bool> g_log_enabled{true};
+
+inline bool log_enabled() { return g_log_enabled.load(std::memory_order_relaxed); }
+inline void set_log_enabled(bool enabled) { g_log_enabled.store(enabled, std::memory_order_relaxed); }
+
+#define KFC_LOG(expr)                          \
+    do                                         \
+    {                                          \
+        if (log_enabled())                     \
+            std::cout << expr << std::endl;    \
+    } while (0)
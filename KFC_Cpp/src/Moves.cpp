@@ -1,9 +1,12 @@
 #include "Moves.hpp"
+#include "Log.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <cmath>
 #include <iostream>
+#include <stdexcept>
 
 // ---------------------------------------------------------------------------
 Moves::Moves(const std::string& txt_path, std::pair<int,int> board_dims)
@@ -15,18 +18,29 @@ Moves::Moves(const std::string& txt_path, std::pair<int,int> board_dims)
         return;
     }
 
+    // No ray is longer than the board
+    int board_span = std::max(1, std::max(W, H) - 1);
     std::string line;
     while(std::getline(in, line)) {
+        line = line.substr(0, line.find('#')); // comment
         // Trim leading/trailing whitespace
         auto start = line.find_first_not_of(" \t\r\n");
         if(start == std::string::npos) continue; // empty line
-        if(line.substr(start,1) == "#") continue; // comment
-        rel_moves.push_back(parse_line(line));
+        int max_steps = -1;
+        RelMove mv = parse_line(line, max_steps);
+        if(max_steps < 0) {
+            rel_moves.push_back(mv);
+            continue;
+        }
+        if(mv.dr == 0 && mv.dc == 0)
+            throw std::runtime_error("Ray without a direction in " + txt_path + ": " + line);
+        int limit = max_steps == 0 ? board_span : std::min(max_steps, board_span);
+        ray_table.push_back({mv.dr, mv.dc, limit, mv.tag});
     }
 }
 
 // ---------------------------------------------------------------------------
-Moves::RelMove Moves::parse_line(const std::string& s) {
+Moves::RelMove Moves::parse_line(const std::string& s, int& max_steps) {
     auto pos = s.find(':');
     std::string coords = s.substr(0, pos);
     std::string tag_str = s.substr(pos + 1);
@@ -47,6 +61,12 @@ Moves::RelMove Moves::parse_line(const std::string& s) {
     char comma;
     std::stringstream ss(coords);
     ss >> dr >> comma >> dc;
+    // "*" or "*N" after the offset makes it a ray
+    char star;
+    if(ss >> star && star == '*') {
+        int n;
+        max_steps = (ss >> n) ? std::max(1, n) : 0;
+    }
 
     int tag;
     // trim tag_str
@@ -63,62 +83,139 @@ Moves::RelMove Moves::parse_line(const std::string& s) {
 }
 
 // ---------------------------------------------------------------------------
+bool Moves::tag_allows(int tag, bool dst_has_piece) {
+    if(tag == -1) return true;
+    if(tag == 0)  return !dst_has_piece;
+    if(tag == 1)  return dst_has_piece;
+    return false;
+}
+
+const Moves::Ray* Moves::find_ray(int dr, int dc, int& steps) const {
+    for(const auto& ray : ray_table) {
+        // (dr,dc) must be k*(ray.dr,ray.dc) with 1 <= k <= max_steps
+        int k;
+        if(ray.dr != 0) {
+            if(dr % ray.dr != 0) continue;
+            k = dr / ray.dr;
+            if(dc != k * ray.dc) continue;
+        } else {
+            if(dr != 0 || dc % ray.dc != 0) continue;
+            k = dc / ray.dc;
+        }
+        if(k < 1 || k > ray.max_steps) continue;
+        steps = k;
+        return &ray;
+    }
+    return nullptr;
+}
+
 bool Moves::is_dst_cell_valid(int dr, int dc, bool dst_has_piece) const {
-    std::cout << "[MOVES] Looking for move (" << dr << "," << dc << ") in " << rel_moves.size() << " available moves:" << std::endl;
+    KFC_LOG("[MOVES] Looking for move (" << dr << "," << dc << ") in " << rel_moves.size() << " offsets and "
+            << ray_table.size() << " rays");
+    // A listed offset wins over a ray through the same cell
     for(const auto& mv : rel_moves) {
-        std::cout << "[MOVES]   Available: (" << mv.dr << "," << mv.dc << ") tag=" << mv.tag << std::endl;
         if(mv.dr == dr && mv.dc == dc) {
-            std::cout << "[MOVES]   FOUND MATCH! tag=" << mv.tag << ", dst_has_piece=" << dst_has_piece << std::endl;
-            if(mv.tag == -1) return true;
-            if(mv.tag == 0)  return !dst_has_piece;
-            if(mv.tag == 1)  return dst_has_piece;
-            return false;
+            KFC_LOG("[MOVES]   FOUND MATCH! tag=" << mv.tag << ", dst_has_piece=" << dst_has_piece);
+            return tag_allows(mv.tag, dst_has_piece);
         }
     }
-    std::cout << "[MOVES] Move not found in available moves!" << std::endl;
+    int steps = 0;
+    if(const Ray* ray = find_ray(dr, dc, steps)) {
+        KFC_LOG("[MOVES]   On ray (" << ray->dr << "," << ray->dc << ") at step " << steps << " tag=" << ray->tag);
+        return tag_allows(ray->tag, dst_has_piece);
+    }
+    KFC_LOG("[MOVES] Move not found in available moves!");
     return false; // not found
 }
 
-bool Moves::is_valid(const std::pair<int,int>& src_cell,
-                     const std::pair<int,int>& dst_cell,
-                     const std::unordered_set<std::pair<int,int>, PairHash>& cell_with_piece,
-                     bool need_clear_path) const {
+namespace {
+// a / b rounded half away from zero, b > 0 (what std::round does)
+int round_div(int a, int b) {
+    return a >= 0 ? (2 * a + b) / (2 * b) : -((-2 * a + b) / (2 * b));
+}
+}
+
+template <class Occupied>
+bool Moves::clear_path(const std::pair<int,int>& src_cell,
+                       const std::pair<int,int>& dst_cell,
+                       const Occupied& occupied) const {
+    int dr = dst_cell.first - src_cell.first;
+    int dc = dst_cell.second - src_cell.second;
+    // Along a ray: every landing cell before dst, stopping at the first
+    // occupied one
+    int ray_steps = 0;
+    if(const Ray* ray = find_ray(dr, dc, ray_steps)) {
+        int r = src_cell.first, c = src_cell.second;
+        for(int i = 1; i < ray_steps; ++i) {
+            r += ray->dr;
+            c += ray->dc;
+            if(occupied(std::make_pair(r, c))) return false;
+        }
+        return true;
+    }
+    // A single offset: the cells on the straight line to it
+    if(std::abs(dr) <= 1 && std::abs(dc) <= 1) return true;
+    int steps = std::max(std::abs(dr), std::abs(dc));
+    for(int i=1; i<steps; ++i) {
+        int r = src_cell.first + round_div(i * dr, steps);
+        int c = src_cell.second + round_div(i * dc, steps);
+        if(occupied(std::make_pair(r, c))) return false;
+    }
+    return true;
+}
+
+template <class Occupied>
+bool Moves::valid_move(const std::pair<int,int>& src_cell,
+                       const std::pair<int,int>& dst_cell,
+                       const Occupied& occupied,
+                       bool need_clear_path) const {
+    // board bounds
+    if(dst_cell.first < 0 || dst_cell.first >= H || dst_cell.second < 0 || dst_cell.second >= W) {
+        KFC_LOG("[MOVES] Move failed: out of bounds");
+        return false;
+    }
     int dr = dst_cell.first - src_cell.first;
     int dc = dst_cell.second - src_cell.second;
-    bool dst_has_piece = cell_with_piece.count(dst_cell) > 0;
+    bool dst_has_piece = occupied(dst_cell);
     
-    std::cout << "[MOVES] Checking move delta: (" << dr << "," << dc << "), dst_has_piece: " << dst_has_piece << std::endl;
+    KFC_LOG("[MOVES] Checking move delta: (" << dr << "," << dc << "), dst_has_piece: " << dst_has_piece);
     
     if(!is_dst_cell_valid(dr, dc, dst_has_piece)) {
-        std::cout << "[MOVES] Move failed: dst_cell_valid check" << std::endl;
+        KFC_LOG("[MOVES] Move failed: dst_cell_valid check");
         return false;
     }
-    if(need_clear_path && !path_is_clear(src_cell, dst_cell, cell_with_piece)) {
-        std::cout << "[MOVES] Move failed: path not clear" << std::endl;
-        return false;
-    }
-    // board bounds
-    if(dst_cell.first < 0 || dst_cell.first >= H || dst_cell.second < 0 || dst_cell.second >= W) {
-        std::cout << "[MOVES] Move failed: out of bounds" << std::endl;
+    if(need_clear_path && !clear_path(src_cell, dst_cell, occupied)) {
+        KFC_LOG("[MOVES] Move failed: path not clear");
         return false;
     }
-    std::cout << "[MOVES] Move is VALID!" << std::endl;
+    KFC_LOG("[MOVES] Move is VALID!");
     return true;
 }
 
+bool Moves::is_valid(const std::pair<int,int>& src_cell,
+                     const std::pair<int,int>& dst_cell,
+                     const std::unordered_set<std::pair<int,int>, PairHash>& cell_with_piece,
+                     bool need_clear_path) const {
+    return valid_move(src_cell, dst_cell,
+                      [&](const std::pair<int,int>& cell) { return cell_with_piece.count(cell) > 0; },
+                      need_clear_path);
+}
+
+bool Moves::is_valid(const std::pair<int,int>& src_cell,
+                     const std::pair<int,int>& dst_cell,
+                     const Cell2Pieces& cell_pieces,
+                     bool need_clear_path) const {
+    return valid_move(src_cell, dst_cell,
+                      [&](const std::pair<int,int>& cell) {
+                          auto it = cell_pieces.find(cell);
+                          return it != cell_pieces.end() && !it->second.empty();
+                      },
+                      need_clear_path);
+}
+
 bool Moves::path_is_clear(const std::pair<int,int>& src_cell,
                           const std::pair<int,int>& dst_cell,
                           const std::unordered_set<std::pair<int,int>, PairHash>& cell_with_piece) const {
-    int dr = dst_cell.first - src_cell.first;
-    int dc = dst_cell.second - src_cell.second;
-    if(std::abs(dr) <= 1 && std::abs(dc) <= 1) return true;
-    int steps = std::max(std::abs(dr), std::abs(dc));
-    double step_r = static_cast<double>(dr) / steps;
-    double step_c = static_cast<double>(dc) / steps;
-    for(int i=1; i<steps; ++i) {
-        int r = src_cell.first + static_cast<int>(std::round(i * step_r));
-        int c = src_cell.second + static_cast<int>(std::round(i * step_c));
-        if(cell_with_piece.count({r,c})) return false;
-    }
-    return true;
-} 
\ No newline at end of file
+    return clear_path(src_cell, dst_cell,
+                      [&](const std::pair<int,int>& cell) { return cell_with_piece.count(cell) > 0; });
+}
@@ -6,6 +6,13 @@
 #include <utility>
 #include "Common.hpp"
 
+// moves.txt, one move per line ('#' starts a comment):
+//   dr,dc[:tag]      a single offset
+//   dr,dc*[:tag]     a ray: k*(dr,dc) for every k up to the board edge
+//   dr,dc*N[:tag]    a ray of at most N steps
+// where tag is capture, non_capture or empty (both).  Rays are compiled
+// into a table bounded by the board size, so one line covers any board
+// and checking a move costs the length of its ray.
 class Moves
 {
 public:
@@ -16,6 +23,14 @@ public:
         int dc;
         int tag;
     };
+    // Steps of (dr,dc), at most max_steps of them (always >= 1)
+    struct Ray
+    {
+        int dr;
+        int dc;
+        int max_steps;
+        int tag;
+    };
 
     Moves(const std::string &txt_path, std::pair<int, int> board_dims);
 
@@ -24,15 +39,36 @@ public:
                   const std::pair<int, int> &dst_cell,
                   const std::unordered_set<std::pair<int, int>, PairHash> &cell_with_piece,
                   bool need_clear_path = true) const;
+    // Same, reading occupancy straight from a cell map (a cell with an
+    // empty list is free), so a check costs the cells it looks at and not
+    // the size of the board
+    bool is_valid(const std::pair<int, int> &src_cell,
+                  const std::pair<int, int> &dst_cell,
+                  const Cell2Pieces &cell_pieces,
+                  bool need_clear_path = true) const;
+    // No occupied cell strictly between src and dst
+    bool path_is_clear(const std::pair<int, int> &src_cell,
+                       const std::pair<int, int> &dst_cell,
+                       const std::unordered_set<std::pair<int, int>, PairHash> &cell_with_piece) const;
+
+    const std::vector<RelMove> &offsets() const { return rel_moves; }
+    const std::vector<Ray> &rays() const { return ray_table; }
 
 private:
     std::vector<RelMove> rel_moves;
+    std::vector<Ray> ray_table;
     int W;
     int H;
 
-    static RelMove parse_line(const std::string &s);
-
-    bool path_is_clear(const std::pair<int, int> &src_cell,
-                       const std::pair<int, int> &dst_cell,
-                       const std::unordered_set<std::pair<int, int>, PairHash> &cell_with_piece) const;
+    template <class Occupied>
+    bool valid_move(const std::pair<int, int> &src_cell, const std::pair<int, int> &dst_cell,
+                    const Occupied &occupied, bool need_clear_path) const;
+    template <class Occupied>
+    bool clear_path(const std::pair<int, int> &src_cell, const std::pair<int, int> &dst_cell,
+                    const Occupied &occupied) const;
+    // The ray that reaches (dr,dc) and in how many steps, or nullptr
+    const Ray *find_ray(int dr, int dc, int &steps) const;
+    static bool tag_allows(int tag, bool dst_has_piece);
+    // max_steps < 0: not a ray; 0: unlimited
+    static RelMove parse_line(const std::string &s, int &max_steps);
 };
\ No newline at end of file
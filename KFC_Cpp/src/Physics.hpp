@@ -3,6 +3,8 @@
 #include "Common.hpp"
 #include "Board.hpp"
 #include "Command.hpp"
+#include "Serialization.hpp"
+#include "Log.hpp"
 #include <cmath>
 #include <memory>
 #include <iostream>
@@ -17,8 +19,10 @@ public:
     virtual ~BasePhysics() = default;
 
     virtual void reset(const Command &cmd) = 0;
-    // Update physics state. Return a Command if one is produced, otherwise nullptr
-    virtual std::shared_ptr<Command> update(int now_ms) = 0;
+    // Update physics state. Return a Command if one is produced, otherwise
+    // nullptr.  The command belongs to this physics object and stays valid
+    // until its next update() or its destruction; copy it to keep it longer.
+    virtual const Command *update(int now_ms) = 0;
 
     std::pair<double, double> get_pos_m() const { return curr_pos_m; }
     std::pair<int, int> get_pos_pix() const { return board.m_to_pix(curr_pos_m); }
@@ -28,12 +32,50 @@ public:
     }
 
     int get_start_ms() const { return start_ms; }
+    std::pair<int, int> get_start_cell() const { return start_cell; }
+    std::pair<int, int> get_end_cell() const { return end_cell; }
     bool is_need_clear_path() const { return need_clear_path; }
     void set_need_clear_path(bool value) { need_clear_path = value; }
 
     virtual bool can_be_captured() const { return true; }
     virtual bool can_capture() const { return true; }
     virtual bool is_movement_blocker() const { return false; }
+    // Idle physics never emits a command, whatever the clock says
+    virtual bool is_idle() const { return false; }
+
+    // Snapshot support: timing and position only, configuration is rebuilt
+    // from the piece assets.  A piece resting exactly on its start cell –
+    // the common case – does not spend 16 bytes on its metric position.
+    virtual void save_state(ByteWriter &w) const
+    {
+        bool on_start_cell = curr_pos_m == board.cell_to_m(start_cell);
+        w.u8(on_start_cell ? 1 : 0);
+        w.cell(start_cell);
+        w.cell(end_cell);
+        w.svarint(start_ms);
+        if (!on_start_cell)
+        {
+            w.f64(curr_pos_m.first);
+            w.f64(curr_pos_m.second);
+        }
+    }
+
+    virtual void load_state(ByteReader &r)
+    {
+        bool on_start_cell = r.u8() & 1;
+        start_cell = r.cell();
+        end_cell = r.cell();
+        start_ms = static_cast<int>(r.svarint());
+        if (on_start_cell)
+        {
+            curr_pos_m = board.cell_to_m(start_cell);
+        }
+        else
+        {
+            curr_pos_m.first = r.f64();
+            curr_pos_m.second = r.f64();
+        }
+    }
 
 protected:
     Board board;
@@ -44,6 +86,18 @@ protected:
     std::pair<int, int> end_cell;
     std::pair<double, double> curr_pos_m{0.f, 0.f};
     int start_ms{0};
+
+    // The "done" command returned by update().  It is a member reused on
+    // every call, so finishing a move or a rest does not allocate.
+    const Command *done_command(int now_ms)
+    {
+        done_cmd.timestamp = now_ms;
+        done_cmd.params.assign(1, end_cell);
+        return &done_cmd;
+    }
+
+private:
+    Command done_cmd{0, "", "done", {{0, 0}}};
 };
 
 // ---------------------------------------------------------------------------
@@ -53,29 +107,30 @@ public:
     using BasePhysics::BasePhysics;
     void reset(const Command &cmd) override
     {
-        std::cout << "[IDLE RESET] Command: " << cmd.type << " with " << cmd.params.size() << " params" << std::endl;
+        KFC_LOG("[IDLE RESET] Command: " << cmd.type << " with " << cmd.params.size() << " params");
         if (!cmd.params.empty())
         {
-            std::cout << "[IDLE RESET] Setting position to: (" << cmd.params[0].first << "," << cmd.params[0].second << ")" << std::endl;
+            KFC_LOG("[IDLE RESET] Setting position to: (" << cmd.params[0].first << "," << cmd.params[0].second << ")");
         }
 
         if (cmd.params.empty())
         {
-            std::cout << "[IDLE RESET] No params - keeping current position" << std::endl;
+            KFC_LOG("[IDLE RESET] No params - keeping current position");
             // השאר הכל כמו שהוא
         }
         else
         {
             start_cell = end_cell = cmd.params[0];
             curr_pos_m = board.cell_to_m(start_cell);
-            std::cout << "[IDLE RESET] New curr_pos_m: (" << curr_pos_m.first << "," << curr_pos_m.second << ")" << std::endl;
+            KFC_LOG("[IDLE RESET] New curr_pos_m: (" << curr_pos_m.first << "," << curr_pos_m.second << ")");
         }
         start_ms = cmd.timestamp;
     }
-    std::shared_ptr<Command> update(int) override { return nullptr; }
+    const Command *update(int) override { return nullptr; }
 
     bool can_capture() const override { return false; }
     bool is_movement_blocker() const override { return true; }
+    bool is_idle() const override { return true; }
 };
 
 // ---------------------------------------------------------------------------
@@ -87,17 +142,17 @@ public:
 
     void reset(const Command &cmd) override
     {
-        std::cout << "[MOVE RESET] Command: " << cmd.type << " with " << cmd.params.size() << " params" << std::endl;
+        KFC_LOG("[MOVE RESET] Command: " << cmd.type << " with " << cmd.params.size() << " params");
         if (cmd.params.size() >= 2)
         {
-            std::cout << "[MOVE RESET] From: (" << cmd.params[0].first << "," << cmd.params[0].second
-                      << ") To: (" << cmd.params[1].first << "," << cmd.params[1].second << ")" << std::endl;
+            KFC_LOG("[MOVE RESET] From: (" << cmd.params[0].first << "," << cmd.params[0].second
+                      << ") To: (" << cmd.params[1].first << "," << cmd.params[1].second << ")");
         }
 
         if (cmd.params.size() < 2)
         {
             start_cell = end_cell = {0, 0};
-            std::cout << "[MOVE RESET] ERROR: Not enough params, defaulting to (0,0)" << std::endl;
+            KFC_LOG("[MOVE RESET] ERROR: Not enough params, defaulting to (0,0)");
         }
         else
         {
@@ -115,17 +170,17 @@ public:
         duration_s = movement_len / speed_m_s;
     }
 
-    std::shared_ptr<Command> update(int now_ms) override
+    const Command *update(int now_ms) override
     {
         double seconds = (now_ms - start_ms) / 1000.0;
         if (seconds >= duration_s)
         {
             curr_pos_m = board.cell_to_m(end_cell);
             start_cell = end_cell;
-            std::cout << "[MOVE UPDATE] Movement DONE! Sending done command with end_cell: ("
-                      << end_cell.first << "," << end_cell.second << ")" << std::endl;
+            KFC_LOG("[MOVE UPDATE] Movement DONE! Sending done command with end_cell: ("
+                      << end_cell.first << "," << end_cell.second << ")");
 
-            return std::make_shared<Command>(Command{now_ms, "", "done", {end_cell}});
+            return done_command(now_ms);
         }
         double ratio = seconds / duration_s;
         curr_pos_m = {board.cell_to_m(start_cell).first + movement_vec.first * ratio,
@@ -133,6 +188,22 @@ public:
         return nullptr;
     }
 
+    void save_state(ByteWriter &w) const override
+    {
+        BasePhysics::save_state(w);
+        w.f64(movement_vec.first);
+        w.f64(movement_vec.second);
+    }
+
+    void load_state(ByteReader &r) override
+    {
+        BasePhysics::load_state(r);
+        movement_vec.first = r.f64();
+        movement_vec.second = r.f64();
+        movement_len = std::hypot(movement_vec.first, movement_vec.second);
+        duration_s = movement_len / param;
+    }
+
 private:
     std::pair<double, double> movement_vec{0.f, 0.f};
     double movement_len{0};
@@ -165,12 +236,12 @@ public:
         start_ms = cmd.timestamp;
     }
 
-    std::shared_ptr<Command> update(int now_ms) override
+    const Command *update(int now_ms) override
     {
         double seconds = (now_ms - start_ms) / 1000.0;
         if (seconds >= param)
         {
-            return std::make_shared<Command>(Command{now_ms, "", "done", {end_cell}});
+            return done_command(now_ms);
         }
         return nullptr;
     }
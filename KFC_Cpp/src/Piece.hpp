@@ -3,10 +3,14 @@
 #include "Common.hpp"
 #include "State.hpp"
 #include "Command.hpp"
+#include "Tracer.hpp"
 #include <memory>
 #include <unordered_map>
 #include <vector>
 #include <utility>  // בשביל std::pair
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
 
 
 class Piece;
@@ -15,16 +19,17 @@ typedef std::shared_ptr<Piece> PiecePtr;
 class Piece {
 public:
 	Piece(std::string id, std::shared_ptr<State> init_state)
-		: id(id), state(init_state) {}
+		: id(id), state(init_state), root_state(init_state) {}
 
 	std::string id;
 	std::shared_ptr<State> state;
 
 	void on_command(const Command& cmd, Cell2Pieces& c) {
-		state = state->on_command(cmd,c);
+		enter(state->on_command(cmd,c));
 	}
 
 	void reset(int start_ms) {
+		if (trace_enabled()) state_since_us = trace_now_us();
 		// Extract position from piece ID (e.g., "PW_(6,6)" -> {6,6})
 		std::string id_str = id;
 		size_t pos = id_str.find("_(");
@@ -43,7 +48,7 @@ public:
 	}
 
 	void update(int now_ms,Cell2Pieces& c) {
-		state = state->update(now_ms,c);
+		enter(state->update(now_ms,c));
 	}
 
 	bool is_movement_blocker() const { return state->physics->is_movement_blocker(); }
@@ -55,4 +60,48 @@ public:
 		sprite->draw_on(*board.img, x, y);
 	}
 	Cell current_cell() const { return state->physics->get_curr_cell(); }
+
+	// Every state of this piece's machine, ordered by name, so a state can be
+	// referred to by a stable one-byte index (snapshots).  Built on first use.
+	const std::vector<std::shared_ptr<State>>& state_list() const {
+		if (all_states.empty()) {
+			std::unordered_set<State*> seen;
+			std::deque<std::shared_ptr<State>> todo{ root_state };
+			while (!todo.empty()) {
+				auto s = todo.front();
+				todo.pop_front();
+				if (!s || !seen.insert(s.get()).second) continue;
+				all_states.push_back(s);
+				for (const auto& kv : s->transitions) todo.push_back(kv.second);
+			}
+			std::sort(all_states.begin(), all_states.end(),
+				[](const std::shared_ptr<State>& a, const std::shared_ptr<State>& b) { return a->name < b->name; });
+		}
+		return all_states;
+	}
+
+	size_t state_index() const {
+		const auto& list = state_list();
+		return static_cast<size_t>(std::find(list.begin(), list.end(), state) - list.begin());
+	}
+
+private:
+	// Switch state; while tracing, the state just left becomes a span on
+	// this piece's track.  The track is looked up once: trace_track takes
+	// the lock the flusher holds while it writes the file.
+	void enter(std::shared_ptr<State> next) {
+		if (next != state && trace_enabled()) {
+			uint64_t now = trace_now_us();
+			if (!track) track = trace_track(id);
+			if (state_since_us)
+				trace_complete_on(track, "piece", state->name, state_since_us, now - state_since_us);
+			state_since_us = now;
+		}
+		state = std::move(next);
+	}
+
+	uint64_t state_since_us{0};
+	uint32_t track{0}; // trace track id, 0 until first traced
+	std::shared_ptr<State> root_state; // entry state; every state is reachable from it
+	mutable std::vector<std::shared_ptr<State>> all_states;
 };
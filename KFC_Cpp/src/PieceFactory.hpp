@@ -75,27 +75,47 @@ private:
         return out;
     }
 
-    std::shared_ptr<State> build_state_machine(const fs::path &piece_dir)
+    // What one state directory says, read once per piece type
+    struct StateSpec
+    {
+        std::string name;
+        std::shared_ptr<Moves> moves; // immutable, shared by every piece of the type
+        fs::path sprites;
+        nlohmann::json gfx_cfg;
+        nlohmann::json phys_cfg;
+        bool need_clear_path{true};
+    };
+    struct TypeSpec
+    {
+        std::vector<StateSpec> states;
+        GlobalTrans transitions;
+    };
+
+    // Parsing the configs and moves of a type is the expensive part of
+    // creating a piece; a generated layout has thousands of each type
+    const TypeSpec &type_spec(const fs::path &piece_dir)
     {
+        auto cached = specs.find(piece_dir.string());
+        if (cached != specs.end())
+            return cached->second;
+
         fs::path states_root = piece_dir / "states";
         if (!fs::exists(states_root) || !fs::is_directory(states_root))
         {
             throw std::runtime_error("Missing states directory: " + states_root.string());
         }
-        
-        GlobalTrans global_trans = load_master_csv(states_root);
-        
-        std::unordered_map<std::string, std::shared_ptr<State>> states;
-        
+
+        TypeSpec spec;
+        spec.transitions = load_master_csv(states_root);
         std::pair<int, int> board_size = {board.W_cells, board.H_cells};
-        std::pair<int, int> cell_px = {board.cell_W_pix, board.cell_H_pix};
-        
+
         // iterate over each subdirectory in states_root
         for (const auto &entry : fs::directory_iterator(states_root))
         {
             if (!entry.is_directory())
             continue;
-            std::string name = entry.path().filename().string();
+            StateSpec st;
+            st.name = entry.path().filename().string();
             fs::path cfg_path = entry.path() / "config.json";
             nlohmann::json cfg;
             if (fs::exists(cfg_path))
@@ -113,33 +133,47 @@ private:
             
             // Moves
             fs::path moves_path = entry.path() / "moves.txt";
-            std::shared_ptr<Moves> moves_ptr;
             if (fs::exists(moves_path))
             {
-                moves_ptr = std::make_shared<Moves>(moves_path.string(), board_size);
+                st.moves = std::make_shared<Moves>(moves_path.string(), board_size);
             }
             
+            st.sprites = entry.path() / "sprites";
+            st.gfx_cfg = cfg.contains("graphics") ? cfg["graphics"] : nlohmann::json{};
+            st.phys_cfg = cfg.contains("physics") ? cfg["physics"] : nlohmann::json{};
+            // Set need_clear_path flag from config (default true)
+            if(st.phys_cfg.contains("need_clear_path")) {
+                st.need_clear_path = st.phys_cfg["need_clear_path"];
+            }
+            spec.states.push_back(std::move(st));
+        }
+        return specs.emplace(piece_dir.string(), std::move(spec)).first->second;
+    }
+
+    std::shared_ptr<State> build_state_machine(const fs::path &piece_dir)
+    {
+        const TypeSpec &spec = type_spec(piece_dir);
+        
+        std::unordered_map<std::string, std::shared_ptr<State>> states;
+        
+        std::pair<int, int> cell_px = {board.cell_W_pix, board.cell_H_pix};
+        PhysicsFactory phys_factory(board);
+        
+        for (const StateSpec &st_spec : spec.states)
+        {
             // Graphics
-            nlohmann::json gfx_cfg = cfg.contains("graphics") ? cfg["graphics"] : nlohmann::json{};
-            auto graphics = gfx_factory.load((entry.path() / "sprites").string(), gfx_cfg, cell_px);
+            auto graphics = gfx_factory.load(st_spec.sprites.string(), st_spec.gfx_cfg, cell_px);
             
             // Physics
-            nlohmann::json phys_cfg = cfg.contains("physics") ? cfg["physics"] : nlohmann::json{};
-            PhysicsFactory phys_factory(board);
-            auto physics = phys_factory.create({0, 0}, name, phys_cfg);
-            // Set need_clear_path flag from config (default true)
-            bool need_clear_path = true;
-            if(phys_cfg.contains("need_clear_path")) {
-                need_clear_path = phys_cfg["need_clear_path"];
-            }
-            physics->set_need_clear_path(need_clear_path);
-            auto st = std::make_shared<State>(moves_ptr, graphics, physics);
-            st->name = name;
-            states[name] = st;
+            auto physics = phys_factory.create({0, 0}, st_spec.name, st_spec.phys_cfg);
+            physics->set_need_clear_path(st_spec.need_clear_path);
+            auto st = std::make_shared<State>(st_spec.moves, graphics, physics);
+            st->name = st_spec.name;
+            states[st_spec.name] = st;
         }
 
         // apply global transitions overrides
-        for (const auto &[frm, ev_map] : global_trans)
+        for (const auto &[frm, ev_map] : spec.transitions)
         {
             auto src_it = states.find(frm);
             if (src_it == states.end())
@@ -168,4 +202,5 @@ private:
     Board &board;
     std::string pieces_root;
     const GraphicsFactory &gfx_factory;
+    std::unordered_map<std::string, TypeSpec> specs; // by piece directory
 };
\ No newline at end of file
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "Piece.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Where every piece stood at the end of the last tick, for the input threads.
+//
+// The game thread publishes after each tick; keyboard producers read without
+// locks and without touching Game::pieces, which the game thread changes
+// under them (captures).  Publication is epoch-style over a few fixed
+// buffers: the game thread refills a buffer no reader holds and swaps it in
+// with one atomic store; a reader pins the current buffer with a counter and
+// re-checks that it is still current before trusting it.  Nothing is
+// allocated after construction.
+//
+// publish() refills a buffer from the whole piece list.  publish_changes()
+// is told which pieces moved or were captured in the step; the game thread
+// keeps those lists for a few steps so a buffer that sat out some
+// publications catches up on just the pieces that changed since it was last
+// filled, and a tick costs O(changed) however many pieces stand still.
+//
+// Pieces are numbered by their slot in the game's roster (board order).
+// Each cell keeps the first white and the first black piece standing on it.
+// ---------------------------------------------------------------------------
+class PieceIndex
+{
+    struct Buffer;
+
+public:
+    static constexpr int kNone = -1;
+
+    // Immutable while a reader holds it
+    struct Snapshot
+    {
+        int tick_ms{0};
+        uint64_t epoch{0};
+
+        // Roster slot of the piece of `color` ('W' or 'B') at cell, or kNone
+        int piece_at(std::pair<int, int> cell, char color) const
+        {
+            int ci = color_index(color);
+            if (ci < 0 || cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols)
+                return kNone;
+            return cells[static_cast<size_t>(cell.first * cols + cell.second)][ci];
+        }
+        // Cell of a roster slot; {-1,-1} once captured
+        std::pair<int, int> cell_of(int slot) const
+        {
+            if (slot < 0 || static_cast<size_t>(slot) >= piece_cells.size())
+                return {-1, -1};
+            return piece_cells[static_cast<size_t>(slot)];
+        }
+
+    private:
+        friend class PieceIndex;
+        int rows{0}, cols{0};
+        std::vector<std::array<int32_t, 2>> cells; // rows*cols, [white, black]
+        std::vector<std::pair<int, int>> piece_cells;
+    };
+
+    // Pins the current snapshot for as long as it lives
+    class Reader
+    {
+    public:
+        explicit Reader(const PieceIndex &index) : buf(index.acquire()) {}
+        ~Reader() { buf->readers.fetch_sub(1); }
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        const Snapshot &operator*() const { return buf->snap; }
+        const Snapshot *operator->() const { return &buf->snap; }
+
+    private:
+        const Buffer *buf;
+    };
+
+    PieceIndex(const std::vector<PiecePtr> &roster, int rows, int cols)
+    {
+        ids.reserve(roster.size());
+        colors.reserve(roster.size());
+        for (size_t i = 0; i < roster.size(); ++i)
+        {
+            ids.push_back(roster[i]->id);
+            colors.push_back(static_cast<int8_t>(roster[i]->id.size() > 1 ? color_index(roster[i]->id[1]) : -1));
+            slot_by_id.emplace(roster[i]->id, static_cast<int>(i));
+            slot_by_piece.emplace(roster[i].get(), static_cast<int>(i));
+        }
+        for (auto &b : buffers)
+        {
+            b.snap.rows = rows;
+            b.snap.cols = cols;
+            b.snap.cells.assign(static_cast<size_t>(rows) * cols, {kNone, kNone});
+            b.snap.piece_cells.assign(roster.size(), {-1, -1});
+        }
+        changes.reserve(4 * roster.size() + 64);
+    }
+
+    PieceIndex(const PieceIndex &) = delete;
+    PieceIndex &operator=(const PieceIndex &) = delete;
+
+    // Game thread only: record where the live pieces stand now.  Skipped
+    // (the readers keep the previous tick) in the unlikely case that readers
+    // pin every spare buffer.
+    bool publish(const std::vector<PiecePtr> &pieces, int tick_ms)
+    {
+        int cur = current.load();
+        for (int i = 0; i < kBuffers; ++i)
+        {
+            if (i == cur || buffers[i].readers.load() != 0)
+                continue;
+            Snapshot &s = buffers[i].snap;
+            clear(s);
+            for (const auto &p : pieces)
+            {
+                auto it = slot_by_piece.find(p.get());
+                if (it != slot_by_piece.end())
+                    place(s, it->second, p->current_cell());
+            }
+            s.tick_ms = tick_ms;
+            s.epoch = ++published;
+            // Changes before this are not recorded: the other buffers refill
+            changes.clear();
+            changes_from = published + 1;
+            current.store(i);
+            return true;
+        }
+        return false;
+    }
+
+    // Game thread only: the same for a step in which only the slots in
+    // `changed` can have moved or been captured.  live describes the board
+    // as it is now:
+    //   live.cell_of(slot)           the slot's cell, {-1,-1} once captured
+    //   live.first_at(cell, color)   lowest slot of that colour on cell, or kNone
+    template <class Live>
+    bool publish_changes(const std::vector<int> &changed, const Live &live, int tick_ms)
+    {
+        const uint64_t epoch = published + 1;
+        if (changes.size() + changed.size() > changes.capacity())
+        {
+            // Too far behind to catch up: whoever is left refills in full
+            changes.clear();
+            changes_from = epoch + (changed.size() > changes.capacity() ? 1 : 0);
+        }
+        if (changes_from <= epoch)
+            for (int slot : changed)
+                changes.push_back(Change{epoch, slot});
+
+        int cur = current.load();
+        for (int i = 0; i < kBuffers; ++i)
+        {
+            if (i == cur || buffers[i].readers.load() != 0)
+                continue;
+            Snapshot &s = buffers[i].snap;
+            if (can_catch_up(s))
+            {
+                auto refresh = [&](std::pair<int, int> cell, int ci)
+                {
+                    if (ci >= 0 && in_bounds(s, cell))
+                        s.cells[static_cast<size_t>(cell.first * s.cols + cell.second)][ci] = live.first_at(cell, ci == 0 ? 'W' : 'B');
+                };
+                for (const Change &c : changes)
+                {
+                    if (c.epoch <= s.epoch)
+                        continue;
+                    auto &at = s.piece_cells[static_cast<size_t>(c.slot)];
+                    auto now = live.cell_of(c.slot);
+                    if (now == at)
+                        continue;
+                    auto before = at;
+                    at = now;
+                    refresh(before, colors[static_cast<size_t>(c.slot)]);
+                    refresh(now, colors[static_cast<size_t>(c.slot)]);
+                }
+            }
+            else
+            {
+                clear(s);
+                for (size_t slot = 0; slot < s.piece_cells.size(); ++slot)
+                    place(s, static_cast<int>(slot), live.cell_of(static_cast<int>(slot)));
+            }
+            s.tick_ms = tick_ms;
+            s.epoch = ++published;
+            current.store(i);
+            forget_caught_up();
+            return true;
+        }
+        return false;
+    }
+
+    // Roster slot of an id, kNone if unknown.  Fixed at construction, so any
+    // thread may call it.
+    int slot_of(const std::string &id) const
+    {
+        auto it = slot_by_id.find(id);
+        return it == slot_by_id.end() ? kNone : it->second;
+    }
+    const std::string &id_of(int slot) const { return ids.at(static_cast<size_t>(slot)); }
+    int slot_of(const Piece *piece) const
+    {
+        auto it = slot_by_piece.find(piece);
+        return it == slot_by_piece.end() ? kNone : it->second;
+    }
+
+private:
+    static constexpr int kBuffers = 4;
+
+    struct Buffer
+    {
+        mutable std::atomic<int> readers{0};
+        Snapshot snap;
+    };
+
+    // One slot whose cell changed at epoch
+    struct Change
+    {
+        uint64_t epoch;
+        int slot;
+    };
+
+    static int color_index(char color) { return color == 'W' ? 0 : color == 'B' ? 1 : -1; }
+    static bool in_bounds(const Snapshot &s, std::pair<int, int> cell)
+    {
+        return cell.first >= 0 && cell.first < s.rows && cell.second >= 0 && cell.second < s.cols;
+    }
+
+    // Clear only what this buffer marked last time
+    static void clear(Snapshot &s)
+    {
+        for (auto &c : s.piece_cells)
+        {
+            if (c.first >= 0)
+                s.cells[static_cast<size_t>(c.first * s.cols + c.second)] = {kNone, kNone};
+            c = {-1, -1};
+        }
+    }
+    // In ascending slot order, so the first piece of a colour keeps the cell
+    void place(Snapshot &s, int slot, std::pair<int, int> cell) const
+    {
+        s.piece_cells[static_cast<size_t>(slot)] = cell;
+        int ci = colors[static_cast<size_t>(slot)];
+        if (ci < 0 || !in_bounds(s, cell))
+            return;
+        int32_t &first = s.cells[static_cast<size_t>(cell.first * s.cols + cell.second)][ci];
+        if (first == kNone)
+            first = slot;
+    }
+
+    // Filled once, and every change since is still recorded
+    bool can_catch_up(const Snapshot &s) const { return s.epoch != 0 && s.epoch + 1 >= changes_from; }
+
+    // Drop the changes every buffer that can still catch up has seen
+    void forget_caught_up()
+    {
+        uint64_t seen = published;
+        for (const auto &b : buffers)
+            if (can_catch_up(b.snap))
+                seen = std::min(seen, b.snap.epoch);
+        auto keep = std::find_if(changes.begin(), changes.end(), [&](const Change &c)
+                                 { return c.epoch > seen; });
+        changes.erase(changes.begin(), keep);
+        changes_from = std::max(changes_from, seen + 1);
+    }
+
+    const Buffer *acquire() const
+    {
+        for (;;)
+        {
+            int i = current.load();
+            const Buffer &b = buffers[i];
+            b.readers.fetch_add(1);
+            // Still current after pinning: the game thread will not refill it
+            if (current.load() == i)
+                return &b;
+            b.readers.fetch_sub(1);
+        }
+    }
+
+    std::array<Buffer, kBuffers> buffers;
+    std::atomic<int> current{0};
+    uint64_t published{0}; // game thread only
+    // Slots changed since the epoch the most outdated buffer that can still
+    // catch up was filled at, oldest first; complete from changes_from on
+    std::vector<Change> changes;
+    uint64_t changes_from{1};
+    std::vector<std::string> ids;
+    std::vector<int8_t> colors; // colour_index by slot
+    std::unordered_map<std::string, int> slot_by_id;
+    std::unordered_map<const Piece *, int> slot_by_piece;
+};
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "AllocStats.hpp"
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Lock-free latency histogram with HDR-style log-linear buckets: every power
+// of two is split into 16 linear sub-buckets, so any recorded value is known
+// to within 1/16 (~6%) while the whole range 1 ns .. ~18 min fits in a few
+// hundred counters.  record() is a couple of relaxed atomic adds, safe to
+// call from any thread while another one reads percentiles.
+// ---------------------------------------------------------------------------
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSub = 1ull << kSubBits;
+    static constexpr int kMaxBits = 40;
+    static constexpr size_t kBuckets = (kMaxBits - kSubBits + 1) * kSub;
+
+    void record(uint64_t v)
+    {
+        buckets[index(v)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+        uint64_t seen = peak.load(std::memory_order_relaxed);
+        while (v > seen && !peak.compare_exchange_weak(seen, v, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return peak.load(std::memory_order_relaxed); }
+    double mean() const
+    {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+    }
+
+    // Value at quantile q in [0, 1] (bucket midpoint, never above max())
+    uint64_t percentile(double q) const
+    {
+        uint64_t n = count();
+        if (n == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(n - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(midpoint(i), max());
+        }
+        return max();
+    }
+
+    void reset()
+    {
+        for (auto &b : buckets)
+            b.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        peak.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t index(uint64_t v)
+    {
+        if (v < kSub)
+            return static_cast<size_t>(v);
+        int bits = 64 - count_leading_zeros(v); // v in [2^(bits-1), 2^bits)
+        if (bits > kMaxBits)
+            return kBuckets - 1;
+        int shift = bits - 1 - kSubBits;
+        return static_cast<size_t>((shift + 1) * kSub + ((v >> shift) - kSub));
+    }
+
+    static uint64_t lower_bound(size_t i)
+    {
+        if (i < kSub)
+            return i;
+        int shift = static_cast<int>(i / kSub) - 1;
+        return (kSub + i % kSub) << shift;
+    }
+
+private:
+    static int count_leading_zeros(uint64_t v)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(v);
+#else
+        int n = 0;
+        for (uint64_t bit = 1ull << 63; bit && !(v & bit); bit >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+
+    static uint64_t midpoint(size_t i)
+    {
+        uint64_t lo = lower_bound(i);
+        uint64_t hi = i + 1 < kBuckets ? lower_bound(i + 1) : lo + 1;
+        return lo + (hi - lo) / 2;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> peak{0};
+};
+
+// Phases of one iteration of Game::run_game_loop
+enum class TickPhase
+{
+    Pieces,     // piece state/physics updates + cell map
+    Commands,   // draining and applying the input queue
+    Collisions, // resolve_collisions
+    Render,     // composing the frame
+    Show,       // imshow / waitKey
+    Tick,       // the whole iteration, sleep excluded
+    Count
+};
+
+inline const char *tick_phase_name(TickPhase p)
+{
+    static const char *names[] = {"pieces", "commands", "collisions", "render", "show", "tick"};
+    return names[static_cast<int>(p)];
+}
+
+// ---------------------------------------------------------------------------
+// Per-phase timing and heap allocations of the game loop.  Disabled it costs
+// one relaxed load per scope; enabled two steady_clock reads, a histogram
+// record and two counter adds.
+// ---------------------------------------------------------------------------
+class FrameProfiler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    void set_enabled(bool on) { on_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return on_.load(std::memory_order_relaxed); }
+
+    void record(TickPhase p, uint64_t ns) { hist[static_cast<int>(p)].record(ns); }
+    const LatencyHistogram &histogram(TickPhase p) const { return hist[static_cast<int>(p)]; }
+
+    void record_allocs(TickPhase p, const AllocCounters &d)
+    {
+        allocs[static_cast<int>(p)].fetch_add(d.allocs, std::memory_order_relaxed);
+        alloc_bytes[static_cast<int>(p)].fetch_add(d.bytes, std::memory_order_relaxed);
+    }
+    // Mean heap allocations / requested bytes per run of a phase
+    double allocs_per_run(TickPhase p) const { return per_run(allocs, p); }
+    double bytes_per_run(TickPhase p) const { return per_run(alloc_bytes, p); }
+
+    // Call once per presented frame; drives the FPS figure
+    void frame_presented(clock::time_point t = clock::now())
+    {
+        frames[frame_head++ % frames.size()] = t;
+        ++frame_count;
+    }
+
+    double fps() const
+    {
+        size_t n = std::min<uint64_t>(frame_count, frames.size());
+        if (n < 2)
+            return 0.0;
+        auto newest = frames[(frame_head - 1) % frames.size()];
+        auto oldest = frames[(frame_head - n) % frames.size()];
+        double s = std::chrono::duration<double>(newest - oldest).count();
+        return s > 0 ? static_cast<double>(n - 1) / s : 0.0;
+    }
+
+    // Short lines for the on-screen overlay
+    std::vector<std::string> hud_lines() const
+    {
+        std::vector<std::string> out;
+        char line[96];
+        if (alloc_hook_installed())
+            std::snprintf(line, sizeof line, "FPS %.1f  tick %.2f ms  %.1f allocs / %.0f B", fps(),
+                          histogram(TickPhase::Tick).mean() / 1e6, allocs_per_run(TickPhase::Tick),
+                          bytes_per_run(TickPhase::Tick));
+        else
+            std::snprintf(line, sizeof line, "FPS %.1f  tick %.2f ms", fps(), histogram(TickPhase::Tick).mean() / 1e6);
+        out.emplace_back(line);
+        for (int i = 0; i < static_cast<int>(TickPhase::Count); ++i)
+        {
+            const auto &h = hist[i];
+            std::snprintf(line, sizeof line, "%-10s p50 %6.2f p99 %6.2f max %6.2f",
+                          tick_phase_name(static_cast<TickPhase>(i)), h.percentile(0.50) / 1e6,
+                          h.percentile(0.99) / 1e6, h.max() / 1e6);
+            out.emplace_back(line);
+        }
+        return out;
+    }
+
+    void dump(std::ostream &os) const
+    {
+        os << "=== Tick profile (ms) ===\n";
+        if (!alloc_hook_installed())
+            os << "(allocations not counted: configure with -DKFC_COUNT_ALLOCS=ON)\n";
+        char line[160];
+        for (int i = 0; i < static_cast<int>(TickPhase::Count); ++i)
+        {
+            const auto &h = hist[i];
+            auto p = static_cast<TickPhase>(i);
+            std::snprintf(line, sizeof line,
+                          "%-10s n %8llu  mean %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f  allocs %6.1f  bytes %8.0f\n",
+                          tick_phase_name(p), static_cast<unsigned long long>(h.count()), h.mean() / 1e6,
+                          h.percentile(0.50) / 1e6, h.percentile(0.90) / 1e6, h.percentile(0.99) / 1e6,
+                          h.max() / 1e6, allocs_per_run(p), bytes_per_run(p));
+            os << line;
+        }
+        std::snprintf(line, sizeof line, "fps %.1f over the last %zu frames\n", fps(),
+                      static_cast<size_t>(std::min<uint64_t>(frame_count, frames.size())));
+        os << line;
+    }
+
+    void reset()
+    {
+        for (auto &h : hist)
+            h.reset();
+        for (size_t i = 0; i < allocs.size(); ++i)
+        {
+            allocs[i].store(0, std::memory_order_relaxed);
+            alloc_bytes[i].store(0, std::memory_order_relaxed);
+        }
+        frame_count = 0;
+        frame_head = 0;
+    }
+
+private:
+    using PhaseCounters = std::array<std::atomic<uint64_t>, static_cast<size_t>(TickPhase::Count)>;
+
+    double per_run(const PhaseCounters &c, TickPhase p) const
+    {
+        uint64_t n = histogram(p).count();
+        return n ? static_cast<double>(c[static_cast<int>(p)].load(std::memory_order_relaxed)) / static_cast<double>(n)
+                 : 0.0;
+    }
+
+    std::atomic<bool> on_{false};
+    std::array<LatencyHistogram, static_cast<size_t>(TickPhase::Count)> hist;
+    PhaseCounters allocs{};
+    PhaseCounters alloc_bytes{};
+    std::array<clock::time_point, 64> frames{};
+    uint64_t frame_head{0};
+    uint64_t frame_count{0};
+};
+
+// Times the enclosing block into one phase and counts the heap allocations
+// it makes on this thread; also emits a trace event when a trace is being
+// written
+class ProfileScope
+{
+public:
+    ProfileScope(FrameProfiler &prof, TickPhase phase)
+        : prof(prof.enabled() ? &prof : nullptr), phase(phase), traced(trace_enabled())
+    {
+        if (this->prof || traced)
+            start = FrameProfiler::clock::now();
+    }
+
+    ~ProfileScope()
+    {
+        if (!prof && !traced)
+            return;
+        auto end = FrameProfiler::clock::now();
+        if (prof)
+        {
+            prof->record_allocs(phase, allocs.delta());
+            prof->record(phase, static_cast<uint64_t>(
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+        if (traced)
+        {
+            uint64_t t0 = trace_us(start);
+            trace_complete("loop", tick_phase_name(phase), t0, trace_us(end) - t0);
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    FrameProfiler *prof;
+    TickPhase phase;
+    bool traced;
+    FrameProfiler::clock::time_point start;
+    AllocScope allocs;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Game.hpp"
+#include "CommandJournal.hpp"
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+struct ReplayStats
+{
+    size_t ticks{0};
+    size_t commands{0};
+    int final_ms{0};   // game time of the last replayed tick
+    double wall_ms{0}; // how long the replay itself took
+};
+
+// ---------------------------------------------------------------------------
+// Build the game recorded in a journal.  The rule assets under pieces_root
+// must match the ones the journal was written with, otherwise the replay
+// would silently diverge.
+// ---------------------------------------------------------------------------
+inline Game create_replay_game(const JournalReader &reader,
+                               const std::string &pieces_root,
+                               const ImgFactoryPtr &img_factory)
+{
+    if (hash_piece_assets(pieces_root) != reader.asset_hash())
+        throw std::runtime_error("Journal was recorded with different piece assets");
+    std::istringstream in(reader.board_csv());
+    return create_game(in, pieces_root, img_factory);
+}
+
+// ---------------------------------------------------------------------------
+// Feed a journal back into game under a virtual clock: every recorded tick is
+// simulated back to back, with the commands that tick consumed queued first.
+// No sleeping, no input threads, no rendering.
+//
+// before_step, when given, is called with the game time of every tick and
+// reset just before it is simulated (the offline renderer draws its frames
+// there).
+// ---------------------------------------------------------------------------
+using ReplayStepHook = std::function<void(int step_ms)>;
+
+inline ReplayStats replay_journal(Game &game, JournalReader &reader, const ReplayStepHook &before_step = {})
+{
+    auto wall_start = std::chrono::steady_clock::now();
+    ReplayStats stats;
+    JournalRecord rec;
+    bool tick_pending = false;
+    int tick_ms = 0;
+
+    auto run_pending_tick = [&]()
+    {
+        if (!tick_pending)
+            return;
+        if (before_step)
+            before_step(tick_ms);
+        game.advance(tick_ms);
+        ++stats.ticks;
+        stats.final_ms = tick_ms;
+        tick_pending = false;
+    };
+
+    while (reader.next(rec))
+    {
+        switch (rec.kind)
+        {
+        case JournalRecord::Tick:
+            run_pending_tick();
+            tick_pending = true;
+            tick_ms = rec.time_ms;
+            break;
+        case JournalRecord::Cmd:
+            game.enqueue_command(rec.cmd);
+            ++stats.commands;
+            break;
+        case JournalRecord::Reset:
+            run_pending_tick();
+            if (before_step)
+                before_step(rec.time_ms);
+            game.reset_pieces(rec.time_ms);
+            stats.final_ms = rec.time_ms;
+            break;
+        }
+    }
+    run_pending_tick();
+
+    stats.wall_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - wall_start)
+                        .count();
+    return stats;
+}
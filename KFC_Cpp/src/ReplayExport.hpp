@@ -0,0 +1,263 @@
+#pragma once
+
+#include "Replay.hpp"
+#include "Tracer.hpp"
+#include "img/FrameSink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Offline rendering of a recorded game into a FrameSink (video file, PNG
+// sequence).  The journal is replayed on a virtual clock exactly as
+// replay_journal does; between its steps frames are composed at a fixed
+// rate with Game::render_frame and handed to encoder threads, so rendering
+// the next frames overlaps encoding the previous ones and nothing waits
+// on the wall clock.
+//
+//   render thread (caller)          encoder thread(s)
+//   replay, render_frame(t),  ──►   sink.write(frame, n)
+//   copy into a free buffer   ◄──   buffer back to the free list
+//
+// A fixed pool of queue_depth buffers bounds the memory and applies back
+// pressure when the encoders fall behind.  A sink that is not concurrent()
+// (a video stream) gets one encoder and the frames in order; a concurrent
+// one (independent image files) gets encode_threads of them.
+// ---------------------------------------------------------------------------
+struct ExportOptions
+{
+    double fps{30.0};
+    int encode_threads{0}; // 0: one per spare hardware thread
+    int queue_depth{8};    // frames in flight between render and encode
+    int tail_ms{500};      // keep filming after the last recorded step
+    int view_cell_px{0};   // see Game::set_view_cell_px; 0 = native
+};
+
+struct ExportStats
+{
+    size_t frames{0};
+    size_t ticks{0};
+    size_t commands{0};
+    int video_ms{0};         // length of the clip
+    double wall_ms{0};       // the whole export
+    double render_ms{0};     // replay and frame composition, render thread
+    double encode_ms{0};     // summed over the encoder threads
+    double stall_ms{0};      // render thread waiting for a free buffer
+    double speedup() const { return wall_ms > 0 ? video_ms / wall_ms : 0.0; }
+};
+
+namespace replay_export_detail
+{
+using ms_clock = std::chrono::steady_clock;
+
+inline double ms_since(ms_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(ms_clock::now() - t0).count();
+}
+
+class FramePipeline
+{
+public:
+    FramePipeline(FrameSink &sink, int workers, int depth) : sink(sink)
+    {
+        if (!sink.concurrent())
+            workers = 1;
+        pool.resize(static_cast<size_t>(std::max(depth, workers)));
+        for (size_t i = 0; i < pool.size(); ++i)
+            free_slots.push_back(i);
+        for (int i = 0; i < workers; ++i)
+            threads.emplace_back([this]
+                                 { encode_loop(); });
+    }
+    ~FramePipeline()
+    {
+        try
+        {
+            finish();
+        }
+        catch (...)
+        {
+        }
+    }
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    // Copy frame into a free buffer, waiting while all are in flight
+    void push(const Img &frame, int index)
+    {
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            if (free_slots.empty())
+            {
+                auto t0 = ms_clock::now();
+                slot_freed.wait(lock, [this]
+                                { return !free_slots.empty() || error; });
+                stalled_ms += ms_since(t0);
+            }
+            if (error)
+                std::rethrow_exception(error);
+            slot = free_slots.front();
+            free_slots.pop_front();
+        }
+        // The slot is ours alone until it is queued
+        ImgPtr &buf = pool[slot];
+        if (!buf || !frame.copy_to(*buf))
+            buf = frame.clone();
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            ready.push_back(Job{slot, index});
+        }
+        frame_ready.notify_one();
+    }
+
+    // Drain the queue, join the encoders and finish the sink; rethrows the
+    // first encoder error
+    void finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (done)
+                return;
+            done = true;
+        }
+        frame_ready.notify_all();
+        for (auto &t : threads)
+            t.join();
+        threads.clear();
+        if (error)
+            std::rethrow_exception(error);
+        sink.finish();
+    }
+
+    double encode_ms() const { return encoded_ms; }
+    double stall_ms() const { return stalled_ms; }
+
+private:
+    struct Job
+    {
+        size_t slot;
+        int index;
+    };
+
+    void encode_loop()
+    {
+        trace_thread_name("frame encoder");
+        double busy = 0;
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                frame_ready.wait(lock, [this]
+                                 { return !ready.empty() || done || error; });
+                if (error || ready.empty())
+                    break; // failed, or finished and drained
+                job = ready.front();
+                ready.pop_front();
+            }
+            auto t0 = ms_clock::now();
+            try
+            {
+                sink.write(*pool[job.slot], job.index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                if (!error)
+                    error = std::current_exception();
+                slot_freed.notify_all();
+                frame_ready.notify_all();
+                break;
+            }
+            busy += ms_since(t0);
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                free_slots.push_back(job.slot);
+            }
+            slot_freed.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(mu);
+        encoded_ms += busy;
+    }
+
+    FrameSink &sink;
+    std::vector<ImgPtr> pool;
+    std::deque<size_t> free_slots;
+    std::deque<Job> ready;
+    std::vector<std::thread> threads;
+    std::mutex mu;
+    std::condition_variable frame_ready, slot_freed;
+    std::exception_ptr error;
+    bool done{false};
+    double encoded_ms{0};
+    double stalled_ms{0}; // render thread only
+};
+} // namespace replay_export_detail
+
+// Render the game recorded in reader into sink.  game must come from
+// create_replay_game with an image factory that draws (OpenCvImgFactory for
+// real output).  Frame n shows the game at first_step + n / fps, after every
+// recorded step up to that time.
+inline ExportStats export_replay(Game &game, JournalReader &reader, FrameSink &sink,
+                                 const ExportOptions &opts = {})
+{
+    using namespace replay_export_detail;
+    if (opts.fps <= 0)
+        throw std::invalid_argument("export fps must be positive");
+    auto wall_start = ms_clock::now();
+    if (opts.view_cell_px > 0 && !game.set_view_cell_px(opts.view_cell_px))
+        throw std::runtime_error("This image kind cannot be rendered at another cell size");
+
+    int workers = opts.encode_threads;
+    if (workers <= 0)
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    FramePipeline pipe(sink, workers, opts.queue_depth);
+
+    ExportStats stats;
+    const double period_ms = 1000.0 / opts.fps;
+    bool started = false;
+    int first_ms = 0;
+    auto frame_time = [&](size_t n)
+    { return first_ms + static_cast<int>(std::lround(static_cast<double>(n) * period_ms)); };
+    // Every frame due before `until` shows the state as it is now
+    auto film_until = [&](int until, bool inclusive)
+    {
+        for (int t = frame_time(stats.frames); t < until || (inclusive && t == until); t = frame_time(stats.frames))
+        {
+            Board frame = game.render_frame(t);
+            pipe.push(*frame.img, static_cast<int>(stats.frames));
+            ++stats.frames;
+        }
+    };
+
+    ReplayStats replay = replay_journal(game, reader, [&](int step_ms)
+                                        {
+        if (!started)
+        {
+            started = true;
+            first_ms = step_ms;
+            return;
+        }
+        film_until(step_ms, false); });
+    if (started)
+        film_until(replay.final_ms + opts.tail_ms, true);
+    stats.render_ms = ms_since(wall_start) - pipe.stall_ms();
+
+    pipe.finish();
+    stats.ticks = replay.ticks;
+    stats.commands = replay.commands;
+    stats.video_ms = static_cast<int>(std::lround(static_cast<double>(stats.frames) * period_ms));
+    stats.encode_ms = pipe.encode_ms();
+    stats.stall_ms = pipe.stall_ms();
+    stats.wall_ms = ms_since(wall_start);
+    return stats;
+}
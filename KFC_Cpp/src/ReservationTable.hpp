@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Which cells the pieces in flight will pass through, and when.
+//
+// A move from one cell to another at constant speed crosses a known list of
+// cells, each during a known time window: the same cells Piece::current_cell
+// will report tick by tick (positions truncate to cells).  The destination
+// is held from arrival on.  "Is this cell free at time t?" is then a look at
+// the windows of that one cell, usually none or one, instead of simulating
+// ahead or waiting for resolve_collisions to find the clash.
+//
+// Pieces are numbered by roster slot (see PieceIndex).  Starting or ending a
+// move touches only the cells of its path; nothing is allocated once every
+// slot and cell has held a reservation.  Game thread only.
+// ---------------------------------------------------------------------------
+class ReservationTable
+{
+public:
+    static constexpr int kForever = INT_MAX;
+
+    // slot holds the cell during [from_ms, to_ms)
+    struct Window
+    {
+        int slot;
+        int from_ms;
+        int to_ms;
+    };
+
+    ReservationTable(int rows, int cols, size_t slots)
+        : rows(rows), cols(cols), by_cell(static_cast<size_t>(rows) * cols), by_slot(slots)
+    {
+    }
+
+    // Record slot's move (replacing any it had): from `from` to `to`, leaving
+    // at start_ms and arriving duration_ms later
+    void reserve_move(int slot, std::pair<int, int> from, std::pair<int, int> to, int start_ms, int duration_ms)
+    {
+        release(slot);
+        if (slot < 0 || static_cast<size_t>(slot) >= by_slot.size() || from == to)
+            return;
+        auto &held = by_slot[static_cast<size_t>(slot)];
+        trace_path(from, to, start_ms, duration_ms, [&](std::pair<int, int> cell, int t0, int t1)
+                   {
+                       if (cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols)
+                           return;
+                       int ci = cell.first * cols + cell.second;
+                       by_cell[static_cast<size_t>(ci)].push_back(Window{slot, t0, t1});
+                       held.push_back(ci); });
+        if (!held.empty())
+            ++in_flight;
+    }
+
+    // The move ended (arrived, cancelled or captured)
+    void release(int slot)
+    {
+        if (slot < 0 || static_cast<size_t>(slot) >= by_slot.size())
+            return;
+        auto &held = by_slot[static_cast<size_t>(slot)];
+        if (held.empty())
+            return;
+        for (int ci : held)
+        {
+            auto &w = by_cell[static_cast<size_t>(ci)];
+            auto it = std::find_if(w.begin(), w.end(), [&](const Window &x)
+                                   { return x.slot == slot; });
+            if (it != w.end())
+            {
+                *it = w.back();
+                w.pop_back();
+            }
+        }
+        held.clear();
+        --in_flight;
+    }
+
+    void clear()
+    {
+        for (size_t s = 0; s < by_slot.size(); ++s)
+            release(static_cast<int>(s));
+    }
+
+    // No move other than except_slot's holds cell at t_ms
+    bool is_free(std::pair<int, int> cell, int t_ms, int except_slot = -1) const
+    {
+        for (const Window &w : windows(cell))
+            if (w.slot != except_slot && w.from_ms <= t_ms && t_ms < w.to_ms)
+                return false;
+        return true;
+    }
+
+    // The slot whose move holds cell at t_ms, -1 if none
+    int holder(std::pair<int, int> cell, int t_ms) const
+    {
+        for (const Window &w : windows(cell))
+            if (w.from_ms <= t_ms && t_ms < w.to_ms)
+                return w.slot;
+        return -1;
+    }
+
+    // Earliest time >= t_ms at which no move holds cell (kForever if a
+    // piece is on its way to stay there)
+    int free_from(std::pair<int, int> cell, int t_ms) const
+    {
+        const auto &ws = windows(cell);
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+            for (const Window &w : ws)
+                if (w.from_ms <= t_ms && t_ms < w.to_ms)
+                {
+                    t_ms = w.to_ms;
+                    moved = true;
+                }
+        }
+        return t_ms;
+    }
+
+    const std::vector<Window> &windows(std::pair<int, int> cell) const
+    {
+        static const std::vector<Window> none;
+        if (cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols)
+            return none;
+        return by_cell[static_cast<size_t>(cell.first * cols + cell.second)];
+    }
+    bool moving(int slot) const
+    {
+        return slot >= 0 && static_cast<size_t>(slot) < by_slot.size() && !by_slot[static_cast<size_t>(slot)].empty();
+    }
+    size_t moves_in_flight() const { return in_flight; }
+
+    // The cells a straight move at constant speed passes through, each with
+    // the [t0, t1) it spends there, in order; the destination's window runs
+    // to kForever.  Cells are what truncating the position gives, as
+    // Board::m_to_cell does: stepping down or left leaves the source cell
+    // at once, stepping up or right enters the next cell on reaching it.
+    template <class Fn>
+    static void trace_path(std::pair<int, int> from, std::pair<int, int> to, int start_ms, int duration_ms, Fn &&emit)
+    {
+        const int dr = to.first - from.first, dc = to.second - from.second;
+        const int ar = std::abs(dr), ac = std::abs(dc);
+        // Progress along the move in units of 1/L, where both axes cross
+        // cell borders at whole units
+        const int64_t L = ar == 0 ? std::max(ac, 1) : ac == 0 ? ar : lcm(ar, ac);
+        const int64_t step_r = ar ? L / ar : L + 1, step_c = ac ? L / ac : L + 1;
+        auto time_at = [&](int64_t u)
+        { return start_ms + static_cast<int>(static_cast<int64_t>(duration_ms) * u / L); };
+        // Cell halfway between progress a and b (in units of 1/L)
+        auto cell_between = [&](int64_t a, int64_t b)
+        {
+            return std::make_pair(static_cast<int>(floor_div(2 * L * from.first + dr * (a + b), 2 * L)),
+                                  static_cast<int>(floor_div(2 * L * from.second + dc * (a + b), 2 * L)));
+        };
+
+        std::pair<int, int> cur{INT_MIN, INT_MIN};
+        int64_t cur_from = 0;
+        int64_t next_r = step_r, next_c = step_c, u = 0;
+        while (u < L)
+        {
+            int64_t v = std::min({next_r, next_c, L});
+            auto cell = cell_between(u, v);
+            if (cell != cur)
+            {
+                if (cur.first != INT_MIN)
+                    emit(cur, time_at(cur_from), time_at(u));
+                cur = cell;
+                cur_from = u;
+            }
+            if (v == next_r)
+                next_r += step_r;
+            if (v == next_c)
+                next_c += step_c;
+            u = v;
+        }
+        // Arrived: the destination is held from here on
+        if (cur != to)
+        {
+            if (cur.first != INT_MIN)
+                emit(cur, time_at(cur_from), time_at(L));
+            cur_from = L;
+        }
+        emit(to, time_at(cur_from), kForever);
+    }
+
+private:
+    static int64_t floor_div(int64_t a, int64_t b) // b > 0
+    {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+    static int64_t lcm(int64_t a, int64_t b)
+    {
+        int64_t x = a, y = b;
+        while (y)
+        {
+            int64_t t = x % y;
+            x = y;
+            y = t;
+        }
+        return a / x * b;
+    }
+
+    int rows, cols;
+    std::vector<std::vector<Window>> by_cell; // rows*cols
+    std::vector<std::vector<int>> by_slot;    // cells each slot holds
+    size_t in_flight{0};
+};
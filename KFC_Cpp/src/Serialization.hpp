@@ -0,0 +1,223 @@
+#pragma once
+
+#include "Command.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Small binary codec shared by the command journal and the state snapshots.
+// Integers are LEB128 varints (signed values zig-zag encoded first) so the
+// common small values – cell coordinates, millisecond deltas – take a byte.
+// ---------------------------------------------------------------------------
+class ByteWriter
+{
+public:
+    void u8(uint8_t v) { buf.push_back(v); }
+
+    void varint(uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            buf.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        buf.push_back(static_cast<uint8_t>(v));
+    }
+
+    void svarint(int64_t v) { varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+
+    void u64(uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void f64(double v)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        u64(bits);
+    }
+
+    void str(const std::string &s)
+    {
+        varint(s.size());
+        bytes(s.data(), s.size());
+    }
+
+    void bytes(const void *data, size_t n)
+    {
+        const auto *p = static_cast<const uint8_t *>(data);
+        buf.insert(buf.end(), p, p + n);
+    }
+
+    void cell(const std::pair<int, int> &c)
+    {
+        svarint(c.first);
+        svarint(c.second);
+    }
+
+    const std::vector<uint8_t> &data() const { return buf; }
+    size_t size() const { return buf.size(); }
+    void clear() { buf.clear(); }
+
+private:
+    std::vector<uint8_t> buf;
+};
+
+class ByteReader
+{
+public:
+    ByteReader(const uint8_t *data, size_t n) : p(data), end(data + n) {}
+    explicit ByteReader(const std::vector<uint8_t> &v) : ByteReader(v.data(), v.size()) {}
+
+    bool done() const { return p == end; }
+    size_t remaining() const { return static_cast<size_t>(end - p); }
+
+    uint8_t u8()
+    {
+        need(1);
+        return *p++;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t b = u8();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Malformed varint");
+    }
+
+    int64_t svarint()
+    {
+        uint64_t v = varint();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    uint64_t u64()
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<uint64_t>(u8()) << (8 * i);
+        return v;
+    }
+
+    double f64()
+    {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+
+    std::string str()
+    {
+        size_t n = static_cast<size_t>(varint());
+        need(n);
+        std::string s(reinterpret_cast<const char *>(p), n);
+        p += n;
+        return s;
+    }
+
+    void bytes(void *out, size_t n)
+    {
+        need(n);
+        std::memcpy(out, p, n);
+        p += n;
+    }
+
+    std::pair<int, int> cell()
+    {
+        int r = static_cast<int>(svarint());
+        int c = static_cast<int>(svarint());
+        return {r, c};
+    }
+
+private:
+    void need(size_t n) const
+    {
+        if (static_cast<size_t>(end - p) < n)
+            throw std::runtime_error("Unexpected end of binary data");
+    }
+
+    const uint8_t *p;
+    const uint8_t *end;
+};
+
+// ---------------------------------------------------------------------------
+// Command codec.  The command type is one of a handful of known words, so it
+// is stored as a one byte code; anything else falls back to the raw string.
+// ---------------------------------------------------------------------------
+inline const std::vector<std::string> &known_command_types()
+{
+    static const std::vector<std::string> types = {"move", "jump", "done", "idle"};
+    return types;
+}
+
+inline void write_command_body(ByteWriter &w, const Command &cmd)
+{
+    const auto &types = known_command_types();
+    uint8_t code = 0xFF;
+    for (size_t i = 0; i < types.size(); ++i)
+        if (types[i] == cmd.type)
+            code = static_cast<uint8_t>(i);
+    w.u8(code);
+    if (code == 0xFF)
+        w.str(cmd.type);
+    w.varint(cmd.params.size());
+    for (const auto &p : cmd.params)
+        w.cell(p);
+}
+
+inline void read_command_body(ByteReader &r, Command &cmd)
+{
+    uint8_t code = r.u8();
+    const auto &types = known_command_types();
+    if (code == 0xFF)
+        cmd.type = r.str();
+    else if (code < types.size())
+        cmd.type = types[code];
+    else
+        throw std::runtime_error("Unknown command type code");
+    size_t n = static_cast<size_t>(r.varint());
+    cmd.params.clear();
+    for (size_t i = 0; i < n; ++i)
+        cmd.params.push_back(r.cell());
+}
+
+inline void write_command(ByteWriter &w, const Command &cmd)
+{
+    w.svarint(cmd.timestamp);
+    w.str(cmd.piece_id);
+    write_command_body(w, cmd);
+}
+
+inline Command read_command(ByteReader &r)
+{
+    Command cmd{0, "", "", {}};
+    cmd.timestamp = static_cast<int>(r.svarint());
+    cmd.piece_id = r.str();
+    read_command_body(r, cmd);
+    return cmd;
+}
+
+// 64-bit FNV-1a, used for asset fingerprints and state hashes.
+inline uint64_t fnv1a(const void *data, size_t n, uint64_t h = 1469598103934665603ull)
+{
+    const auto *p = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
@@ -4,6 +4,7 @@
 #include "Moves.hpp"
 #include "Graphics.hpp"
 #include "Physics.hpp"
+#include "Log.hpp"
 #include <unordered_map>
 #include <memory>
 #include <string>
@@ -37,53 +38,48 @@ public:
         std::string key = cmd.type;
         for(auto& ch : key) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
         
-        std::cout << "[STATE] Processing command type: " << key << " in state: " << name << std::endl;
+        KFC_LOG("[STATE] Processing command type: " << key << " in state: " << name);
         
         auto it = transitions.find(key);
         if(it != transitions.end()) {
             auto next = it->second;
-            std::cout << "[STATE] Found transition to: " << (next ? next->name : "null") << std::endl;
+            KFC_LOG("[STATE] Found transition to: " << (next ? next->name : "null"));
             
             if(next && key == "move" && cmd.params.size() >= 2) {
                 // Validate move using Moves class
                 if(!moves) {
-                    std::cout << "[STATE] No moves validator, accepting move" << std::endl;
+                    KFC_LOG("[STATE] No moves validator, accepting move");
                     next->reset(cmd);
                     return next;
                 }
-                std::unordered_set<std::pair<int,int>, PairHash> occupied_cells;
-                for(const auto& kv : c) {
-                    if(!kv.second.empty()) {
-                        occupied_cells.insert(kv.first);
-                    }
-                }
-                bool valid = moves->is_valid(cmd.params[0], cmd.params[1], occupied_cells, physics->is_need_clear_path());
-                std::cout << "[STATE] Move validation result: " << (valid ? "VALID" : "INVALID") << std::endl;
+                // Looks up only the cells on the way, however big the board
+                bool valid = moves->is_valid(cmd.params[0], cmd.params[1], c, physics->is_need_clear_path());
+                KFC_LOG("[STATE] Move validation result: " << (valid ? "VALID" : "INVALID"));
                 if(!valid) {
                     auto from = cmd.params[0];
                     auto to = cmd.params[1];
-                    std::cout << "[STATE] Attempted move: (" << from.first << "," << from.second << ") -> (" << to.first << "," << to.second << ")" << std::endl;
-                    std::cout << "[STATE] Delta: (" << (to.first - from.first) << "," << (to.second - from.second) << ")" << std::endl;
+                    KFC_LOG("[STATE] Attempted move: (" << from.first << "," << from.second << ") -> (" << to.first << "," << to.second << ")");
+                    KFC_LOG("[STATE] Delta: (" << (to.first - from.first) << "," << (to.second - from.second) << ")");
                 }
                 if(valid) {
                     next->reset(cmd);
                     return next;
                 }
                 // Invalid move - stay in current state
-                std::cout << "[STATE] Invalid move, staying in current state" << std::endl;
+                KFC_LOG("[STATE] Invalid move, staying in current state");
                 return shared_from_this();
             } else if(next) {
                 next->reset(cmd);
                 return next;
             }
         } else {
-            std::cout << "[STATE] No transition found for: " << key << std::endl;
+            KFC_LOG("[STATE] No transition found for: " << key);
         }
         return shared_from_this();
     }
 
     std::shared_ptr<State> update(int now_ms, Cell2Pieces& c) {
-        auto internal = physics->update(now_ms);
+        const Command *internal = physics->update(now_ms);
         if(internal) {
             return on_command(*internal,c);
         }
@@ -0,0 +1,247 @@
+#include "Tracer.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+struct TraceEvent
+{
+    char ph;         // 'X' complete, 'i' instant, 'M' metadata (thread name)
+    const char *cat; // static string
+    std::string name;
+    uint64_t ts_us;
+    uint64_t dur_us;
+    uint32_t tid;
+};
+
+// One per emitting thread.  The owner appends under an uncontended lock;
+// the flusher swaps the vector out.
+struct ThreadBuffer
+{
+    std::mutex mtx;
+    std::vector<TraceEvent> events;
+    uint32_t tid{0};
+};
+
+struct TraceState
+{
+    std::mutex mtx; // registry, tracks, file
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::unordered_map<std::string, uint32_t> tracks;
+    uint32_t next_tid{1};
+    uint32_t next_track{1000};
+    std::ofstream out;
+    bool first_event{true};
+
+    std::thread flusher;
+    std::mutex wake_mtx;
+    std::condition_variable wake;
+    bool stopping{false};
+
+    clock_type::time_point origin{clock_type::now()};
+};
+
+TraceState &state()
+{
+    static TraceState s;
+    return s;
+}
+
+ThreadBuffer &local_buffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buf = []
+    {
+        auto b = std::make_shared<ThreadBuffer>();
+        b->events.reserve(1024);
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mtx);
+        b->tid = s.next_tid++;
+        s.buffers.push_back(b);
+        return b;
+    }();
+    return *buf;
+}
+
+void push(TraceEvent e)
+{
+    ThreadBuffer &b = local_buffer();
+    if (e.tid == 0)
+        e.tid = b.tid;
+    std::lock_guard<std::mutex> lock(b.mtx);
+    b.events.push_back(std::move(e));
+}
+
+void write_escaped(std::ostream &os, const std::string &s)
+{
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            os << ' ';
+        else
+            os << c;
+    }
+}
+
+// Caller holds state().mtx
+void write_events(TraceState &s, const std::vector<TraceEvent> &events)
+{
+    for (const auto &e : events)
+    {
+        s.out << (s.first_event ? "\n" : ",\n");
+        s.first_event = false;
+        if (e.ph == 'M')
+        {
+            s.out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << e.tid << R"(,"args":{"name":")";
+            write_escaped(s.out, e.name);
+            s.out << "\"}}";
+            continue;
+        }
+        s.out << "{\"name\":\"";
+        write_escaped(s.out, e.name);
+        s.out << "\",\"cat\":\"" << e.cat << "\",\"ph\":\"" << e.ph << "\",\"ts\":" << e.ts_us;
+        if (e.ph == 'X')
+            s.out << ",\"dur\":" << e.dur_us;
+        else
+            s.out << ",\"s\":\"t\"";
+        s.out << ",\"pid\":1,\"tid\":" << e.tid << "}";
+    }
+}
+
+void flush_all(TraceState &s)
+{
+    std::vector<TraceEvent> batch;
+    std::lock_guard<std::mutex> lock(s.mtx);
+    for (auto &b : s.buffers)
+    {
+        {
+            std::lock_guard<std::mutex> bl(b->mtx);
+            batch.swap(b->events);
+            b->events.reserve(batch.capacity());
+        }
+        write_events(s, batch);
+        batch.clear();
+    }
+    s.out.flush();
+}
+
+void flusher_loop()
+{
+    auto &s = state();
+    std::unique_lock<std::mutex> lock(s.wake_mtx);
+    while (!s.stopping)
+    {
+        s.wake.wait_for(lock, std::chrono::milliseconds(50));
+        lock.unlock();
+        flush_all(s);
+        lock.lock();
+    }
+}
+} // namespace
+
+void trace_start(const std::string &path)
+{
+    trace_stop();
+    auto &s = state();
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.out.open(path, std::ios::trunc);
+        if (!s.out)
+            throw std::runtime_error("Cannot create trace file " + path);
+        s.out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        s.first_event = true;
+        // Tracks outlive a session; name them again in the new file
+        std::vector<TraceEvent> names;
+        for (const auto &t : s.tracks)
+            names.push_back(TraceEvent{'M', "", t.first, 0, 0, t.second});
+        write_events(s, names);
+        // Drop whatever a previous session left behind
+        for (auto &b : s.buffers)
+        {
+            std::lock_guard<std::mutex> bl(b->mtx);
+            b->events.clear();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(s.wake_mtx);
+        s.stopping = false;
+    }
+    s.flusher = std::thread(flusher_loop);
+    trace_detail::g_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+void trace_stop()
+{
+    auto &s = state();
+    if (!s.flusher.joinable())
+        return;
+    trace_detail::g_trace_enabled.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(s.wake_mtx);
+        s.stopping = true;
+    }
+    s.wake.notify_all();
+    s.flusher.join();
+    flush_all(s);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    s.out << "\n]}\n";
+    s.out.close();
+}
+
+uint64_t trace_us(clock_type::time_point t)
+{
+    auto d = t - state().origin;
+    return d.count() < 0 ? 0 : static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+}
+
+uint64_t trace_now_us() { return trace_us(clock_type::now()); }
+
+void trace_thread_name(const std::string &name)
+{
+    if (trace_enabled())
+        push(TraceEvent{'M', "", name, 0, 0, 0});
+}
+
+uint32_t trace_track(const std::string &name)
+{
+    auto &s = state();
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        auto it = s.tracks.find(name);
+        if (it != s.tracks.end())
+            return it->second;
+        id = s.next_track++;
+        s.tracks.emplace(name, id);
+    }
+    push(TraceEvent{'M', "", name, 0, 0, id});
+    return id;
+}
+
+void trace_complete(const char *cat, const std::string &name, uint64_t start_us, uint64_t dur_us)
+{
+    if (trace_enabled())
+        push(TraceEvent{'X', cat, name, start_us, dur_us, 0});
+}
+
+void trace_complete_on(uint32_t track, const char *cat, const std::string &name, uint64_t start_us, uint64_t dur_us)
+{
+    if (trace_enabled())
+        push(TraceEvent{'X', cat, name, start_us, dur_us, track});
+}
+
+void trace_instant(const char *cat, const std::string &name)
+{
+    if (trace_enabled())
+        push(TraceEvent{'i', cat, name, trace_now_us(), 0, 0});
+}
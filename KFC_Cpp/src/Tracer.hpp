@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Chrome / Perfetto trace-event export (chrome://tracing, ui.perfetto.dev).
+//
+// Events go to a buffer owned by the emitting thread; a background thread
+// swaps the buffers out and writes them every few tens of milliseconds, so
+// the game loop never touches the file.  While no trace is running every
+// entry point is a single relaxed load.
+//
+// Pieces get their own named track ("thread") so each piece shows as a row
+// of state spans: idle -> move -> long_rest -> idle ...
+// ---------------------------------------------------------------------------
+namespace trace_detail
+{
+inline std::atomic<bool> g_trace_enabled{false};
+}
+
+inline bool trace_enabled() { return trace_detail::g_trace_enabled.load(std::memory_order_relaxed); }
+
+// Start writing a trace to path; replaces a running trace.  Throws if the
+// file cannot be created.
+void trace_start(const std::string &path);
+// Flush every buffer and close the file
+void trace_stop();
+
+// Microseconds on the trace clock
+uint64_t trace_now_us();
+uint64_t trace_us(std::chrono::steady_clock::time_point t);
+
+// Name the calling thread's track
+void trace_thread_name(const std::string &name);
+// Track id for a named pseudo-thread (a piece); created on first use
+uint32_t trace_track(const std::string &name);
+
+// Complete event on the calling thread's track
+void trace_complete(const char *cat, const std::string &name, uint64_t start_us, uint64_t dur_us);
+// Complete event on a pseudo-thread track
+void trace_complete_on(uint32_t track, const char *cat, const std::string &name, uint64_t start_us, uint64_t dur_us);
+void trace_instant(const char *cat, const std::string &name);
+
+// Complete event covering the enclosing block
+class TraceScope
+{
+public:
+    TraceScope(const char *cat, const char *name) : cat(cat), name(name), on(trace_enabled())
+    {
+        if (on)
+            start = trace_now_us();
+    }
+    ~TraceScope()
+    {
+        if (on)
+            trace_complete(cat, name, start, trace_now_us() - start);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *cat;
+    const char *name;
+    bool on;
+    uint64_t start{0};
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Img.hpp"
+
+// Where exported frames go: a video file, an image sequence, a test.
+// write() gets frames numbered from 0; a sink that is not concurrent()
+// gets them one at a time and in order.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    // Throws on an encoding or I/O error; the export stops with it
+    virtual void write(const Img& frame, int index) = 0;
+    // May write() run on several threads at once, frames out of order
+    virtual bool concurrent() const { return false; }
+    // After the last frame
+    virtual void finish() {}
+};
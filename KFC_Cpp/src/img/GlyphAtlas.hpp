@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Text drawn from pre-rasterized glyphs.  Each glyph a string needs is
+// rasterized once per font size (by whatever library the image kind uses)
+// into an 8 bit coverage atlas; a laid-out string is cached as a list of
+// atlas rectangles, so drawing a string that did not change is a string
+// lookup plus one alpha blend per covered pixel.
+//
+// No image library here: the atlas blends into any 8 bit, 3 or 4 channel
+// pixel buffer, and the rasterizer is a callback.
+// ---------------------------------------------------------------------------
+struct GlyphBitmap
+{
+    int width{0}, height{0};
+    int top{0};     // rows from the bitmap top to the baseline
+    int advance{0}; // pen movement after the glyph
+    std::vector<uint8_t> coverage; // width*height, 0..255
+};
+
+class GlyphAtlas
+{
+public:
+    using Rasterizer = std::function<GlyphBitmap(char c, double font_size)>;
+
+    struct Quad
+    {
+        int src_x, src_y; // in the atlas
+        int w, h;
+        int dx, dy;       // from the pen origin (baseline)
+    };
+    struct TextRun
+    {
+        std::vector<Quad> quads;
+        int width{0};
+    };
+
+    explicit GlyphAtlas(Rasterizer rasterize, int atlas_width = 512)
+        : rasterize(std::move(rasterize)), atlas_w(atlas_width) {}
+
+    // Lay out txt at font_size, once: later calls with the same text return
+    // the cached run.  The run stays valid until the next layout() call.
+    const TextRun &layout(const std::string &txt, double font_size)
+    {
+        int size_key = static_cast<int>(std::lround(font_size * 100));
+        Font &font = fonts[size_key];
+        auto it = font.runs.find(txt);
+        if (it != font.runs.end())
+            return it->second;
+        if (font.runs.size() >= kMaxRuns)
+            font.runs.clear(); // changing text (timers) must not grow it forever
+
+        TextRun run;
+        int pen = 0;
+        for (char c : txt)
+        {
+            const Glyph &g = glyph(font, c, font_size);
+            if (g.w > 0 && g.h > 0)
+                run.quads.push_back(Quad{g.x, g.y, g.w, g.h, pen + g.left, -g.top});
+            pen += g.advance;
+        }
+        run.width = pen;
+        return font.runs.emplace(txt, std::move(run)).first->second;
+    }
+
+    // Blend run into a pixel buffer with its baseline starting at (x, y),
+    // clipped to the buffer.  color has one byte per channel (BGR[A]); the
+    // alpha channel, if any, is made opaque where text covers it.
+    void draw(const TextRun &run, uint8_t *pixels, int width, int height, size_t stride, int channels,
+              int x, int y, const uint8_t *color) const
+    {
+        for (const Quad &q : run.quads)
+        {
+            int x0 = x + q.dx, y0 = y + q.dy;
+            int cx0 = std::max(0, -x0), cy0 = std::max(0, -y0);
+            int cx1 = std::min(q.w, width - x0), cy1 = std::min(q.h, height - y0);
+            for (int r = cy0; r < cy1; ++r)
+            {
+                const uint8_t *src = &atlas[static_cast<size_t>(q.src_y + r) * atlas_w + q.src_x];
+                uint8_t *dst = pixels + static_cast<size_t>(y0 + r) * stride + static_cast<size_t>(x0) * channels;
+                for (int c = cx0; c < cx1; ++c)
+                {
+                    unsigned a = src[c];
+                    if (a == 0)
+                        continue;
+                    uint8_t *px = dst + static_cast<size_t>(c) * channels;
+                    for (int k = 0; k < std::min(channels, 3); ++k)
+                        px[k] = static_cast<uint8_t>((color[k] * a + px[k] * (255 - a) + 127) / 255);
+                    if (channels == 4)
+                        px[3] = std::max(px[3], static_cast<uint8_t>(a));
+                }
+            }
+        }
+    }
+
+    // --- statistics ---
+    size_t glyphs_rasterized() const { return rasterized; }
+    size_t cached_runs() const
+    {
+        size_t n = 0;
+        for (const auto &f : fonts)
+            n += f.second.runs.size();
+        return n;
+    }
+    int atlas_height() const { return static_cast<int>(atlas.size() / static_cast<size_t>(atlas_w)); }
+
+private:
+    static constexpr size_t kMaxRuns = 1024; // per font size
+
+    struct Glyph
+    {
+        bool ready{false};
+        int x{0}, y{0}, w{0}, h{0};
+        int left{0}, top{0}, advance{0}; // box offset from the pen, baseline
+    };
+    // One font size
+    struct Font
+    {
+        std::array<Glyph, 256> glyphs;
+        std::unordered_map<std::string, TextRun> runs;
+    };
+
+    const Glyph &glyph(Font &font, char c, double font_size)
+    {
+        Glyph &g = font.glyphs[static_cast<uint8_t>(c)];
+        if (g.ready)
+            return g;
+        GlyphBitmap bmp = rasterize(c, font_size);
+        ++rasterized;
+        g.ready = true;
+        g.advance = bmp.advance;
+        if (bmp.width <= 0 || bmp.height <= 0 || bmp.coverage.size() < static_cast<size_t>(bmp.width) * bmp.height)
+            return g;
+        // Keep only the covered box: blank margins would cost a test per
+        // pixel on every draw
+        int x0 = bmp.width, y0 = bmp.height, x1 = -1, y1 = -1;
+        for (int r = 0; r < bmp.height; ++r)
+            for (int c = 0; c < bmp.width; ++c)
+                if (bmp.coverage[static_cast<size_t>(r) * bmp.width + c])
+                {
+                    x0 = std::min(x0, c);
+                    x1 = std::max(x1, c);
+                    y0 = std::min(y0, r);
+                    y1 = std::max(y1, r);
+                }
+        if (x1 < 0)
+            return g; // nothing covered
+        g.left = x0;
+        g.top = bmp.top - y0;
+        g.w = std::min(x1 - x0 + 1, atlas_w);
+        g.h = y1 - y0 + 1;
+        place(g);
+        for (int r = 0; r < g.h; ++r)
+            std::copy_n(&bmp.coverage[static_cast<size_t>(y0 + r) * bmp.width + x0], g.w,
+                        &atlas[static_cast<size_t>(g.y + r) * atlas_w + g.x]);
+        return g;
+    }
+
+    // Shelf packing: left to right, a new shelf when the row is full
+    void place(Glyph &g)
+    {
+        if (shelf_x + g.w > atlas_w)
+        {
+            shelf_y += shelf_h;
+            shelf_x = shelf_h = 0;
+        }
+        g.x = shelf_x;
+        g.y = shelf_y;
+        shelf_x += g.w + 1;
+        shelf_h = std::max(shelf_h, g.h + 1);
+        size_t rows_needed = static_cast<size_t>(shelf_y + shelf_h);
+        if (atlas.size() < rows_needed * atlas_w)
+            atlas.resize(rows_needed * atlas_w, 0);
+    }
+
+    Rasterizer rasterize;
+    int atlas_w;
+    std::vector<uint8_t> atlas; // atlas_w wide, grows downwards
+    int shelf_x{0}, shelf_y{0}, shelf_h{0};
+    std::unordered_map<int, Font> fonts; // by font_size * 100
+    size_t rasterized{0};
+};
@@ -20,6 +20,13 @@ public:
     virtual void put_text(const std::string& /*txt*/, int /*x*/, int /*y*/, double /*font_size*/) {}
     virtual void show() const {}
     virtual ImgPtr clone() const = 0;
+    // Copy this image into dst, reusing dst's buffer when the sizes match.
+    // Returns false when dst is not an image of the same kind.
+    virtual bool copy_to(Img& /*dst*/) const { return false; }
+    // A copy scaled to width x height (area averaging when shrinking), or
+    // nullptr when the image kind cannot scale.  Meant for load time, not
+    // for every frame.
+    virtual ImgPtr resized(int /*width*/, int /*height*/) const { return nullptr; }
 
     virtual void draw_rect(int x, int y, int width, int height, const std::vector<uint8_t> & color) = 0;
 };
\ No newline at end of file
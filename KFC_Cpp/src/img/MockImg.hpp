@@ -14,7 +14,9 @@ public:
     void draw_on(Img&, int, int) override {}
     void put_text(const std::string&, int, int, double) override {}
     void show() const override {}
-    ImgPtr clone() const override { return std::make_shared<MockImg>(); }
+    ImgPtr clone() const override { return std::make_shared<MockImg>(_size); }
+    bool copy_to(Img& dst) const override { return dynamic_cast<MockImg*>(&dst) != nullptr; }
+    ImgPtr resized(int width, int height) const override { return std::make_shared<MockImg>(std::make_pair(width, height)); }
     void draw_rect(int x, int y, int width, int height, const std::vector<uint8_t>& color) override {};
 
 };
@@ -1,13 +1,50 @@
 #include "OpenCvImg.hpp"
+#include "../Log.hpp"
+#include "GlyphAtlas.hpp"
 
 
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include <functional>
+#include <mutex>
+#include <cstdio>
+#include <filesystem>
 
-// פונקציה גלובלית לטיפול במקשים
-std::function<void(int)> global_key_handler = nullptr;
+namespace {
+const char* const kWindowName = "KFC Game - Click here and use keyboard!";
+
+// Hershey glyphs, rasterized anti-aliased one at a time for the atlas
+GlyphBitmap rasterize_hershey(char c, double font_size) {
+	GlyphBitmap g;
+	std::string s(1, c);
+	int baseline = 0;
+	cv::Size sz = cv::getTextSize(s, cv::FONT_HERSHEY_SIMPLEX, font_size, 1, &baseline);
+	g.advance = sz.width;
+	if (c == ' ') return g;
+	const int pad = 1; // anti-aliasing bleeds past the box
+	g.width = sz.width + 2 * pad;
+	g.height = sz.height + baseline + 2 * pad;
+	g.top = sz.height + pad;
+	cv::Mat mask(g.height, g.width, CV_8UC1, cv::Scalar(0));
+	cv::putText(mask, s, cv::Point(pad, g.top), cv::FONT_HERSHEY_SIMPLEX, font_size, cv::Scalar(255), 1, cv::LINE_AA);
+	g.coverage.resize(static_cast<size_t>(g.width) * g.height);
+	for (int r = 0; r < g.height; ++r)
+		std::copy_n(mask.ptr(r), g.width, &g.coverage[static_cast<size_t>(r) * g.width]);
+	return g;
+}
+
+// One atlas for every image; the renderer and the exporter may both draw
+struct TextCache {
+	std::mutex mutex;
+	GlyphAtlas atlas{rasterize_hershey};
+};
+TextCache& text_cache() {
+	static TextCache cache;
+	return cache;
+}
+}
 
 struct OpenCvImg::Impl {
 	cv::Mat mat;
@@ -22,6 +59,24 @@ ImgPtr OpenCvImg::clone() const
 	return res;
 }
 
+bool OpenCvImg::copy_to(Img& dst) const
+{
+	auto* other = dynamic_cast<OpenCvImg*>(&dst);
+	if (!other) return false;
+	impl->mat.copyTo(other->impl->mat); // reallocates only on a size change
+	return true;
+}
+
+ImgPtr OpenCvImg::resized(int width, int height) const
+{
+	auto res = std::make_shared<OpenCvImg>();
+	if (impl->mat.empty() || width <= 0 || height <= 0) return res;
+	bool shrink = width < impl->mat.cols || height < impl->mat.rows;
+	cv::resize(impl->mat, res->impl->mat, cv::Size(width, height), 0, 0,
+		shrink ? cv::INTER_AREA : cv::INTER_LINEAR);
+	return res;
+}
+
 void OpenCvImg::read(const std::string& path, const std::pair<int, int>& size) {
 	impl->mat = cv::imread(path, cv::IMREAD_UNCHANGED);
 	if (impl->mat.empty()) throw std::runtime_error("Cannot load image: " + path);
@@ -64,31 +119,38 @@ void OpenCvImg::draw_on(Img& dst, int x, int y) {
 }
 
 void OpenCvImg::put_text(const std::string& txt, int x, int y, double font_size) {
-	if (impl->mat.empty()) return;
-	cv::putText(impl->mat, txt, cv::Point(x, y), cv::FONT_HERSHEY_SIMPLEX, font_size, cv::Scalar(255, 255, 255, 255));
+	if (impl->mat.empty() || impl->mat.depth() != CV_8U) return;
+	// Glyphs come from the atlas instead of cv::putText: a line of HUD
+	// text is a cached layout and a blend, not a vector font render
+	static const uint8_t white[4] = {255, 255, 255, 255};
+	auto& cache = text_cache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	const auto& run = cache.atlas.layout(txt, font_size);
+	cv::Mat& m = impl->mat;
+	cache.atlas.draw(run, m.ptr(0), m.cols, m.rows, m.step, m.channels(), x, y, white);
 }
 
 void OpenCvImg::show() const {
     if (impl->mat.empty()) {
-        std::cout << "[DEBUG] OpenCvImg::show() - mat is empty!" << std::endl;
+        KFC_LOG("[DEBUG] OpenCvImg::show() - mat is empty!");
         return;
     }
     
     static bool first_show = true;
     if (first_show) {
-        std::cout << "[DEBUG] First time showing window - size: " << impl->mat.cols << "x" << impl->mat.rows << std::endl;
-        cv::namedWindow("KFC Game - Click here and use keyboard!", cv::WINDOW_AUTOSIZE);
+        KFC_LOG("[DEBUG] First time showing window - size: " << impl->mat.cols << "x" << impl->mat.rows);
+        cv::namedWindow(kWindowName, cv::WINDOW_AUTOSIZE);
+        // HighGUI delivers the window's events to this thread only: the
+        // game loop reads them here between frames, never an InputPump
+        set_window_key_poller([] { return cv::pollKey(); }, /*owner_thread*/ true);
         first_show = false;
     }
     
-    cv::imshow("KFC Game - Click here and use keyboard!", impl->mat);
-    
+    cv::imshow(kWindowName, impl->mat);
     int key = cv::waitKey(1);
     if (key != -1 && key != 255) {
-        std::cout << "[DEBUG] Key detected: " << key << std::endl;
-        if (global_key_handler) {
-            global_key_handler(key);
-        }
+        KFC_LOG("[DEBUG] Key detected: " << key);
+        dispatch_key(key);
     }
 }
 void OpenCvImg::draw_rect(int x, int y, int width, int height, const std::vector<uint8_t> & color) {
@@ -97,7 +159,60 @@ void OpenCvImg::draw_rect(int x, int y, int width, int height, const std::vector
 	cv::rectangle(impl->mat, cv::Rect(x, y, width, height), cvColor, 2);
 }
 
-// פונקציה להגדרת handler למקשים
-void set_global_key_handler(std::function<void(int)> handler) {
-	global_key_handler = handler;
-}
\ No newline at end of file
+
+// ---------------------------------------------------------------------------
+// Frame sinks for the offline renderer
+// ---------------------------------------------------------------------------
+PngSequenceSink::PngSequenceSink(std::string dir_, std::string prefix_)
+	: dir(std::move(dir_)), prefix(std::move(prefix_)) {
+	std::filesystem::create_directories(dir);
+}
+
+void PngSequenceSink::write(const Img& frame, int index) {
+	auto* img = dynamic_cast<const OpenCvImg*>(&frame);
+	if (!img || img->impl->mat.empty()) throw std::runtime_error("PngSequenceSink needs OpenCV frames");
+	char name[32];
+	std::snprintf(name, sizeof name, "%06d.png", index);
+	std::string path = (std::filesystem::path(dir) / (prefix + name)).string();
+	if (!cv::imwrite(path, img->impl->mat)) throw std::runtime_error("Cannot write frame: " + path);
+}
+
+struct VideoFileSink::Impl {
+	std::string path;
+	double fps;
+	std::string fourcc;
+	cv::VideoWriter writer;
+	cv::Mat bgr; // frames are BGRA; video wants BGR
+};
+
+VideoFileSink::VideoFileSink(std::string path, double fps, std::string fourcc)
+	: impl(std::make_unique<Impl>()) {
+	if (fourcc.size() != 4) throw std::invalid_argument("fourcc must be 4 characters: " + fourcc);
+	impl->path = std::move(path);
+	impl->fps = fps;
+	impl->fourcc = std::move(fourcc);
+}
+
+VideoFileSink::~VideoFileSink() = default;
+
+void VideoFileSink::write(const Img& frame, int /*index*/) {
+	auto* img = dynamic_cast<const OpenCvImg*>(&frame);
+	if (!img || img->impl->mat.empty()) throw std::runtime_error("VideoFileSink needs OpenCV frames");
+	const cv::Mat& mat = img->impl->mat;
+	if (!impl->writer.isOpened()) {
+		const std::string& f = impl->fourcc;
+		if (!impl->writer.open(impl->path, cv::VideoWriter::fourcc(f[0], f[1], f[2], f[3]), impl->fps,
+							   cv::Size(mat.cols, mat.rows), true))
+			throw std::runtime_error("Cannot open video for writing: " + impl->path);
+	}
+	if (mat.channels() == 4) {
+		cv::cvtColor(mat, impl->bgr, cv::COLOR_BGRA2BGR);
+		impl->writer.write(impl->bgr);
+	} else {
+		impl->writer.write(mat);
+	}
+}
+
+void VideoFileSink::finish() {
+	impl->writer.release();
+}
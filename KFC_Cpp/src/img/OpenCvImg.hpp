@@ -2,13 +2,11 @@
 
 #include "Img.hpp"
 #include "ImgFactory.hpp"
+#include "FrameSink.hpp"
 #include <memory>
 #include <string>
 #include <utility>
-#include <functional>
-
-// פונקציה גלובלית להגדרת handler למקשים
-void set_global_key_handler(std::function<void(int)> handler);
+#include "../KeyInput.hpp" // show() reads keys and dispatches them
 
 class OpenCvImg : public Img {
 public:
@@ -23,6 +21,8 @@ public:
     void put_text(const std::string& txt, int x, int y, double font_size) override;
     void show() const override;
     ImgPtr clone() const override;
+    bool copy_to(Img& dst) const override;
+    ImgPtr resized(int width, int height) const override;
 
     void create_blank(int width, int height);
 
@@ -31,10 +31,39 @@ public:
 
 
 private:
+    friend class PngSequenceSink;
+    friend class VideoFileSink;
     struct Impl;
     std::unique_ptr<Impl> impl;
 }; 
 
+// <dir>/frame_000000.png, ... one file per frame; files are independent, so
+// several encoder threads may write at once
+class PngSequenceSink : public FrameSink {
+public:
+    explicit PngSequenceSink(std::string dir, std::string prefix = "frame_");
+    void write(const Img& frame, int index) override;
+    bool concurrent() const override { return true; }
+
+private:
+    std::string dir;
+    std::string prefix;
+};
+
+// One video file through cv::VideoWriter (codec by fourcc, "mp4v" for
+// .mp4, "MJPG" for .avi); opened on the first frame, which fixes the size
+class VideoFileSink : public FrameSink {
+public:
+    VideoFileSink(std::string path, double fps, std::string fourcc = "mp4v");
+    ~VideoFileSink() override;
+    void write(const Img& frame, int index) override;
+    void finish() override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
 class OpenCvImgFactory : public ImgFactory {
 public:
     ImgPtr create_blank(int width, int height) const override {
@@ -1,15 +1,147 @@
 #include <iostream>
 #include "Game.hpp"
+#include "LayoutGenerator.hpp"
+#include "Replay.hpp"
+#include "ReplayExport.hpp"
+#include "Tracer.hpp"
 #include "img/OpenCvImg.hpp"
+#include "img/MockImg.hpp"
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <string>
 
-int main()
+// Usage:
+//   KungFuChess                    play
+//   KungFuChess --journal <file>   play and record a command journal
+//   KungFuChess --replay <file>    replay a journal at full speed (no window)
+//   KungFuChess --trace <file>     also write a Chrome/Perfetto trace (JSON)
+//   KungFuChess --input-hz <n>     key polls per second (0: once per frame)
+//   KungFuChess --fps <n>          target frame rate (default 60)
+//   KungFuChess --layout <file>    play the board.csv style layout in file,
+//                                  at its size
+//   KungFuChess --generate 64x64:2000[:seed]
+//                                  play a generated layout (LayoutGenerator)
+//   KungFuChess --replay <file> --export <out.mp4|out.avi|dir>
+//                                  render the replay to a video or a PNG
+//                                  sequence at --fps (default 30), encoding
+//                                  on --threads threads
+int main(int argc, char **argv)
 {
+	std::string journal_path;
+	std::string replay_path;
+	std::string trace_path;
+	std::string export_path;
+	std::string layout_path;
+	std::string generate_spec;
+	int export_threads = 0;
+	int input_hz = -1;
+	double fps = 0;
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--journal")
+			journal_path = argv[++i];
+		else if (arg == "--replay")
+			replay_path = argv[++i];
+		else if (arg == "--trace")
+			trace_path = argv[++i];
+		else if (arg == "--input-hz")
+			input_hz = std::stoi(argv[++i]);
+		else if (arg == "--fps")
+			fps = std::stod(argv[++i]);
+		else if (arg == "--export")
+			export_path = argv[++i];
+		else if (arg == "--threads")
+			export_threads = std::stoi(argv[++i]);
+		else if (arg == "--layout")
+			layout_path = argv[++i];
+		else if (arg == "--generate")
+			generate_spec = argv[++i];
+	}
+
+	std::string pieces_root = "../../pieces/"; // project root containing assets
+	if (!trace_path.empty())
+		trace_start(trace_path);
+
+	if (!replay_path.empty() && !export_path.empty())
+	{
+		set_log_enabled(false);
+		JournalReader reader(replay_path);
+		auto game = create_replay_game(reader, pieces_root, std::make_shared<OpenCvImgFactory>());
+		ExportOptions opts;
+		if (fps > 0)
+			opts.fps = fps;
+		opts.encode_threads = export_threads;
+		auto ends_with = [&](const char *ext)
+		{
+			std::string e(ext);
+			return export_path.size() >= e.size() && export_path.compare(export_path.size() - e.size(), e.size(), e) == 0;
+		};
+		std::unique_ptr<FrameSink> sink;
+		if (ends_with(".mp4"))
+			sink = std::make_unique<VideoFileSink>(export_path, opts.fps, "mp4v");
+		else if (ends_with(".avi"))
+			sink = std::make_unique<VideoFileSink>(export_path, opts.fps, "MJPG");
+		else
+			sink = std::make_unique<PngSequenceSink>(export_path);
+		ExportStats stats = export_replay(game, reader, *sink, opts);
+		std::cout << "Exported " << stats.frames << " frames (" << stats.video_ms << " ms of video) in "
+				  << stats.wall_ms << " ms, " << stats.speedup() << "x real time (render " << stats.render_ms
+				  << " ms, encode " << stats.encode_ms << " ms over all threads)" << std::endl;
+		trace_stop();
+		return 0;
+	}
+
+	if (!replay_path.empty())
+	{
+		set_log_enabled(false);
+		JournalReader reader(replay_path);
+		auto game = create_replay_game(reader, pieces_root, std::make_shared<MockImgFactory>());
+		ReplayStats stats = replay_journal(game, reader);
+		std::cout << "Replayed " << stats.ticks << " ticks / " << stats.commands << " commands ("
+				  << stats.final_ms << " ms of game time) in " << stats.wall_ms << " ms" << std::endl;
+		trace_stop();
+		for (const auto &p : game.pieces)
+		{
+			auto cell = p->current_cell();
+			std::cout << p->id << " " << p->state->name << " (" << cell.first << "," << cell.second << ")" << std::endl;
+		}
+		return 0;
+	}
+
+	// The layout to play; empty for <pieces_root>/board.csv
+	std::string layout_csv;
+	if (!layout_path.empty())
+	{
+		std::ifstream in(layout_path);
+		if (!in)
+		{
+			std::cerr << "Cannot open layout " << layout_path << std::endl;
+			return 1;
+		}
+		std::stringstream buf;
+		buf << in.rdbuf();
+		layout_csv = buf.str();
+	}
+	else if (!generate_spec.empty())
+		layout_csv = LayoutSpec::parse(generate_spec).csv();
+
 	std::cout << "Starting KFC_Cpp Game..." << std::endl;
 	auto img_factory = std::make_shared<OpenCvImgFactory>();
-	std::string pieces_root = "../../pieces/"; // project root containing assets
-	auto game = create_game(pieces_root, img_factory);
+	std::istringstream layout_in(layout_csv);
+	auto game = layout_csv.empty() ? create_game(pieces_root, img_factory)
+								   : create_game(layout_in, pieces_root, img_factory);
+	if (!journal_path.empty())
+		game.set_journal(layout_csv.empty() ? create_journal(journal_path, pieces_root)
+											: std::make_shared<CommandJournal>(journal_path, layout_csv,
+																			   hash_piece_assets(pieces_root)));
+	if (input_hz >= 0)
+		game.input_poll_hz = input_hz;
+	if (fps > 0)
+		game.pacer.set_rate(fps);
 
 	game.run();
+	trace_stop();
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../Command.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <utility>
+
+// ---------------------------------------------------------------------------
+// One peer's end of a command link in a two-player remote match.  Commands
+// are delivered in the order they were sent; time is the caller's game time
+// so links can run under a virtual clock.
+// ---------------------------------------------------------------------------
+class CommandTransport
+{
+public:
+    virtual ~CommandTransport() = default;
+    virtual void send(const Command &cmd, int now_ms) = 0;
+    // Next command that has arrived by now_ms, if any
+    virtual bool poll(int now_ms, Command &out) = 0;
+};
+
+// ---------------------------------------------------------------------------
+// In-process link with simulated one-way latency and jitter, for testing two
+// peers on one machine.  Delivery stays in order like a TCP stream: a late
+// packet holds back the ones behind it.
+// ---------------------------------------------------------------------------
+class LoopbackLink
+{
+public:
+    LoopbackLink(int latency_ms, int jitter_ms = 0, uint32_t seed = 1)
+        : latency_ms(latency_ms), jitter_ms(jitter_ms), rng(seed)
+    {
+        ends[0].link = this;
+        ends[0].side = 0;
+        ends[1].link = this;
+        ends[1].side = 1;
+    }
+
+    LoopbackLink(const LoopbackLink &) = delete;
+    LoopbackLink &operator=(const LoopbackLink &) = delete;
+
+    CommandTransport &end(int side) { return ends[side]; }
+
+    // Nothing left in flight in either direction
+    bool idle() const { return lanes[0].empty() && lanes[1].empty(); }
+
+private:
+    struct Lane
+    {
+        std::deque<std::pair<int, Command>> in_flight; // (deliver at, command)
+        int last_delivery{0};
+        bool empty() const { return in_flight.empty(); }
+    };
+
+    class End : public CommandTransport
+    {
+    public:
+        void send(const Command &cmd, int now_ms) override { link->push(1 - side, cmd, now_ms); }
+        bool poll(int now_ms, Command &out) override { return link->pop(side, now_ms, out); }
+
+        LoopbackLink *link{nullptr};
+        int side{0};
+    };
+
+    void push(int to, const Command &cmd, int now_ms)
+    {
+        int jitter = jitter_ms > 0 ? std::uniform_int_distribution<int>(0, jitter_ms)(rng) : 0;
+        Lane &lane = lanes[to];
+        lane.last_delivery = std::max(lane.last_delivery, now_ms + latency_ms + jitter);
+        lane.in_flight.emplace_back(lane.last_delivery, cmd);
+    }
+
+    bool pop(int side, int now_ms, Command &out)
+    {
+        Lane &lane = lanes[side];
+        if (lane.in_flight.empty() || lane.in_flight.front().first > now_ms)
+            return false;
+        out = std::move(lane.in_flight.front().second);
+        lane.in_flight.pop_front();
+        return true;
+    }
+
+    int latency_ms;
+    int jitter_ms;
+    std::mt19937 rng;
+    Lane lanes[2];
+    End ends[2];
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Protocol.hpp"
+#include "../Game.hpp"
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// ---------------------------------------------------------------------------
+// Authoritative wrapper around one headless Game.  Remote players never send
+// piece ids: they name a source cell, and the match checks that the piece
+// standing there is theirs, is free to act and that the move is legal before
+// the command reaches the simulation.
+// ---------------------------------------------------------------------------
+class Match
+{
+public:
+    explicit Match(std::unique_ptr<Game> g, int start_ms = 0) : game_(std::move(g))
+    {
+        game_->reset_pieces(start_ms);
+    }
+
+    Game &game() { return *game_; }
+    const Game &game() const { return *game_; }
+
+    bool over() const { return game_->is_win(); }
+
+    // 1 = white won, 2 = black won, 0 = still running
+    int winner() const
+    {
+        if (!over())
+            return 0;
+        for (const auto &p : game_->pieces)
+            if (p->id.rfind("KW", 0) == 0)
+                return 1;
+        return 2;
+    }
+
+    Verdict submit(int player, const CmdMsg &msg, int now_ms)
+    {
+        if (over())
+            return Verdict::GameOver;
+        const Board &board = game_->board;
+        auto in_bounds = [&](const std::pair<int, int> &c)
+        {
+            return c.first >= 0 && c.first < board.H_cells && c.second >= 0 && c.second < board.W_cells;
+        };
+        if (!in_bounds(msg.from) || !in_bounds(msg.to))
+            return Verdict::OutOfBounds;
+
+        // The game's own cell map: a command costs the cells it looks at,
+        // not the number of pieces
+        const Cell2Pieces &cells = game_->cell_pieces();
+        auto at = cells.find(msg.from);
+        if (at == cells.end() || at->second.empty())
+            return Verdict::NoPiece;
+        const PiecePtr &piece = at->second.front();
+        if (!owned_by(*piece, player))
+            return Verdict::NotYourPiece;
+        if (!piece->state->physics->is_idle())
+            return Verdict::Busy;
+
+        if (msg.kind == CmdKind::Move)
+        {
+            const auto &moves = piece->state->moves;
+            if (moves && !moves->is_valid(msg.from, msg.to, cells, piece->state->physics->is_need_clear_path()))
+                return Verdict::IllegalMove;
+            game_->enqueue_command(Command{now_ms, piece->id, "move", {msg.from, msg.to}});
+        }
+        else if (msg.kind == CmdKind::Jump)
+        {
+            game_->enqueue_command(Command{now_ms, piece->id, "jump", {msg.from, msg.to}});
+        }
+        else
+        {
+            return Verdict::IllegalMove; // read_cmd refuses these; a local caller might not
+        }
+        return Verdict::Accepted;
+    }
+
+    void tick(int now_ms) { game_->advance(now_ms); }
+
+    static bool owned_by(const Piece &piece, int player)
+    {
+        if (piece.id.length() < 2)
+            return false;
+        return (player == 1 && piece.id[1] == 'W') || (player == 2 && piece.id[1] == 'B');
+    }
+
+private:
+    std::unique_ptr<Game> game_;
+};
+
+// board.csv and the piece assets under pieces_root, parsed once (at server
+// start); every match is then built from the cached layout.  create() may
+// be called from any thread.
+class MatchTemplate
+{
+public:
+    MatchTemplate(const std::string &pieces_root, const ImgFactoryPtr &img_factory)
+    {
+        std::ifstream in(fs::path(pieces_root) / "board.csv");
+        if (!in)
+            throw std::runtime_error("Cannot open board.csv");
+        layout = std::make_unique<GameLayout>(in, pieces_root, img_factory);
+        layout->create_pieces(); // reads every piece type the layout names
+    }
+
+    std::unique_ptr<Match> create(int start_ms = 0)
+    {
+        std::vector<PiecePtr> pieces;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pieces = layout->create_pieces();
+        }
+        return std::make_unique<Match>(std::make_unique<Game>(std::move(pieces), layout->board()), start_ms);
+    }
+
+private:
+    std::mutex mtx; // the factory caches are not thread-safe
+    std::unique_ptr<GameLayout> layout;
+};
+
+// Headless match from the assets under pieces_root
+inline std::unique_ptr<Match> create_match(const std::string &pieces_root,
+                                           const ImgFactoryPtr &img_factory,
+                                           int start_ms = 0)
+{
+    return MatchTemplate(pieces_root, img_factory).create(start_ms);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../Serialization.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Wire protocol between the match server and its clients.
+//
+//   frame : u32 payload length (LE) | u8 message type | payload
+//
+// Payload fields use the varint codec from Serialization.hpp.  Frames are
+// small (a state broadcast is a delta of a few bytes, a keyframe ~1 KiB), so the
+// length limit below is only a guard against garbage on the socket.
+// ---------------------------------------------------------------------------
+enum class MsgType : uint8_t
+{
+    Join = 1,     // C->S  varint wanted match (0 = any)
+    Joined = 2,   // S->C  varint match, u8 player, varint rows, varint cols
+    Cmd = 3,      // C->S  varint seq, u8 kind, cell from, cell to
+    Ack = 4,      // S->C  varint seq, u8 verdict, svarint server game time
+    State = 5,    // S->C  one SpectatorStream frame
+    GameOver = 6, // S->C  u8 winner (0 = draw / aborted)
+    StatsReq = 7, // C->S  (empty)
+    Stats = 8,    // S->C  see ServerStatsMsg
+};
+
+enum class CmdKind : uint8_t
+{
+    Move = 0,
+    Jump = 1,
+};
+
+// Why the authoritative side accepted or refused a command
+enum class Verdict : uint8_t
+{
+    Accepted = 0,
+    GameOver = 1,
+    NoPiece = 2,
+    NotYourPiece = 3,
+    Busy = 4, // piece is moving, jumping or resting
+    OutOfBounds = 5,
+    IllegalMove = 6,
+    NotInMatch = 7,
+};
+
+constexpr uint32_t kMaxFramePayload = 1u << 20;
+
+struct CmdMsg
+{
+    uint64_t seq{0};
+    CmdKind kind{CmdKind::Move};
+    std::pair<int, int> from{0, 0};
+    std::pair<int, int> to{0, 0};
+};
+
+struct ServerStatsMsg
+{
+    uint64_t games{0};
+    uint64_t workers{0};
+    uint64_t busy_us{0}; // summed across workers
+    uint64_t wall_us{0}; // since the server started
+    uint64_t ticks{0};
+    uint64_t commands{0};
+};
+
+// Append one framed message to out.
+inline void append_frame(std::vector<uint8_t> &out, MsgType type, const ByteWriter &payload)
+{
+    uint32_t len = static_cast<uint32_t>(payload.size() + 1);
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<uint8_t>(len >> (8 * i)));
+    out.push_back(static_cast<uint8_t>(type));
+    out.insert(out.end(), payload.data().begin(), payload.data().end());
+}
+
+inline void write_cmd(ByteWriter &w, const CmdMsg &m)
+{
+    w.varint(m.seq);
+    w.u8(static_cast<uint8_t>(m.kind));
+    w.cell(m.from);
+    w.cell(m.to);
+}
+
+// Throws on a kind this protocol does not define
+inline CmdMsg read_cmd(ByteReader &r)
+{
+    CmdMsg m;
+    m.seq = r.varint();
+    uint8_t kind = r.u8();
+    if (kind > static_cast<uint8_t>(CmdKind::Jump))
+        throw std::runtime_error("Unknown command kind");
+    m.kind = static_cast<CmdKind>(kind);
+    m.from = r.cell();
+    m.to = r.cell();
+    return m;
+}
+
+inline void write_stats(ByteWriter &w, const ServerStatsMsg &m)
+{
+    w.varint(m.games);
+    w.varint(m.workers);
+    w.varint(m.busy_us);
+    w.varint(m.wall_us);
+    w.varint(m.ticks);
+    w.varint(m.commands);
+}
+
+inline ServerStatsMsg read_stats(ByteReader &r)
+{
+    ServerStatsMsg m;
+    m.games = r.varint();
+    m.workers = r.varint();
+    m.busy_us = r.varint();
+    m.wall_us = r.varint();
+    m.ticks = r.varint();
+    m.commands = r.varint();
+    return m;
+}
+
+// ---------------------------------------------------------------------------
+// Reassembles frames from a byte stream that arrives in arbitrary pieces.
+// ---------------------------------------------------------------------------
+class FrameBuffer
+{
+public:
+    void append(const uint8_t *data, size_t n)
+    {
+        // Compact lazily, only when the consumed prefix dominates
+        if (head > 0 && head * 2 >= buf.size())
+        {
+            buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(head));
+            head = 0;
+        }
+        buf.insert(buf.end(), data, data + n);
+    }
+
+    // Pop the next complete frame; payload stays valid until the next
+    // append().  Returns false when more bytes are needed.
+    // Throws on a frame that exceeds kMaxFramePayload.
+    bool next(MsgType &type, ByteReader &payload)
+    {
+        size_t avail = buf.size() - head;
+        if (avail < 5)
+            return false;
+        const uint8_t *p = buf.data() + head;
+        uint32_t len = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                       (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        if (len == 0 || len > kMaxFramePayload)
+            throw std::runtime_error("Bad frame length");
+        if (avail < 4 + static_cast<size_t>(len))
+            return false;
+        type = static_cast<MsgType>(p[4]);
+        payload = ByteReader(p + 5, len - 1);
+        head += 4 + len;
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> buf;
+    size_t head{0};
+};
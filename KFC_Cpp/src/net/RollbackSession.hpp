@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CommandTransport.hpp"
+#include "../Game.hpp"
+#include "../Serialization.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+struct RollbackConfig
+{
+    int player{1};         // 1 = white, 2 = black; owns the pieces with that colour letter
+    int step_ms{16};       // fixed simulation step shared by both peers
+    int input_delay_ms{48}; // local commands take effect this much later
+    int window_ticks{64};  // snapshot ring: the deepest possible rollback
+};
+
+struct RollbackStats
+{
+    uint64_t ticks{0};         // ticks simulated for the first time
+    uint64_t rollbacks{0};
+    uint64_t resim_ticks{0};   // ticks simulated again
+    int max_depth_ticks{0};
+    uint64_t resim_ns{0};      // restore + re-simulation
+    uint64_t max_resim_ns{0};
+    uint64_t too_late{0};      // remote commands older than the window, applied late
+};
+
+// ---------------------------------------------------------------------------
+// Rollback netcode for a two-player remote match.
+//
+// Both peers run the same Game at a fixed step and apply every command at
+// the first tick at or after its timestamp, so they agree once both have
+// seen all commands.  Local commands are stamped input_delay_ms ahead and
+// sent right away; as long as the link is faster than the delay they reach
+// the other side before they are due.  The remote player is predicted to do
+// nothing; a command arriving for a tick that was already simulated restores
+// the snapshot taken before that tick and re-simulates up to the present.
+// ---------------------------------------------------------------------------
+class RollbackSession
+{
+public:
+    RollbackSession(Game &game, CommandTransport &link, RollbackConfig cfg = {})
+        : game(game), link(link), cfg(cfg), ring(static_cast<size_t>(std::max(1, cfg.window_ticks)))
+    {
+        next_tick = tick_of(game.sim_time_ms()) + 1;
+    }
+
+    // A command from the local player issued at now_ms.  Returns false (and
+    // drops it) when the piece belongs to the other player.
+    bool local_command(Command cmd, int now_ms)
+    {
+        if (owner(cmd) != cfg.player)
+            return false;
+        cmd.timestamp = now_ms + cfg.input_delay_ms;
+        link.send(cmd, now_ms);
+        schedule(cmd, cfg.player);
+        return true;
+    }
+
+    // Take in remote commands and simulate every tick up to now_ms
+    void advance_to(int now_ms)
+    {
+        Command cmd{0, "", "", {}};
+        while (link.poll(now_ms, cmd))
+            schedule(cmd, 3 - cfg.player);
+        if (rewind_to < next_tick)
+            rollback(rewind_to);
+        rewind_to = INT32_MAX;
+
+        while (static_cast<int64_t>(next_tick) * cfg.step_ms <= now_ms)
+        {
+            simulate(next_tick++);
+            ++stats_.ticks;
+        }
+    }
+
+    const RollbackStats &stats() const { return stats_; }
+    const RollbackConfig &config() const { return cfg; }
+    // Game time of the last simulated tick
+    int sim_time_ms() const { return game.sim_time_ms(); }
+
+private:
+    struct Slot
+    {
+        int tick{-1};
+        ByteWriter snap; // state before `tick` ran; keeps its capacity
+    };
+
+    static int owner(const Command &cmd)
+    {
+        if (cmd.piece_id.size() < 2)
+            return 0;
+        return cmd.piece_id[1] == 'W' ? 1 : cmd.piece_id[1] == 'B' ? 2 : 0;
+    }
+
+    int tick_of(int ms) const { return (ms + cfg.step_ms - 1) / cfg.step_ms; }
+
+    // File cmd under the tick it takes effect in; within a tick white's
+    // commands go first, each player's in sending order.
+    void schedule(const Command &cmd, int player)
+    {
+        int t = std::max(tick_of(cmd.timestamp), 0);
+        int oldest = next_tick - static_cast<int>(ring.size());
+        if (t < oldest || (t < next_tick && ring[slot(t)].tick != t))
+        {
+            // Beyond the window: the peers disagree from here on
+            ++stats_.too_late;
+            t = next_tick;
+        }
+        auto &list = inputs[t];
+        auto pos = std::find_if(list.begin(), list.end(),
+                                [&](const std::pair<int, Command> &e)
+                                { return e.first > player; });
+        list.insert(pos, {player, cmd});
+        if (t < next_tick)
+            rewind_to = std::min(rewind_to, t);
+    }
+
+    size_t slot(int tick) const { return static_cast<size_t>(tick) % ring.size(); }
+
+    void simulate(int tick)
+    {
+        Slot &s = ring[slot(tick)];
+        s.tick = tick;
+        s.snap.clear();
+        game.save_snapshot(s.snap);
+
+        auto it = inputs.find(tick);
+        if (it != inputs.end())
+            for (const auto &e : it->second)
+                game.enqueue_command(e.second);
+        game.advance(tick * cfg.step_ms);
+
+        // Inputs that fell out of the window can never be replayed
+        inputs.erase(inputs.begin(), inputs.lower_bound(tick - static_cast<int>(ring.size())));
+    }
+
+    void rollback(int from_tick)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        const Slot &s = ring[slot(from_tick)];
+        ByteReader r(s.snap.data());
+        game.restore(r);
+        int depth = next_tick - from_tick;
+        for (int t = from_tick; t < next_tick; ++t)
+            simulate(t);
+        auto ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+
+        ++stats_.rollbacks;
+        stats_.resim_ticks += static_cast<uint64_t>(depth);
+        stats_.max_depth_ticks = std::max(stats_.max_depth_ticks, depth);
+        stats_.resim_ns += ns;
+        stats_.max_resim_ns = std::max(stats_.max_resim_ns, ns);
+    }
+
+    Game &game;
+    CommandTransport &link;
+    RollbackConfig cfg;
+    std::vector<Slot> ring;
+    std::map<int, std::vector<std::pair<int, Command>>> inputs; // tick -> (player, command)
+    int next_tick{0};
+    int rewind_to{INT32_MAX}; // oldest already simulated tick that got new input
+    RollbackStats stats_;
+};
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "../Game.hpp"
+#include "../Serialization.hpp"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Low-bandwidth view of a running Game for spectators.
+//
+// Each frame carries only what changed since the previous frame; a full
+// keyframe is sent periodically (and on demand) so a viewer can join at any
+// keyframe.  Frames with nothing to report are not emitted at all.
+//
+//   frame    : u8 flags (kKeyframe | kCursors) | svarint time
+//              (game ms on keyframes, ms since the previous frame otherwise)
+//   keyframe : varint #names, str name...        (state-name table)
+//              varint #pieces, per piece: str id, varint name, cell, svarint px, py
+//   delta    : varint #changed, per piece: varint slot, u8 mask,
+//              [svarint drow, dcol] [svarint dx, dy] [varint name]
+//   cursors  : u8 present mask (bit per player), cell per present player
+//
+// Slots are the piece order of the last keyframe; a capture only flips a
+// bit, so a busy tick costs a handful of bytes.
+// ---------------------------------------------------------------------------
+struct PieceView
+{
+    std::string id;
+    std::string state;
+    std::pair<int, int> cell{0, 0};
+    std::pair<int, int> pix{0, 0};
+    bool alive{true};
+};
+
+struct SpectatorView
+{
+    int time_ms{0};
+    std::vector<PieceView> pieces; // keyframe slot order, captured pieces kept with alive = false
+    std::pair<int, int> cursor[2]{{-1, -1}, {-1, -1}};
+};
+
+namespace spectator_stream
+{
+constexpr uint8_t kKeyframe = 1;
+constexpr uint8_t kCursors = 2;
+
+constexpr uint8_t kCell = 1;
+constexpr uint8_t kPix = 2;
+constexpr uint8_t kState = 4;
+constexpr uint8_t kCaptured = 8;
+} // namespace spectator_stream
+
+class SpectatorEncoder
+{
+public:
+    explicit SpectatorEncoder(int keyframe_interval_ms = 2000) : keyframe_interval_ms(keyframe_interval_ms) {}
+
+    // Next frame is a keyframe (a new viewer joined)
+    void request_keyframe() { keyframe_due = true; }
+
+    // Append the frame for the game's current state to out.  Returns the
+    // number of bytes written, 0 when nothing changed.
+    size_t encode(const Game &game, ByteWriter &out)
+    {
+        using namespace spectator_stream;
+        const int now = game.sim_time_ms();
+        sample(game);
+
+        bool key = keyframe_due || now - last_keyframe_ms >= keyframe_interval_ms || !roster_matches();
+        uint8_t flags = 0;
+        if (key)
+            flags |= kKeyframe;
+        if (cursors_changed(key))
+            flags |= kCursors;
+        if (!key)
+        {
+            collect_changes();
+            if (changed.empty() && !(flags & kCursors))
+                return 0;
+        }
+
+        size_t start = out.size();
+        out.u8(flags);
+        out.svarint(key ? now : now - last_frame_ms);
+        if (key)
+            write_keyframe(out);
+        else
+            write_delta(out);
+        if (flags & kCursors)
+            write_cursors(out);
+
+        last_frame_ms = now;
+        if (key)
+        {
+            last_keyframe_ms = now;
+            keyframe_due = false;
+        }
+        prev.swap(cur);
+        prev_cursor[0] = cur_cursor[0];
+        prev_cursor[1] = cur_cursor[1];
+        return out.size() - start;
+    }
+
+private:
+    struct Sample
+    {
+        const Piece *piece{nullptr};
+        std::pair<int, int> cell{0, 0};
+        std::pair<int, int> pix{0, 0};
+        uint32_t name{0};
+        bool alive{false};
+    };
+
+    uint32_t name_index(const std::string &name)
+    {
+        auto it = name_ids.find(name);
+        if (it != name_ids.end())
+            return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.push_back(name);
+        name_ids.emplace(name, id);
+        names_dirty = true;
+        return id;
+    }
+
+    // Current state, in the slot order of the last keyframe when possible
+    void sample(const Game &game)
+    {
+        cur.assign(prev.size(), Sample{});
+        extra.clear();
+        for (const auto &p : game.pieces)
+        {
+            Sample s;
+            s.piece = p.get();
+            s.cell = p->current_cell();
+            s.pix = p->state->physics->get_pos_pix();
+            s.name = name_index(p->state->name);
+            s.alive = true;
+            auto it = slot_of.find(p->id);
+            if (it != slot_of.end() && prev[it->second].piece == p.get())
+                cur[it->second] = s;
+            else
+                extra.push_back(s);
+        }
+        cur_cursor[0] = game.kp1 ? game.kp1->get_cursor() : std::make_pair(-1, -1);
+        cur_cursor[1] = game.kp2 ? game.kp2->get_cursor() : std::make_pair(-1, -1);
+    }
+
+    // Deltas can only describe pieces of the last keyframe
+    bool roster_matches() const { return extra.empty() && !names_dirty; }
+
+    bool cursors_changed(bool key) const
+    {
+        bool any = cur_cursor[0].first >= 0 || cur_cursor[1].first >= 0;
+        if (key)
+            return any;
+        return cur_cursor[0] != prev_cursor[0] || cur_cursor[1] != prev_cursor[1];
+    }
+
+    void collect_changes()
+    {
+        using namespace spectator_stream;
+        changed.clear();
+        for (size_t i = 0; i < cur.size(); ++i)
+        {
+            const Sample &a = prev[i];
+            Sample &b = cur[i];
+            if (!a.alive)
+                continue; // captured earlier, nothing left to report
+            uint8_t mask = 0;
+            if (!b.alive)
+            {
+                mask = kCaptured;
+                b = a;
+                b.alive = false;
+            }
+            else
+            {
+                if (b.cell != a.cell)
+                    mask |= kCell;
+                if (b.pix != a.pix)
+                    mask |= kPix;
+                if (b.name != a.name)
+                    mask |= kState;
+            }
+            if (mask)
+                changed.emplace_back(static_cast<uint32_t>(i), mask);
+        }
+    }
+
+    void write_keyframe(ByteWriter &out)
+    {
+        // Rebuild the slot order from scratch; captured pieces are dropped
+        std::vector<Sample> live;
+        live.reserve(cur.size() + extra.size());
+        for (const auto &s : cur)
+            if (s.alive)
+                live.push_back(s);
+        live.insert(live.end(), extra.begin(), extra.end());
+        cur.swap(live);
+        extra.clear();
+
+        out.varint(names.size());
+        for (const auto &n : names)
+            out.str(n);
+        names_dirty = false;
+
+        slot_of.clear();
+        out.varint(cur.size());
+        for (size_t i = 0; i < cur.size(); ++i)
+        {
+            const Sample &s = cur[i];
+            slot_of[s.piece->id] = i;
+            out.str(s.piece->id);
+            out.varint(s.name);
+            out.cell(s.cell);
+            out.svarint(s.pix.first);
+            out.svarint(s.pix.second);
+        }
+    }
+
+    void write_delta(ByteWriter &out)
+    {
+        using namespace spectator_stream;
+        out.varint(changed.size());
+        for (const auto &c : changed)
+        {
+            const Sample &a = prev[c.first];
+            const Sample &b = cur[c.first];
+            out.varint(c.first);
+            out.u8(c.second);
+            if (c.second & kCell)
+            {
+                out.svarint(b.cell.first - a.cell.first);
+                out.svarint(b.cell.second - a.cell.second);
+            }
+            if (c.second & kPix)
+            {
+                out.svarint(b.pix.first - a.pix.first);
+                out.svarint(b.pix.second - a.pix.second);
+            }
+            if (c.second & kState)
+                out.varint(b.name);
+        }
+    }
+
+    void write_cursors(ByteWriter &out)
+    {
+        uint8_t present = 0;
+        for (int i = 0; i < 2; ++i)
+            if (cur_cursor[i].first >= 0)
+                present |= static_cast<uint8_t>(1 << i);
+        out.u8(present);
+        for (int i = 0; i < 2; ++i)
+            if (present & (1 << i))
+                out.cell(cur_cursor[i]);
+    }
+
+    int keyframe_interval_ms;
+    bool keyframe_due{true};
+    int last_keyframe_ms{0};
+    int last_frame_ms{0};
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> name_ids;
+    bool names_dirty{false};
+
+    std::unordered_map<std::string, size_t> slot_of;
+    std::vector<Sample> prev, cur, extra;
+    std::vector<std::pair<uint32_t, uint8_t>> changed;
+    std::pair<int, int> prev_cursor[2]{{-1, -1}, {-1, -1}};
+    std::pair<int, int> cur_cursor[2]{{-1, -1}, {-1, -1}};
+};
+
+class SpectatorDecoder
+{
+public:
+    // Apply one frame.  Deltas before the first keyframe are skipped and
+    // reported by returning false.  Throws on malformed input.
+    bool apply(ByteReader &r)
+    {
+        using namespace spectator_stream;
+        uint8_t flags = r.u8();
+        int t = static_cast<int>(r.svarint());
+        if (!(flags & kKeyframe) && !synced)
+            return false;
+        v.time_ms = (flags & kKeyframe) ? t : v.time_ms + t;
+
+        if (flags & kKeyframe)
+        {
+            names.resize(r.varint());
+            for (auto &n : names)
+                n = r.str();
+            v.pieces.resize(r.varint());
+            for (auto &p : v.pieces)
+            {
+                p.id = r.str();
+                p.state = name(r.varint());
+                p.cell = r.cell();
+                p.pix.first = static_cast<int>(r.svarint());
+                p.pix.second = static_cast<int>(r.svarint());
+                p.alive = true;
+            }
+            v.cursor[0] = v.cursor[1] = {-1, -1};
+            synced = true;
+        }
+        else
+        {
+            uint64_t n = r.varint();
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                uint64_t slot = r.varint();
+                if (slot >= v.pieces.size())
+                    throw std::runtime_error("Spectator stream: bad slot");
+                PieceView &p = v.pieces[slot];
+                uint8_t mask = r.u8();
+                if (mask & kCaptured)
+                    p.alive = false;
+                if (mask & kCell)
+                {
+                    p.cell.first += static_cast<int>(r.svarint());
+                    p.cell.second += static_cast<int>(r.svarint());
+                }
+                if (mask & kPix)
+                {
+                    p.pix.first += static_cast<int>(r.svarint());
+                    p.pix.second += static_cast<int>(r.svarint());
+                }
+                if (mask & kState)
+                    p.state = name(r.varint());
+            }
+        }
+
+        if (flags & kCursors)
+        {
+            uint8_t present = r.u8();
+            for (int i = 0; i < 2; ++i)
+                v.cursor[i] = (present & (1 << i)) ? r.cell() : std::make_pair(-1, -1);
+        }
+        return true;
+    }
+
+    bool apply(const std::vector<uint8_t> &frame)
+    {
+        ByteReader r(frame);
+        return apply(r);
+    }
+
+    bool synced_yet() const { return synced; }
+    const SpectatorView &view() const { return v; }
+
+private:
+    const std::string &name(uint64_t i) const
+    {
+        if (i >= names.size())
+            throw std::runtime_error("Spectator stream: bad state name");
+        return names[i];
+    }
+
+    SpectatorView v;
+    std::vector<std::string> names;
+    bool synced{false};
+};
@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+
+#include "../src/AllocStats.hpp"
+#include "../src/Game.hpp"
+#include "../src/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <memory>
+
+namespace
+{
+// Allocations made by advance() over [from, to) in 16 ms steps
+AllocCounters ticks_allocs(Game &game, int from, int to)
+{
+    AllocScope scope;
+    for (int t = from; t < to; t += 16)
+        game.advance(t);
+    return scope.delta();
+}
+} // namespace
+
+TEST_CASE("Allocation hook counts this thread's operator new")
+{
+    REQUIRE(alloc_hook_installed());
+    AllocScope scope;
+    // Called directly: a new-expression / delete pair may be elided
+    void *p = ::operator new(sizeof(int));
+    ::operator delete(p);
+    auto d = scope.delta();
+    CHECK(d.allocs == 1);
+    CHECK(d.frees == 1);
+    CHECK(d.bytes == sizeof(int));
+}
+
+TEST_CASE("Steady-state headless ticks do not allocate")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    game.profiler.set_enabled(true);
+
+    // Warm-up: the first ticks size the cell map and the reused buffers
+    ticks_allocs(game, 0, 160);
+    game.profiler.reset();
+
+    SUBCASE("idle board")
+    {
+        auto d = ticks_allocs(game, 160, 160 + 100 * 16);
+        CHECK(d.allocs == 0);
+        // and the profiler attributes nothing to any phase
+        for (TickPhase p : {TickPhase::Pieces, TickPhase::Commands, TickPhase::Collisions})
+            CHECK(game.profiler.allocs_per_run(p) == 0.0);
+    }
+
+    SUBCASE("pieces moving, arriving and resting")
+    {
+        game.enqueue_command(Command{160, "PW_(6,4)", "move", {{6, 4}, {5, 4}}});
+        game.enqueue_command(Command{160, "PB_(1,3)", "move", {{1, 3}, {2, 3}}});
+        game.advance(160); // copies and applies the commands
+        size_t live = game.pieces.size();
+        auto d = ticks_allocs(game, 176, 176 + 300 * 16);
+        REQUIRE(game.pieces.size() == live); // captures are events, not steady state
+        CHECK(game.all_idle());
+        int arrived = 0;
+        for (const auto &p : game.pieces)
+            if (p->current_cell() == std::make_pair(5, 4) || p->current_cell() == std::make_pair(2, 3))
+                ++arrived;
+        CHECK(arrived == 2);
+        CHECK(d.allocs == 0);
+    }
+
+    SUBCASE("rendering a frame")
+    {
+        game.render_frame(160); // creates the reused frame image
+        AllocScope scope;
+        for (int i = 0; i < 100; ++i)
+            game.render_frame(176 + i * 16);
+        CHECK(scope.delta().allocs == 0);
+    }
+}
@@ -0,0 +1,109 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/Replay.hpp"
+#include "../src/CommandJournal.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+std::string temp_journal(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+using PieceView = std::tuple<std::string, std::string, std::pair<int, int>, std::pair<double, double>>;
+
+std::vector<PieceView> final_state(const Game &game)
+{
+    std::vector<PieceView> out;
+    for (const auto &p : game.pieces)
+        out.emplace_back(p->id, p->state->name, p->current_cell(), p->state->physics->get_pos_m());
+    return out;
+}
+} // namespace
+
+TEST_CASE("CommandJournal records round trip through JournalReader")
+{
+    std::string path = temp_journal("kfc_journal_roundtrip.bin");
+    {
+        CommandJournal journal(path, "KB,,\n,,KW\n", 0xABCDEF0123456789ull);
+        journal.record_reset(5);
+        journal.record_tick(21);
+        journal.record_command(Command{19, "PW_(6,0)", "move", {{6, 0}, {5, 0}}});
+        journal.record_command(Command{25, "PW_(6,0)", "castle", {}});
+        journal.record_tick(37);
+    }
+
+    JournalReader reader(path);
+    CHECK(reader.asset_hash() == 0xABCDEF0123456789ull);
+    CHECK(reader.board_csv() == "KB,,\n,,KW\n");
+
+    JournalRecord rec;
+    REQUIRE(reader.next(rec));
+    CHECK(rec.kind == JournalRecord::Reset);
+    CHECK(rec.time_ms == 5);
+    REQUIRE(reader.next(rec));
+    CHECK(rec.kind == JournalRecord::Tick);
+    CHECK(rec.time_ms == 21);
+    REQUIRE(reader.next(rec));
+    CHECK(rec.kind == JournalRecord::Cmd);
+    CHECK(rec.cmd.timestamp == 19);
+    CHECK(rec.cmd.piece_id == "PW_(6,0)");
+    CHECK(rec.cmd.type == "move");
+    CHECK(rec.cmd.params == std::vector<std::pair<int, int>>{{6, 0}, {5, 0}});
+    REQUIRE(reader.next(rec));
+    CHECK(rec.cmd.piece_id == "PW_(6,0)");
+    CHECK(rec.cmd.type == "castle");
+    CHECK(rec.cmd.params.empty());
+    REQUIRE(reader.next(rec));
+    CHECK(rec.kind == JournalRecord::Tick);
+    CHECK(rec.time_ms == 37);
+    CHECK_FALSE(reader.next(rec));
+}
+
+TEST_CASE("Journal replay reproduces the recorded final state")
+{
+    set_log_enabled(false);
+    std::string path = temp_journal("kfc_journal_replay.bin");
+    auto imgFactory = std::make_shared<MockImgFactory>();
+
+    std::vector<PieceView> recorded;
+    {
+        Game game = create_game("../../pieces/", imgFactory);
+        game.set_journal(create_journal(path, "../../pieces/"));
+        game.reset_pieces(0);
+
+        // A short scripted game: pawn pushes, a knight hop and a capture race.
+        std::vector<Command> script = {
+            Command{100, "PW_(6,4)", "move", {{6, 4}, {4, 4}}},
+            Command{150, "PB_(1,3)", "move", {{1, 3}, {3, 3}}},
+            Command{400, "NW_(7,6)", "move", {{7, 6}, {5, 5}}},
+            Command{4000, "PW_(6,4)", "move", {{4, 4}, {3, 3}}},
+            Command{4100, "PB_(1,0)", "jump", {{1, 0}}},
+        };
+        size_t next = 0;
+        for (int t = 0; t <= 12000; t += 16)
+        {
+            while (next < script.size() && script[next].timestamp <= t)
+                game.enqueue_command(script[next++]);
+            game.advance(t);
+        }
+        recorded = final_state(game);
+    }
+
+    JournalReader reader(path);
+    Game replayed = create_replay_game(reader, "../../pieces/", imgFactory);
+    ReplayStats stats = replay_journal(replayed, reader);
+
+    CHECK(stats.commands == 5);
+    CHECK(stats.ticks > 0);
+    CHECK(stats.ticks < 12000 / 16); // idle stretches are not journaled
+    CHECK(final_state(replayed) == recorded);
+    set_log_enabled(true);
+}
@@ -0,0 +1,71 @@
+#include <doctest/doctest.h>
+
+#include "../src/FramePacer.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("FramePacer drops renders when behind and restarts when far behind")
+{
+    FramePacer pacer(100.0); // 10 ms
+    auto t0 = FramePacer::clock::now();
+    CHECK(pacer.begin_frame(t0));            // deadline of the next frame: 10 ms
+    CHECK(pacer.begin_frame(t0 + 12ms));     // 2 ms late: rendered
+    CHECK_FALSE(pacer.begin_frame(t0 + 35ms)); // 15 ms late: dropped
+    CHECK(pacer.begin_frame(t0 + 36ms));     // 6 ms late: rendered
+    CHECK(pacer.dropped_frames() == 1);
+    CHECK(pacer.resync_count() == 0);
+
+    CHECK_FALSE(pacer.begin_frame(t0 + 200ms)); // a stall
+    CHECK(pacer.resync_count() == 1);
+    CHECK(pacer.begin_frame(t0 + 210ms)); // back on schedule
+    CHECK(pacer.frame_count() == 6);
+    CHECK(pacer.frame_intervals().count() == 5);
+}
+
+TEST_CASE("FramePacer holds a steady rate whatever the work per frame")
+{
+    FramePacer pacer(200.0); // 5 ms
+    for (int i = 0; i < 60; ++i)
+    {
+        pacer.begin_frame();
+        // Uneven work, always inside the period
+        std::this_thread::sleep_for(std::chrono::microseconds((i % 3) * 1000));
+        pacer.wait();
+    }
+    // Loose bounds: a shared CI machine may preempt the loop now and then
+    CHECK(pacer.dropped_frames() <= 3);
+    CHECK(pacer.interval_mean_ms() == doctest::Approx(5.0).epsilon(0.2));
+    CHECK(pacer.interval_stddev_ms() < 3.0);
+    CHECK(pacer.wake_jitter().count() > 0);
+
+    std::ostringstream os;
+    pacer.dump(os);
+    CHECK(os.str().find("stddev") != std::string::npos);
+    CHECK(os.str().find(" ms\nwake jitter p50 ") != std::string::npos);
+    CHECK(os.str().back() == '\n'); // the last line is not cut off
+}
+
+TEST_CASE("FramePacer can poll at a fixed rate while it waits for a frame")
+{
+    FramePacer pacer(50.0); // 20 ms
+    pacer.begin_frame();
+    int polls = 0;
+    pacer.wait(2ms, [&]
+               { ++polls; });
+    // About ten polls in 20 ms; loose for a loaded machine
+    CHECK(polls >= 3);
+    CHECK(polls <= 12);
+    CHECK(pacer.wake_jitter().count() == 1);
+
+    // A frame already late still polls once
+    pacer.begin_frame();
+    std::this_thread::sleep_for(25ms);
+    polls = 0;
+    pacer.wait(2ms, [&]
+               { ++polls; });
+    CHECK(polls == 1);
+}
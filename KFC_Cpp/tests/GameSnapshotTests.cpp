@@ -0,0 +1,92 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace
+{
+// Drive a game through a few overlapping moves under a virtual clock.
+void play_until(Game &game, int from_ms, int to_ms, std::vector<Command> script = {})
+{
+    size_t next = 0;
+    for (int t = from_ms; t <= to_ms; t += 16)
+    {
+        while (next < script.size() && script[next].timestamp <= t)
+            game.enqueue_command(script[next++]);
+        game.advance(t);
+    }
+}
+} // namespace
+
+TEST_CASE("Snapshot round trip is byte identical")
+{
+    set_log_enabled(false);
+    auto imgFactory = std::make_shared<MockImgFactory>();
+    Game game = create_game("../../pieces/", imgFactory);
+    game.reset_pieces(0);
+    play_until(game, 0, 900, {
+                                 Command{100, "PW_(6,4)", "move", {{6, 4}, {4, 4}}},
+                                 Command{120, "NB_(0,1)", "move", {{0, 1}, {2, 2}}},
+                                 Command{300, "PB_(1,0)", "jump", {{1, 0}}},
+                             });
+    // A pending command must survive too
+    game.enqueue_command(Command{910, "PW_(6,0)", "move", {{6, 0}, {5, 0}}});
+
+    auto snap = game.snapshot();
+    CHECK(snap.size() < 1024);
+
+    Game other = create_game("../../pieces/", imgFactory);
+    other.restore(snap); // first restore also indexes each piece's states
+    auto restore_start = std::chrono::steady_clock::now();
+    other.restore(snap);
+    auto restore_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - restore_start)
+                          .count();
+    MESSAGE("snapshot " << snap.size() << " bytes, restore " << restore_us << " us");
+
+    CHECK(other.snapshot() == snap);
+    CHECK(other.sim_time_ms() == game.sim_time_ms());
+    REQUIRE(other.pieces.size() == game.pieces.size());
+    for (size_t i = 0; i < game.pieces.size(); ++i)
+    {
+        CHECK(other.pieces[i]->id == game.pieces[i]->id);
+        CHECK(other.pieces[i]->state->name == game.pieces[i]->state->name);
+        CHECK(other.pieces[i]->state->physics->get_pos_m() == game.pieces[i]->state->physics->get_pos_m());
+    }
+
+    // Both games continue identically from the restored point
+    play_until(game, 916, 6000);
+    play_until(other, 916, 6000);
+    CHECK(other.snapshot() == game.snapshot());
+    set_log_enabled(true);
+}
+
+TEST_CASE("Restore rolls a game back and drops captured pieces' removal")
+{
+    set_log_enabled(false);
+    auto imgFactory = std::make_shared<MockImgFactory>();
+    Game game = create_game("../../pieces/", imgFactory);
+    game.reset_pieces(0);
+    auto before = game.snapshot();
+    size_t count = game.pieces.size();
+
+    // Knight hop through a friendly pawn's cell removes that pawn
+    play_until(game, 0, 3000, {Command{16, "NW_(7,6)", "move", {{7, 6}, {5, 5}}}});
+    CHECK(game.pieces.size() < count);
+
+    game.restore(before);
+    CHECK(game.pieces.size() == count);
+    CHECK(game.snapshot() == before);
+    set_log_enabled(true);
+}
+
+TEST_CASE("Snapshot rejects foreign data")
+{
+    auto imgFactory = std::make_shared<MockImgFactory>();
+    Game game = create_game("../../pieces/", imgFactory);
+    std::vector<uint8_t> junk = {'N', 'O', 'P', 'E', 1, 0};
+    CHECK_THROWS_AS(game.restore(junk), std::runtime_error);
+}
@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+
+#include "../src/img/GlyphAtlas.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+// Every glyph a solid 4x6 box above the baseline, half covered at its
+// right edge; 5 px advance, nothing for spaces
+GlyphBitmap box_glyph(char c, double font_size)
+{
+    GlyphBitmap g;
+    int scale = font_size > 1 ? 2 : 1;
+    g.advance = 5 * scale;
+    if (c == ' ')
+        return g;
+    g.width = 4 * scale;
+    g.height = 6 * scale;
+    g.top = 6 * scale;
+    g.coverage.assign(static_cast<size_t>(g.width) * g.height, 255);
+    for (int r = 0; r < g.height; ++r)
+        g.coverage[static_cast<size_t>(r) * g.width + g.width - 1] = 128;
+    return g;
+}
+} // namespace
+
+TEST_CASE("GlyphAtlas rasterizes each glyph once and caches layouts")
+{
+    int calls = 0;
+    GlyphAtlas atlas([&](char c, double size)
+                     { ++calls; return box_glyph(c, size); });
+
+    const auto &run = atlas.layout("ab a", 0.4);
+    CHECK(run.width == 20);
+    CHECK(run.quads.size() == 3); // the space draws nothing
+    CHECK(run.quads[2].dx == 15);
+    CHECK(run.quads[2].dy == -6);
+    CHECK(calls == 3);            // a, b, space
+
+    const auto *first = &atlas.layout("ab a", 0.4);
+    CHECK(first == &atlas.layout("ab a", 0.4));
+    atlas.layout("baa", 0.4);
+    CHECK(calls == 3);
+    CHECK(atlas.cached_runs() == 2);
+
+    // Another size is another font
+    CHECK(atlas.layout("a", 1.5).width == 10);
+    CHECK(calls == 4);
+    CHECK(atlas.glyphs_rasterized() == 4);
+}
+
+TEST_CASE("GlyphAtlas blends coverage into 3 and 4 channel buffers, clipped")
+{
+    GlyphAtlas atlas(box_glyph, /*atlas_width*/ 16);
+    const uint8_t white[4] = {255, 255, 255, 255};
+
+    // 4 channels, transparent black
+    const int W = 12, H = 8;
+    std::vector<uint8_t> bgra(W * H * 4, 0);
+    const auto &run = atlas.layout("x", 0.4);
+    atlas.draw(run, bgra.data(), W, H, W * 4, 4, 2, 7, white);
+    auto px = [&](int x, int y, int k)
+    { return bgra[static_cast<size_t>(y * W + x) * 4 + k]; };
+    CHECK(px(2, 1, 0) == 255);  // inside the box
+    CHECK(px(2, 1, 3) == 255);  // made opaque
+    CHECK(px(5, 1, 0) == 128);  // the half covered column
+    CHECK(px(2, 0, 0) == 0);    // above the glyph
+    CHECK(px(2, 7, 0) == 0);    // the baseline row itself is not covered
+    CHECK(px(6, 1, 3) == 0);    // past the glyph
+
+    // 3 channels over grey, half way off the top left corner
+    std::vector<uint8_t> bgr(W * H * 3, 100);
+    atlas.draw(atlas.layout("xx", 0.4), bgr.data(), W, H, W * 3, 3, -2, 3, white);
+    CHECK(bgr[0] == 255);
+    CHECK(bgr[(1 * 3)] == 178); // (255*128 + 100*127) / 255
+    CHECK(bgr[static_cast<size_t>(3 * W) * 3] == 100);
+
+    // Glyphs that fill a shelf go on the next one
+    atlas.layout("abcdefgh", 0.4);
+    CHECK(atlas.atlas_height() > 7);
+    // Entirely outside: nothing drawn, nothing touched
+    atlas.draw(atlas.layout("x", 0.4), bgr.data(), W, H, W * 3, 3, 100, 100, white);
+    atlas.draw(atlas.layout("x", 0.4), bgr.data(), W, H, W * 3, 3, -100, -100, white);
+}
+
+TEST_CASE("GlyphAtlas keeps only the covered part of a glyph")
+{
+    // 8x8 bitmap, baseline at row 8, ink in rows 5..6, columns 2..4
+    GlyphAtlas atlas([](char, double)
+                     {
+                         GlyphBitmap g;
+                         g.width = g.height = 8;
+                         g.top = 8;
+                         g.advance = 9;
+                         g.coverage.assign(64, 0);
+                         for (int r = 5; r <= 6; ++r)
+                             for (int c = 2; c <= 4; ++c)
+                                 g.coverage[static_cast<size_t>(r * 8 + c)] = 255;
+                         return g; });
+    const auto &run = atlas.layout(".", 0.4);
+    REQUIRE(run.quads.size() == 1);
+    const auto &q = run.quads[0];
+    CHECK(q.w == 3);
+    CHECK(q.h == 2);
+    CHECK(q.dx == 2);
+    CHECK(q.dy == -3);
+    CHECK(run.width == 9);
+}
@@ -52,4 +52,29 @@ TEST_CASE("Graphics get_img throws when no frames") {
     gfx.set_frames({});
     gfx.reset(Command{0,"test","idle",{}});
     CHECK_THROWS_AS(gfx.get_img(), runtime_error);
-} 
\ No newline at end of file
+} 
+
+TEST_CASE("SpriteLevels pick the level a view size scales from") {
+    auto levels = make_shared<SpriteLevels>();
+    levels->px = {64, 32, 128};
+    for(int px : levels->px)
+        levels->frames.push_back({make_shared<MockImg>(pair<int,int>(px,px)),
+                                  make_shared<MockImg>(pair<int,int>(px,px))});
+    Graphics gfx(levels, /*loop*/ true, /*fps*/ 10.0);
+    CHECK(gfx.level_count() == 3);
+
+    // A view with no level of its size scales down from the next larger one
+    CHECK(gfx.level_px(gfx.source_level(64)) == 64);
+    CHECK(gfx.level_px(gfx.source_level(32)) == 32);
+    CHECK(gfx.level_px(gfx.source_level(40)) == 64);
+    CHECK(gfx.level_px(gfx.source_level(20)) == 32);
+    CHECK(gfx.level_px(gfx.source_level(100)) == 128);
+    CHECK(gfx.level_px(gfx.source_level(1000)) == 128);
+    // Same frame at every level
+    gfx.reset(Command{0, "P", "idle", {}});
+    gfx.update(100);
+    CHECK(gfx.current_frame() == 1);
+    CHECK(gfx.level_img(gfx.source_level(100)) == levels->frames[2][1]);
+    CHECK(gfx.level_img(0) == levels->frames[0][1]);
+    CHECK(gfx.get_img() == levels->frames[0][1]);
+}
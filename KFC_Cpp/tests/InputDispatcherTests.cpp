@@ -0,0 +1,172 @@
+#include <doctest/doctest.h>
+
+#include "../src/InputDispatcher.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Records the keys and the thread they arrived on
+struct RecordingSink : KeySink
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::string> keys;
+    std::vector<std::thread::id> threads;
+
+    void on_key(const std::string &key, uint64_t) override
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        keys.push_back(key);
+        threads.push_back(std::this_thread::get_id());
+        cv.notify_all();
+    }
+
+    bool wait_for(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        return cv.wait_for(lock, std::chrono::seconds(2), [&]
+                           { return keys.size() >= n; });
+    }
+};
+
+// Holds the dispatcher thread inside on_key until released
+struct BlockingSink : KeySink
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool entered{false}, release{false};
+
+    void on_key(const std::string &, uint64_t) override
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        entered = true;
+        cv.notify_all();
+        cv.wait(lock, [&]
+                { return release; });
+    }
+};
+
+// Detaches itself from inside on_key
+struct SelfDetachingSink : KeySink
+{
+    InputDispatcher &d;
+    RecordingSink done;
+    explicit SelfDetachingSink(InputDispatcher &d) : d(d) {}
+
+    void on_key(const std::string &key, uint64_t captured_ns) override
+    {
+        d.detach(this);
+        done.on_key(key, captured_ns);
+    }
+};
+} // namespace
+
+TEST_CASE("InputDispatcher delivers keys in order, without polling")
+{
+    InputDispatcher d;
+    RecordingSink sink;
+    d.attach(&sink);
+    CHECK(d.running());
+
+    auto t0 = std::chrono::steady_clock::now();
+    d.post(&sink, "up", 1);
+    REQUIRE(sink.wait_for(1));
+    // Woken by the post, not by a timer tick
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(500));
+
+    d.post(&sink, "down", 2);
+    d.post(&sink, "enter", 3);
+    REQUIRE(sink.wait_for(3));
+    CHECK(sink.keys == std::vector<std::string>{"up", "down", "enter"});
+
+    d.detach(&sink);
+    CHECK_FALSE(d.running());
+}
+
+TEST_CASE("InputDispatcher serves all players from one thread")
+{
+    InputDispatcher d;
+    RecordingSink p1, p2;
+    d.attach(&p1);
+    d.attach(&p2);
+    d.post(&p1, "w", 0);
+    d.post(&p2, "up", 0);
+    REQUIRE(p1.wait_for(1));
+    REQUIRE(p2.wait_for(1));
+    CHECK((p1.threads[0] == p2.threads[0]));
+    CHECK((p1.threads[0] != std::this_thread::get_id()));
+
+    // The thread outlives one player and stops with the last
+    d.detach(&p1);
+    CHECK(d.running());
+    d.post(&p1, "s", 0); // detached: ignored
+    d.detach(&p2);
+    CHECK_FALSE(d.running());
+    CHECK(p1.keys.size() == 1);
+
+    // And starts again for the next game
+    d.attach(&p1);
+    d.post(&p1, "s", 0);
+    REQUIRE(p1.wait_for(2));
+    d.detach(&p1);
+}
+
+TEST_CASE("InputDispatcher detach drops queued keys and waits for the sink")
+{
+    InputDispatcher d;
+    BlockingSink busy;
+    RecordingSink other;
+    d.attach(&busy);
+    d.attach(&other);
+    d.post(&busy, "a", 0);
+    {
+        std::unique_lock<std::mutex> lock(busy.mtx);
+        busy.cv.wait(lock, [&]
+                     { return busy.entered; });
+    }
+    // Queued behind the blocked call
+    d.post(&other, "b", 0);
+    d.post(&other, "c", 0);
+
+    std::thread releaser([&]
+                         {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::lock_guard<std::mutex> lock(busy.mtx);
+        busy.release = true;
+        busy.cv.notify_all(); });
+    d.detach(&other); // drops b and c
+    d.detach(&busy);  // returns once on_key has
+    {
+        std::lock_guard<std::mutex> lock(busy.mtx);
+        CHECK(busy.release);
+    }
+    releaser.join();
+    CHECK(other.keys.empty());
+    CHECK_FALSE(d.running());
+}
+
+TEST_CASE("InputDispatcher lets a sink detach from inside on_key")
+{
+    InputDispatcher d;
+    SelfDetachingSink last(d);
+    d.attach(&last);
+    d.post(&last, "q", 0);
+    REQUIRE(last.done.wait_for(1)); // did not wait on or join itself
+    d.post(&last, "q", 0);          // detached: ignored
+
+    // The thread is still there, idle, and serves the next sink
+    RecordingSink next;
+    d.attach(&next);
+    d.post(&next, "up", 0);
+    REQUIRE(next.wait_for(1));
+    CHECK((next.threads[0] == last.done.threads[0]));
+    CHECK(last.done.keys.size() == 1);
+    d.detach(&next);
+    CHECK_FALSE(d.running());
+}
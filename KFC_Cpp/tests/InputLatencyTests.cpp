@@ -0,0 +1,97 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/InputLatency.hpp"
+#include "../src/KeyboardProducer.hpp"
+#include "../src/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("InputLatency splits a key press into stages")
+{
+    InputLatency lat;
+    const uint64_t ms = 1000000;
+    Command cmd{0, "PW_(6,0)", "move", {{6, 0}, {5, 0}}};
+    cmd.captured_ns = 100 * ms;
+    cmd.queued_ns = 101 * ms;
+
+    lat.command_processed(cmd, 110 * ms, 111 * ms, true);
+    CHECK(lat.histogram(InputStage::Produce).max() == 1 * ms);
+    CHECK(lat.histogram(InputStage::Queue).max() == 9 * ms);
+    CHECK(lat.histogram(InputStage::Apply).count() == 1);
+    CHECK(lat.pending_count() == 1);
+    CHECK(lat.histogram(InputStage::Total).count() == 0);
+
+    lat.frame_presented(130 * ms);
+    CHECK(lat.pending_count() == 0);
+    CHECK(lat.histogram(InputStage::Display).max() == 19 * ms);
+    CHECK(lat.histogram(InputStage::Total).max() == 30 * ms);
+
+    // A rejected move never reaches the screen
+    lat.command_processed(cmd, 140 * ms, 141 * ms, false);
+    CHECK(lat.rejected() == 1);
+    CHECK(lat.pending_count() == 0);
+
+    // Commands not coming from a key press are not measured
+    Command scripted{0, "PW_(6,0)", "move", {{6, 0}, {5, 0}}};
+    lat.command_processed(scripted, 150 * ms, 151 * ms, true);
+    CHECK(lat.histogram(InputStage::Apply).count() == 1);
+}
+
+TEST_CASE("Key presses are stamped on the game clock and followed to the frame")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+
+    std::vector<Command> queue;
+    std::mutex mtx;
+    KeyboardProcessor kp(8, 8, {{"up", "up"}, {"down", "down"}, {"enter", "select"}});
+    KeyboardProducer producer(queue, mtx, kp, 1);
+    producer.set_piece_index(&game.piece_index());
+    auto origin = GameClock::now() - std::chrono::milliseconds(5000);
+    producer.set_time_origin(origin);
+
+    uint64_t before = clock_now_ns();
+    for (int i = 0; i < 6; ++i)
+        producer.simulate_key("down");
+    producer.simulate_key("enter"); // select PW_(6,0)
+    producer.simulate_key("up");
+    producer.simulate_key("enter"); // move it to (5,0)
+    producer.start();
+    for (int i = 0; i < 200; ++i)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!queue.empty())
+                break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    producer.stop();
+
+    REQUIRE(queue.size() == 1);
+    Command cmd = queue.front();
+    CHECK(cmd.type == "move");
+    // Game time, not a clock private to the producer
+    CHECK(cmd.timestamp >= 5000);
+    CHECK(cmd.timestamp < 5000 + 2000);
+    CHECK(cmd.captured_ns >= before);
+    CHECK(cmd.queued_ns >= cmd.captured_ns);
+
+    game.enqueue_command(cmd);
+    game.advance(cmd.timestamp);
+    CHECK(game.input_latency.histogram(InputStage::Queue).count() == 1);
+    CHECK(game.input_latency.histogram(InputStage::Apply).count() == 1);
+    CHECK(game.input_latency.pending_count() == 1);
+
+    game.input_latency.frame_presented(clock_now_ns());
+    const auto &total = game.input_latency.histogram(InputStage::Total);
+    CHECK(total.count() == 1);
+    CHECK(total.max() >= game.input_latency.histogram(InputStage::Display).max());
+}
@@ -0,0 +1,109 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/InputSource.hpp"
+#include "../src/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ScriptedSource yields keys in time order as the game clock reaches them")
+{
+    std::istringstream script("# two players\n"
+                              "20 w\n"
+                              "10 up\n"
+                              "\n"
+                              "20 space\n"
+                              "35 enter\n");
+    ScriptedSource src(script);
+    REQUIRE(src.size() == 4);
+
+    InputEvent ev;
+    CHECK_FALSE(src.poll(9, ev));
+    REQUIRE(src.poll(10, ev));
+    CHECK(ev.key == key_code::Up);
+    CHECK_FALSE(src.poll(19, ev));
+    REQUIRE(src.poll(30, ev));
+    CHECK(ev.key == 'w');
+    REQUIRE(src.poll(30, ev));
+    CHECK(ev.key == ' ');
+    CHECK(ev.time_ms == 20);
+    CHECK_FALSE(src.finished());
+    REQUIRE(src.poll(100, ev));
+    CHECK(src.finished());
+
+    std::istringstream bad("10 nokey\n");
+    CHECK_THROWS_AS(ScriptedSource{bad}, std::runtime_error);
+}
+
+TEST_CASE("A recorded session plays back at a new start and speed")
+{
+    ScriptedSource live(std::vector<InputEvent>{{100, key_code::Down}, {300, 'f'}, {500, key_code::Enter}});
+    std::ostringstream recording;
+    RecordingSource rec(live, recording);
+    InputEvent ev;
+    while (rec.poll(1000, ev))
+    {
+    }
+
+    std::istringstream in(recording.str());
+    SessionPlayer player(in, 2000, 2.0);
+    std::vector<InputEvent> got;
+    while (player.poll(10000, ev))
+        got.push_back(ev);
+    REQUIRE(got.size() == 3);
+    CHECK(got[0].time_ms == 2000);
+    CHECK(got[1].time_ms == 2100);
+    CHECK(got[2].time_ms == 2200);
+    CHECK(got[1].key == 'f');
+}
+
+TEST_CASE("Scripted keys select and move a piece in virtual time")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+
+    std::vector<InputEvent> keys;
+    for (int i = 0; i < 6; ++i)
+        keys.push_back({0, key_code::Down});
+    keys.push_back({0, key_code::Enter}); // select PW_(6,0)
+    keys.push_back({40, key_code::Up});
+    keys.push_back({50, key_code::Enter}); // move it to (5,0)
+    ScriptedSource src(keys);
+
+    size_t fed = 0;
+    for (int t = 0; t <= 6000; t += 10)
+    {
+        fed += game.feed_input(src, t);
+        game.advance(t);
+    }
+    CHECK(fed == keys.size());
+    PieceIndex::Reader snap(game.piece_index());
+    CHECK(snap->piece_at({5, 0}, 'W') == game.piece_index().slot_of("PW_(6,0)"));
+}
+
+TEST_CASE("FuzzSource stresses the players deterministically")
+{
+    set_log_enabled(false);
+    auto play = [](uint64_t seed)
+    {
+        Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+        game.reset_pieces(0);
+        FuzzSource fuzz(seed, 100);
+        size_t keys = 0;
+        for (int t = 0; t < 2000; ++t)
+        {
+            keys += game.feed_input(fuzz, t);
+            if (t % 16 == 0)
+                game.advance(t);
+        }
+        CHECK(keys == 200000);
+        return game.snapshot();
+    };
+    auto a = play(7);
+    CHECK(a == play(7));
+}
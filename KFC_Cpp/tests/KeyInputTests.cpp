@@ -0,0 +1,131 @@
+#include <doctest/doctest.h>
+
+#include "../src/Clock.hpp"
+#include "../src/KeyInput.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// A window event queue the test types into
+struct FakeWindow
+{
+    std::mutex mtx;
+    std::deque<int> keys;
+    int polls{0};
+
+    void type(int key)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        keys.push_back(key);
+    }
+    int poll()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++polls;
+        if (keys.empty())
+            return -1;
+        int k = keys.front();
+        keys.pop_front();
+        return k;
+    }
+};
+} // namespace
+
+TEST_CASE("dispatch_key stamps keys that come without a capture time")
+{
+    std::vector<std::pair<int, uint64_t>> got;
+    set_global_key_handler([&](int key, uint64_t ns)
+                           { got.emplace_back(key, ns); });
+    uint64_t before = clock_now_ns();
+    dispatch_key('w');
+    dispatch_key('s', 42);
+    set_global_key_handler(nullptr);
+    dispatch_key('a'); // no handler: dropped
+
+    REQUIRE(got.size() == 2);
+    CHECK(got[0].second >= before);
+    CHECK(got[1].second == 42);
+}
+
+TEST_CASE("InputPump reads the window queue on its own thread, without frames")
+{
+    FakeWindow window;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::pair<int, uint64_t>> got;
+    std::thread::id pump_thread;
+    set_window_key_poller([&]
+                          { return window.poll(); });
+    set_global_key_handler([&](int key, uint64_t ns)
+                           {
+        std::lock_guard<std::mutex> lock(mtx);
+        got.emplace_back(key, ns);
+        pump_thread = std::this_thread::get_id();
+        cv.notify_all(); });
+
+    CHECK_FALSE(input_pump_active());
+    InputPump pump;
+    pump.start(2000);
+    CHECK(input_pump_active());
+
+    uint64_t typed = clock_now_ns();
+    window.type(1072);
+    window.type(255); // "no key" from some backends: skipped
+    window.type(13);
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        REQUIRE(cv.wait_for(lock, std::chrono::seconds(2), [&]
+                            { return got.size() == 2; }));
+    }
+    pump.stop();
+    CHECK_FALSE(input_pump_active());
+    set_global_key_handler(nullptr);
+    set_window_key_poller(nullptr);
+
+    CHECK(got[0].first == 1072);
+    CHECK(got[1].first == 13);
+    CHECK(got[0].second >= typed);
+    CHECK(got[1].second >= got[0].second);
+    CHECK((pump_thread != std::this_thread::get_id()));
+    CHECK(pump.keys() == 2);
+    CHECK(window.polls > 1);
+}
+
+TEST_CASE("A window bound to its thread is read by that thread, not the pump")
+{
+    FakeWindow window;
+    std::vector<std::thread::id> threads;
+    std::mutex mtx;
+    set_window_key_poller([&]
+                          { return window.poll(); },
+                          /*owner_thread*/ true);
+    set_global_key_handler([&](int, uint64_t)
+                           {
+        std::lock_guard<std::mutex> lock(mtx);
+        threads.push_back(std::this_thread::get_id()); });
+
+    window.type(1072);
+    window.type(13);
+    InputPump pump;
+    pump.start(2000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pump.stop();
+    CHECK(pump.keys() == 0);
+    CHECK(window.polls == 0);
+
+    // The game loop drains it between frames, on its own thread
+    CHECK(drain_window_keys() == 2);
+    CHECK(drain_window_keys() == 0);
+    set_global_key_handler(nullptr);
+    set_window_key_poller(nullptr);
+    REQUIRE(threads.size() == 2);
+    CHECK((threads[0] == std::this_thread::get_id()));
+    CHECK((threads[1] == std::this_thread::get_id()));
+}
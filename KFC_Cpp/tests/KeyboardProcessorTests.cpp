@@ -99,4 +99,37 @@ TEST_CASE("KeyboardProcessor thread safety") {
 	CHECK(cur.first < 8);
 	CHECK(cur.second >= 0);
 	CHECK(cur.second < 8);
-}
\ No newline at end of file
+}
+TEST_CASE("Key codes cover raw window keys and keymap names") {
+	CHECK(key_code_from_raw(1072) == key_code::Up);
+	CHECK(key_code_from_raw(1077) == key_code::Right);
+	CHECK(key_code_from_raw(13) == key_code::Enter);
+	CHECK(key_code_from_raw('W') == 'w');
+	CHECK(key_code_from_raw(249) == 'a');
+	CHECK(key_code_from_raw(255) == key_code::None);
+	CHECK(key_code_from_raw(5000) == key_code::None);
+	for (const char* name : {"up", "down", "left", "right", "enter", "esc", "w", "+", " "})
+		CHECK(key_name(key_code_from_name(name)) == name);
+	CHECK(key_code_from_name("unknown_arrow") == key_code::None);
+}
+
+TEST_CASE("KeyboardProcessor compiled keymap and packed cursor") {
+	KeyboardProcessor kp(8, 8, { {"w","up"},{"d","right"},{"f","select"},{"g","jump"},{"enter","choose"} });
+	CHECK(kp.binds('w'));
+	CHECK_FALSE(kp.binds(key_code::Up));
+	CHECK(kp.process_code('f') == KeyAction::Select);
+	CHECK(kp.process_code('g') == KeyAction::Jump);
+	CHECK(kp.process_code(key_code::Enter) == KeyAction::Other);
+	CHECK(kp.process_key("enter") == "choose");
+	CHECK(kp.process_code(key_code::Up) == KeyAction::None);
+
+	CHECK(kp.process_code('d') == KeyAction::Right);
+	CHECK(kp.get_cursor() == std::pair<int, int>{0, 1});
+	kp.set_cursor({7, 6});
+	CHECK(kp.process_code('d') == KeyAction::Right);
+	CHECK(kp.process_code('d') == KeyAction::Right); // stays at the edge
+	CHECK(kp.get_cursor() == std::pair<int, int>{7, 7});
+	// Both halves keep their sign
+	kp.set_cursor({-1, 300});
+	CHECK(kp.get_cursor() == std::pair<int, int>{-1, 300});
+}
@@ -0,0 +1,104 @@
+#include <doctest/doctest.h>
+
+#include "../src/net/Match.hpp"
+#include "../src/img/MockImg.hpp"
+
+namespace
+{
+CmdMsg move_cmd(uint64_t seq, std::pair<int, int> from, std::pair<int, int> to)
+{
+    CmdMsg m;
+    m.seq = seq;
+    m.from = from;
+    m.to = to;
+    return m;
+}
+} // namespace
+
+TEST_CASE("FrameBuffer reassembles frames split at arbitrary points")
+{
+    std::vector<uint8_t> stream;
+    ByteWriter a;
+    write_cmd(a, move_cmd(7, {6, 4}, {5, 4}));
+    append_frame(stream, MsgType::Cmd, a);
+    append_frame(stream, MsgType::StatsReq, ByteWriter{});
+    ServerStatsMsg s;
+    s.games = 3;
+    s.busy_us = 123456789;
+    ByteWriter b;
+    write_stats(b, s);
+    append_frame(stream, MsgType::Stats, b);
+
+    // Feed one byte at a time: every frame must pop out exactly once
+    FrameBuffer fb;
+    std::vector<MsgType> seen;
+    MsgType type;
+    ByteReader r(nullptr, 0);
+    for (uint8_t byte : stream)
+    {
+        fb.append(&byte, 1);
+        while (fb.next(type, r))
+        {
+            seen.push_back(type);
+            if (type == MsgType::Cmd)
+            {
+                CmdMsg m = read_cmd(r);
+                CHECK(m.seq == 7);
+                CHECK(m.from == std::make_pair(6, 4));
+                CHECK(m.to == std::make_pair(5, 4));
+            }
+            else if (type == MsgType::Stats)
+            {
+                ServerStatsMsg got = read_stats(r);
+                CHECK(got.games == 3);
+                CHECK(got.busy_us == 123456789);
+            }
+            CHECK(r.remaining() == 0);
+        }
+    }
+    CHECK(seen == std::vector<MsgType>{MsgType::Cmd, MsgType::StatsReq, MsgType::Stats});
+
+    // A command kind the protocol does not define is malformed input
+    ByteWriter odd;
+    odd.varint(8);
+    odd.u8(7);
+    odd.cell({6, 4});
+    odd.cell({5, 4});
+    ByteReader odd_r(odd.data());
+    CHECK_THROWS(read_cmd(odd_r));
+
+    uint8_t garbage[5] = {0xFF, 0xFF, 0xFF, 0xFF, 1};
+    FrameBuffer bad;
+    bad.append(garbage, sizeof garbage);
+    CHECK_THROWS(bad.next(type, r));
+}
+
+TEST_CASE("Match validates commands on the server side")
+{
+    set_log_enabled(false);
+    auto match = create_match("../../pieces/", std::make_shared<MockImgFactory>());
+    Game &game = match->game();
+
+    CHECK(match->submit(1, move_cmd(1, {8, 0}, {5, 0}), 0) == Verdict::OutOfBounds);
+    CHECK(match->submit(1, move_cmd(2, {4, 4}, {3, 4}), 0) == Verdict::NoPiece);
+    CHECK(match->submit(2, move_cmd(3, {6, 4}, {5, 4}), 0) == Verdict::NotYourPiece);
+    CHECK(match->submit(1, move_cmd(4, {6, 4}, {3, 4}), 0) == Verdict::IllegalMove);
+    CmdMsg odd = move_cmd(4, {6, 4}, {5, 4});
+    odd.kind = static_cast<CmdKind>(7);
+    CHECK(match->submit(1, odd, 0) == Verdict::IllegalMove);
+    CHECK(match->submit(1, move_cmd(5, {6, 4}, {5, 4}), 0) == Verdict::Accepted);
+
+    // Once the command ran the pawn is in flight and refuses new orders
+    match->tick(16);
+    CHECK(match->submit(1, move_cmd(6, {6, 4}, {5, 4}), 32) == Verdict::Busy);
+    CHECK(match->winner() == 0);
+
+    // Remove the black king: white wins and everything is refused
+    game.pieces.erase(std::remove_if(game.pieces.begin(), game.pieces.end(),
+                                     [](const PiecePtr &p)
+                                     { return p->id.rfind("KB", 0) == 0; }),
+                      game.pieces.end());
+    CHECK(match->over());
+    CHECK(match->winner() == 1);
+    CHECK(match->submit(2, move_cmd(7, {1, 0}, {2, 0}), 48) == Verdict::GameOver);
+}
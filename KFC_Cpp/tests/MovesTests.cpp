@@ -53,4 +53,50 @@ TEST_CASE("Moves board bounds and path clear") {
     CHECK_FALSE(mv.is_valid({4,0},{4,-1},occupied));
     CHECK_FALSE(mv.is_valid({4,7},{4,8},occupied));
     std::remove(path.c_str());
-} 
\ No newline at end of file
+} 
+TEST_CASE("Moves rays reach the board edge and stop at the first blocker") {
+    std::string path = create_temp_moves_file(
+        "1,1*\n0,1*2:non_capture\n# a comment\n2,0  # trailing comment\n");
+    Moves mv(path, {16,16});
+    std::unordered_set<std::pair<int,int>, PairHash> occupied;
+
+    REQUIRE(mv.rays().size() == 2);
+    CHECK(mv.rays()[0].max_steps == 15); // bounded by the board, not the file
+    CHECK(mv.rays()[1].max_steps == 2);
+    CHECK(mv.offsets().size() == 1);
+
+    // Unlimited ray, on a board larger than 8x8
+    CHECK(mv.is_valid({0,0}, {15,15}, occupied));
+    CHECK_FALSE(mv.is_valid({0,0}, {15,14}, occupied));
+    CHECK_FALSE(mv.is_valid({0,0}, {-1,-1}, occupied)); // against the ray
+    occupied.insert({3,3});
+    CHECK_FALSE(mv.is_valid({0,0}, {5,5}, occupied));
+    CHECK(mv.is_valid({0,0}, {3,3}, occupied));         // the blocker itself
+    CHECK(mv.is_valid({0,0}, {5,5}, occupied, /*need_clear_path*/ false));
+
+    // Bounded ray with a tag
+    CHECK(mv.is_valid({4,4}, {4,6}, occupied));
+    CHECK_FALSE(mv.is_valid({4,4}, {4,7}, occupied));
+    CHECK_FALSE(mv.is_dst_cell_valid(0, 2, /*dst_has_piece*/ true));
+
+    // Plain offsets next to rays
+    CHECK(mv.is_valid({4,4}, {6,4}, occupied));
+    CHECK_FALSE(mv.is_valid({4,4}, {8,4}, occupied));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Moves rays with longer steps land on multiples only") {
+    std::string path = create_temp_moves_file("1,2*3\n");
+    Moves mv(path, {8,8});
+    std::unordered_set<std::pair<int,int>, PairHash> occupied{{2,4}};
+
+    CHECK(mv.is_dst_cell_valid(1, 2, false));
+    CHECK(mv.is_dst_cell_valid(3, 6, false));
+    CHECK_FALSE(mv.is_dst_cell_valid(4, 8, false)); // past 3 steps
+    CHECK_FALSE(mv.is_dst_cell_valid(2, 3, false));
+    CHECK_FALSE(mv.is_dst_cell_valid(0, 2, false));
+    // Only landing cells block: (1,2) and (2,4) on the way to (3,6)
+    CHECK(mv.path_is_clear({0,0}, {2,4}, occupied));
+    CHECK_FALSE(mv.path_is_clear({0,0}, {3,6}, occupied));
+    std::remove(path.c_str());
+}
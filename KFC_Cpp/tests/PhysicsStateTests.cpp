@@ -34,11 +34,11 @@ TEST_CASE("MovePhysics full cycle") {
     phys.reset(cmd);
 
     // halfway (1 s) – still moving
-    CHECK(phys.update(1000).get() == nullptr);
+    CHECK(phys.update(1000) == nullptr);
 
     // Slightly beyond expected duration (2.1s) – should emit done
-    auto done = phys.update(2100);
-    CHECK(done.get());
+    const Command *done = phys.update(2100);
+    REQUIRE(done);
     CHECK(done->type == "done");
     CHECK(phys.get_curr_cell() == pair<int,int>{0,2});
 }
@@ -81,12 +81,13 @@ TEST_CASE("State transition idle→move→idle via internal done") {
 
     Piece piece("PX", idle);
 
+    Cell2Pieces cell2piece;
     Command mv(0, piece.id, "move", {{0,0},{0,1}});
-    piece.on_command(mv, Cell2Pieces{});
+    piece.on_command(mv, cell2piece);
     CHECK(piece.state == move);
 
     // advance 2s so move ends
-    piece.update(2100,Cell2Pieces{});
+    piece.update(2100, cell2piece);
     CHECK(piece.state == idle);
 } 
 
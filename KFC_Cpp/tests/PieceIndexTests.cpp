@@ -0,0 +1,102 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/KeyboardProducer.hpp"
+#include "../src/Log.hpp"
+#include "../src/PieceIndex.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("PieceIndex finds pieces by cell and colour after every step")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    const PieceIndex &index = game.piece_index();
+
+    {
+        PieceIndex::Reader snap(index);
+        int pawn = snap->piece_at({6, 0}, 'W');
+        REQUIRE(pawn != PieceIndex::kNone);
+        CHECK(index.id_of(pawn) == "PW_(6,0)");
+        CHECK(snap->piece_at({6, 0}, 'B') == PieceIndex::kNone);
+        CHECK(snap->piece_at({4, 4}, 'W') == PieceIndex::kNone);
+        CHECK(snap->piece_at({8, 0}, 'W') == PieceIndex::kNone);
+        CHECK(snap->cell_of(index.slot_of("KB_(0,3)")) == std::pair<int, int>{0, 3});
+    }
+
+    game.enqueue_command(Command{0, "PW_(6,0)", "move", {{6, 0}, {5, 0}}});
+    for (int t = 0; t <= 6000; t += 100)
+        game.advance(t);
+    PieceIndex::Reader snap(index);
+    CHECK(snap->tick_ms == 6000);
+    CHECK(snap->piece_at({5, 0}, 'W') == index.slot_of("PW_(6,0)"));
+    CHECK(snap->piece_at({6, 0}, 'W') == PieceIndex::kNone);
+    CHECK(index.slot_of("nope") == PieceIndex::kNone);
+}
+
+TEST_CASE("PieceIndex readers keep a consistent snapshot while the game steps")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    const PieceIndex &index = game.piece_index();
+
+    PieceIndex::Reader pinned(index);
+    uint64_t epoch = pinned->epoch;
+    int rook = index.slot_of("RW_(7,0)");
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0}, reads{0};
+    std::thread reader([&]
+                       {
+        while (!stop.load())
+        {
+            PieceIndex::Reader snap(index);
+            // The rook never moves; every published snapshot has it
+            if (snap->cell_of(rook) != std::pair<int, int>{7, 0} || snap->piece_at({7, 0}, 'W') != rook)
+                ++bad;
+            ++reads;
+        } });
+    for (int t = 0; t < 2000 || reads.load() < 100; t += 16)
+        game.advance(t);
+    stop = true;
+    reader.join();
+    CHECK(bad.load() == 0);
+
+    // A pinned snapshot is never refilled
+    CHECK(pinned->epoch == epoch);
+    PieceIndex::Reader latest(index);
+    CHECK(latest->epoch > epoch);
+}
+
+TEST_CASE("KeyboardProducer selects through the published index")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+
+    std::vector<Command> queue;
+    std::mutex mtx;
+    KeyboardProcessor kp(8, 8, {{"enter", "select"}});
+    KeyboardProducer producer(queue, mtx, kp, 2);
+    producer.set_piece_index(&game.piece_index());
+
+    kp.set_cursor({6, 0}); // a white pawn: not player 2's
+    producer.handle_key_event("enter");
+    CHECK(producer.get_selected_id().empty());
+
+    kp.set_cursor({1, 0});
+    producer.handle_key_event("enter");
+    CHECK(producer.get_selected_id() == "PB_(1,0)");
+    kp.set_cursor({2, 0});
+    producer.handle_key_event("enter");
+    REQUIRE(queue.size() == 1);
+    CHECK(queue[0].piece_id == "PB_(1,0)");
+    CHECK(queue[0].params[0] == std::pair<int, int>{1, 0});
+}
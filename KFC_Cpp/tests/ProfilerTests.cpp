@@ -0,0 +1,78 @@
+#include <doctest/doctest.h>
+
+#include "../src/Profiler.hpp"
+#include "../src/Game.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+TEST_CASE("LatencyHistogram buckets are contiguous and percentiles are within 1/16")
+{
+    for (uint64_t v = 0; v < 100000; ++v)
+    {
+        size_t i = LatencyHistogram::index(v);
+        CHECK(LatencyHistogram::lower_bound(i) <= v);
+        if (i + 1 < LatencyHistogram::kBuckets)
+            CHECK(v < LatencyHistogram::lower_bound(i + 1));
+    }
+
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 1000000; ++v)
+        h.record(v);
+    CHECK(h.count() == 1000000);
+    CHECK(h.max() == 1000000);
+    CHECK(h.mean() == doctest::Approx(500000.5));
+    for (double q : {0.5, 0.9, 0.99, 0.999})
+    {
+        double expected = q * 1000000.0;
+        CHECK(std::abs(static_cast<double>(h.percentile(q)) - expected) <= expected / 16.0);
+    }
+    h.reset();
+    CHECK(h.count() == 0);
+    CHECK(h.percentile(0.5) == 0);
+}
+
+TEST_CASE("LatencyHistogram records from several threads without locks")
+{
+    LatencyHistogram h;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&h, t]
+                             {
+                                 for (uint64_t i = 0; i < 50000; ++i)
+                                     h.record(1000 * (t + 1)); });
+    for (auto &th : threads)
+        th.join();
+    CHECK(h.count() == 200000);
+    CHECK(h.max() == 4000);
+}
+
+TEST_CASE("Tick profiler covers every simulation phase and stays cheap")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    game.profiler.set_enabled(true);
+    for (int t = 0; t < 1600; t += 16)
+        game.advance(t);
+    for (TickPhase p : {TickPhase::Pieces, TickPhase::Commands, TickPhase::Collisions})
+        CHECK(game.profiler.histogram(p).count() == 100);
+    CHECK(game.profiler.hud_lines().size() == 1 + static_cast<size_t>(TickPhase::Count));
+
+    // Cost of the six scopes of one rendered tick against the 16 ms frame
+    FrameProfiler prof;
+    prof.set_enabled(true);
+    const int n = 100000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        ProfileScope s(prof, TickPhase::Render);
+    }
+    double ns_per_scope = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+    double per_tick = 6 * ns_per_scope;
+    MESSAGE("profiler: " << ns_per_scope << " ns per scope, " << per_tick / 16e6 * 100 << "% of a 16 ms tick");
+    CHECK(per_tick < 0.01 * 16e6);
+}
@@ -0,0 +1,160 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <memory>
+#include <utility>
+
+namespace
+{
+// Sizes as loaded and draws checked against the target, as OpenCvImg
+// does: a sprite that does not fit is dropped
+struct Draws
+{
+    int fitted{0}, dropped{0}, wrong_size{0};
+    int expect_px{0}; // sprite size expected on the board, 0 = any
+};
+
+class SizedImg : public MockImg
+{
+public:
+    SizedImg(std::pair<int, int> size, std::shared_ptr<Draws> draws) : MockImg(size), draws(std::move(draws)) {}
+    void draw_on(Img &dst, int x, int y) override
+    {
+        auto s = size(), d = dst.size();
+        if (x < 0 || y < 0 || x + s.first > d.first || y + s.second > d.second)
+            ++draws->dropped;
+        else
+            ++draws->fitted;
+        if (draws->expect_px && s != std::make_pair(draws->expect_px, draws->expect_px))
+            ++draws->wrong_size;
+    }
+    ImgPtr clone() const override { return std::make_shared<SizedImg>(size(), draws); }
+    ImgPtr resized(int w, int h) const override { return std::make_shared<SizedImg>(std::make_pair(w, h), draws); }
+
+private:
+    std::shared_ptr<Draws> draws;
+};
+
+class SizedImgFactory : public ImgFactory
+{
+public:
+    explicit SizedImgFactory(std::shared_ptr<Draws> draws) : draws(std::move(draws)) {}
+    ImgPtr load(const std::string &, const std::pair<int, int> &size) override
+    {
+        return std::make_shared<SizedImg>(size.first > 0 ? size : std::make_pair(64, 64), draws);
+    }
+    ImgPtr create_blank(int w, int h) const override { return std::make_shared<SizedImg>(std::make_pair(w, h), draws); }
+
+private:
+    std::shared_ptr<Draws> draws;
+};
+} // namespace
+
+TEST_CASE("render_frame redraws only the layers that changed")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    game.setup_players();
+    const auto &st = game.layer_stats;
+
+    game.render_frame(0);
+    CHECK(st.piece_redraws == 1);
+    CHECK(st.overlay_redraws == 1);
+
+    // Nothing changed: the previous frame is reused
+    game.render_frame(0);
+    CHECK(st.frames == 2);
+    CHECK(st.piece_redraws == 1);
+    CHECK(st.overlay_redraws == 1);
+
+    // A cursor moved: overlay only
+    game.kp1->set_cursor({3, 3});
+    game.render_frame(0);
+    CHECK(st.piece_redraws == 1);
+    CHECK(st.overlay_redraws == 2);
+
+    // A selection shows up on the overlay as well
+    game.kb_prod_2->set_selection("PB_(1,0)", {1, 0});
+    CHECK(game.kb_prod_2->get_display_selection() == std::pair<int, int>{1, 0});
+    game.render_frame(0);
+    CHECK(st.piece_redraws == 1);
+    CHECK(st.overlay_redraws == 3);
+
+    // A moving piece redraws the piece layer and the overlay over it
+    game.enqueue_command(Command{0, "PW_(6,0)", "move", {{6, 0}, {5, 0}}});
+    game.advance(0);
+    game.advance(200);
+    game.render_frame(200);
+    CHECK(st.piece_redraws == 2);
+    CHECK(st.overlay_redraws == 4);
+}
+
+TEST_CASE("A zoomed view draws pre-scaled sprites and keeps the layer caching")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    game.setup_players();
+    const auto &st = game.layer_stats;
+    int native = game.view_cell_px();
+
+    game.render_frame(0);
+    REQUIRE(game.set_view_cell_px(native * 2));
+    CHECK(game.view_cell_px() == native * 2);
+
+    // The first zoomed frame rebuilds both layers at the new size
+    Board frame = game.render_frame(0);
+    CHECK(st.piece_redraws == 2);
+    CHECK(st.overlay_redraws == 2);
+    CHECK(frame.cell_W_pix == native * 2);
+    CHECK(frame.img->size() == std::pair<int, int>{frame.W_cells * native * 2, frame.H_cells * native * 2});
+    game.render_frame(0);
+    CHECK(st.piece_redraws == 2);
+    CHECK(st.overlay_redraws == 2);
+
+    // Back to native
+    REQUIRE(game.set_view_cell_px(0));
+    CHECK(game.view_cell_px() == native);
+    frame = game.render_frame(0);
+    CHECK(frame.cell_W_pix == native);
+    CHECK(st.piece_redraws == 3);
+}
+
+TEST_CASE("GraphicsFactory shares sprites between pieces of a kind")
+{
+    GraphicsFactory gf(std::make_shared<MockImgFactory>());
+    auto a = gf.load("../../pieces/PW/states/idle/sprites", {}, {64, 64});
+    auto b = gf.load("../../pieces/PW/states/idle/sprites", {}, {64, 64});
+    REQUIRE(a->level_count() == GraphicsFactory::default_sprite_scales().size());
+    CHECK(a->get_img() == b->get_img());
+    CHECK(a->level_img(a->source_level(32)) == b->level_img(b->source_level(32)));
+    CHECK(a->level_img(a->source_level(32))->size() == std::pair<int, int>{32, 32});
+    CHECK(a->level_img(a->source_level(128))->size() == std::pair<int, int>{128, 128});
+}
+
+TEST_CASE("A view size with no sprite level still fits every piece in its cell")
+{
+    set_log_enabled(false);
+    auto draws = std::make_shared<Draws>();
+    Game game = create_game("../../pieces/", std::make_shared<SizedImgFactory>(draws));
+    game.reset_pieces(0);
+    REQUIRE(game.view_cell_px() == 64); // levels of 64, 32 and 128 px
+
+    for (int px : {100, 40})
+    {
+        CAPTURE(px);
+        *draws = Draws{};
+        draws->expect_px = px;
+        REQUIRE(game.set_view_cell_px(px));
+        Board frame = game.render_frame(0);
+        CHECK(frame.img->size() == std::pair<int, int>{8 * px, 8 * px});
+        // Both back rows included: last row and column sit flush with the edge
+        CHECK(draws->fitted == static_cast<int>(game.pieces.size()));
+        CHECK(draws->dropped == 0);
+        CHECK(draws->wrong_size == 0);
+    }
+}
@@ -0,0 +1,133 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/Log.hpp"
+#include "../src/ReplayExport.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::string record_short_game(const std::string &name)
+{
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.set_journal(create_journal(path, "../../pieces/"));
+    game.reset_pieces(0);
+    std::vector<Command> script = {
+        Command{100, "PW_(6,4)", "move", {{6, 4}, {4, 4}}},
+        Command{150, "PB_(1,3)", "move", {{1, 3}, {3, 3}}},
+        Command{400, "NW_(7,6)", "move", {{7, 6}, {5, 5}}},
+    };
+    size_t next = 0;
+    for (int t = 0; t <= 3000; t += 16)
+    {
+        while (next < script.size() && script[next].timestamp <= t)
+            game.enqueue_command(script[next++]);
+        game.advance(t);
+    }
+    return path;
+}
+
+class CollectingSink : public FrameSink
+{
+public:
+    explicit CollectingSink(bool concurrent_writes = false, int fail_at = -1)
+        : concurrent_writes(concurrent_writes), fail_at(fail_at) {}
+
+    void write(const Img &, int index) override
+    {
+        if (index == fail_at)
+            throw std::runtime_error("disk full");
+        std::lock_guard<std::mutex> lock(mu);
+        indices.push_back(index);
+        writers.push_back(std::this_thread::get_id());
+    }
+    bool concurrent() const override { return concurrent_writes; }
+    void finish() override { finished = true; }
+
+    bool concurrent_writes;
+    int fail_at;
+    std::mutex mu;
+    std::vector<int> indices;
+    std::vector<std::thread::id> writers;
+    bool finished{false};
+};
+} // namespace
+
+TEST_CASE("Replay export films the whole game at a fixed rate, in order")
+{
+    set_log_enabled(false);
+    std::string path = record_short_game("kfc_export_ordered.bin");
+
+    JournalReader plain_reader(path);
+    Game plain = create_replay_game(plain_reader, "../../pieces/", std::make_shared<MockImgFactory>());
+    ReplayStats plain_stats = replay_journal(plain, plain_reader);
+
+    JournalReader reader(path);
+    Game game = create_replay_game(reader, "../../pieces/", std::make_shared<MockImgFactory>());
+    CollectingSink sink;
+    ExportOptions opts;
+    opts.fps = 25;
+    opts.tail_ms = 400;
+    opts.encode_threads = 4; // a video sink still gets one, in order
+    ExportStats stats = export_replay(game, reader, sink, opts);
+
+    // Reset at 0, last step at final_ms, 40 ms frames through the tail
+    size_t expected = static_cast<size_t>((plain_stats.final_ms + opts.tail_ms) / 40) + 1;
+    CHECK(stats.frames == expected);
+    CHECK(stats.ticks == plain_stats.ticks);
+    CHECK(stats.commands == 3);
+    CHECK(sink.finished);
+    REQUIRE(sink.indices.size() == expected);
+    for (size_t i = 0; i < sink.indices.size(); ++i)
+        CHECK(sink.indices[i] == static_cast<int>(i));
+    // Encoded off the render thread
+    CHECK((sink.writers.front() != std::this_thread::get_id()));
+    CHECK(std::all_of(sink.writers.begin(), sink.writers.end(), [&](std::thread::id id)
+                      { return id == sink.writers.front(); }));
+
+    // Filming does not change the game
+    for (size_t i = 0; i < game.pieces.size(); ++i)
+        CHECK(game.pieces[i]->current_cell() == plain.pieces[i]->current_cell());
+    set_log_enabled(true);
+}
+
+TEST_CASE("Concurrent sinks get every frame once; encoder errors stop the export")
+{
+    set_log_enabled(false);
+    std::string path = record_short_game("kfc_export_concurrent.bin");
+    ExportOptions opts;
+    opts.fps = 60;
+    opts.encode_threads = 3;
+    opts.queue_depth = 2;
+
+    {
+        JournalReader reader(path);
+        Game game = create_replay_game(reader, "../../pieces/", std::make_shared<MockImgFactory>());
+        CollectingSink sink(/*concurrent*/ true);
+        ExportStats stats = export_replay(game, reader, sink, opts);
+        std::vector<int> got = sink.indices;
+        std::sort(got.begin(), got.end());
+        REQUIRE(got.size() == stats.frames);
+        for (size_t i = 0; i < got.size(); ++i)
+            CHECK(got[i] == static_cast<int>(i));
+    }
+    {
+        JournalReader reader(path);
+        Game game = create_replay_game(reader, "../../pieces/", std::make_shared<MockImgFactory>());
+        CollectingSink sink(/*concurrent*/ false, /*fail_at*/ 10);
+        CHECK_THROWS_AS(export_replay(game, reader, sink, opts), std::runtime_error);
+        CHECK_FALSE(sink.finished);
+        CHECK(sink.indices.size() == 10);
+    }
+    set_log_enabled(true);
+}
@@ -0,0 +1,117 @@
+#include <doctest/doctest.h>
+
+#include "../src/Game.hpp"
+#include "../src/Log.hpp"
+#include "../src/ReservationTable.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using Span = std::tuple<std::pair<int, int>, int, int>;
+
+std::vector<Span> path(std::pair<int, int> from, std::pair<int, int> to, int start, int duration)
+{
+    std::vector<Span> out;
+    ReservationTable::trace_path(from, to, start, duration, [&](std::pair<int, int> c, int t0, int t1)
+                                 { out.emplace_back(c, t0, t1); });
+    return out;
+}
+} // namespace
+
+TEST_CASE("trace_path follows the cells a moving piece reports")
+{
+    const int F = ReservationTable::kForever;
+    // Stepping down the board enters each cell on reaching it
+    CHECK(path({2, 0}, {5, 0}, 100, 300) ==
+          std::vector<Span>{{{2, 0}, 100, 200}, {{3, 0}, 200, 300}, {{4, 0}, 300, 400}, {{5, 0}, 400, F}});
+    // Stepping up leaves the source cell at once
+    CHECK(path({5, 0}, {2, 0}, 100, 300) ==
+          std::vector<Span>{{{4, 0}, 100, 200}, {{3, 0}, 200, 300}, {{2, 0}, 300, F}});
+    // Diagonals cross both axes together
+    CHECK(path({0, 0}, {2, 2}, 0, 200) == std::vector<Span>{{{0, 0}, 0, 100}, {{1, 1}, 100, 200}, {{2, 2}, 200, F}});
+    // A knight's line passes one cell on the way
+    CHECK(path({0, 0}, {2, 1}, 0, 100) == std::vector<Span>{{{0, 0}, 0, 50}, {{1, 0}, 50, 100}, {{2, 1}, 100, F}});
+}
+
+TEST_CASE("ReservationTable answers free-at-time queries and releases cleanly")
+{
+    ReservationTable t(8, 8, 4);
+    t.reserve_move(1, {6, 4}, {4, 4}, 1000, 2000); // (5,4) from 1000, (4,4) from 2000
+    t.reserve_move(2, {0, 4}, {3, 4}, 1000, 3000);
+    CHECK(t.moves_in_flight() == 2);
+    CHECK(t.moving(1));
+    CHECK_FALSE(t.moving(0));
+
+    CHECK_FALSE(t.is_free({5, 4}, 1500));
+    CHECK(t.holder({5, 4}, 1500) == 1);
+    CHECK(t.is_free({5, 4}, 1500, /*except*/ 1));
+    CHECK(t.is_free({5, 4}, 2500));
+    CHECK_FALSE(t.is_free({4, 4}, 100000)); // held from arrival on
+    CHECK(t.is_free({4, 4}, 1999));
+    CHECK(t.free_from({1, 4}, 1500) == 1500);
+    CHECK(t.free_from({1, 4}, 2500) == 3000);
+    CHECK(t.free_from({3, 4}, 5000) == ReservationTable::kForever);
+
+    // A new move replaces the old one
+    t.reserve_move(1, {6, 4}, {6, 5}, 1200, 1000);
+    CHECK(t.moves_in_flight() == 2);
+    CHECK(t.is_free({5, 4}, 1500));
+    CHECK_FALSE(t.is_free({6, 5}, 2200));
+
+    t.release(2);
+    t.release(2);
+    CHECK(t.moves_in_flight() == 1);
+    CHECK(t.windows({1, 4}).empty());
+    t.clear();
+    CHECK(t.moves_in_flight() == 0);
+    CHECK(t.windows({6, 5}).empty());
+}
+
+TEST_CASE("Game keeps reservations for moves in flight")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    int pawn = game.piece_index().slot_of("PW_(6,4)");
+    const auto &res = game.reservations();
+
+    CHECK(game.cell_free_at({4, 4}, 100));
+    CHECK_FALSE(game.cell_free_at({6, 4}, 100)); // the pawn rests there
+
+    game.enqueue_command(Command{0, "PW_(6,4)", "move", {{6, 4}, {4, 4}}});
+    game.advance(0);
+    REQUIRE(res.moving(pawn));
+    CHECK(res.moves_in_flight() == 1);
+    // Moving up the board, the pawn is on (4,4) from half way
+    int arrival = res.windows({4, 4}).at(0).from_ms;
+    CHECK(arrival > 0);
+    CHECK(res.holder({5, 4}, arrival - 1) == pawn);
+    CHECK_FALSE(game.cell_free_at({4, 4}, arrival));
+    CHECK(game.cell_free_at({4, 4}, arrival - 1));
+    CHECK(game.cell_free_at({6, 4}, arrival)); // it is leaving
+
+    // Arrived: the pawn rests on its new cell
+    int t = 0;
+    while (res.moving(pawn) && t < 10000)
+        game.advance(t += 16);
+    CHECK(t > arrival);
+    CHECK_FALSE(res.moving(pawn));
+    CHECK(res.moves_in_flight() == 0);
+    CHECK_FALSE(game.cell_free_at({4, 4}, t + 100000));
+    CHECK(game.cell_free_at({6, 4}, t + 100000));
+
+    // Snapshots restore the moves in flight
+    game.enqueue_command(Command{t + 2000, "PB_(1,3)", "move", {{1, 3}, {3, 3}}});
+    game.advance(t + 2000);
+    auto snap = game.snapshot();
+    game.reset_pieces(0);
+    CHECK(res.moves_in_flight() == 0);
+    game.restore(snap);
+    CHECK(res.moving(game.piece_index().slot_of("PB_(1,3)")));
+    set_log_enabled(true);
+}
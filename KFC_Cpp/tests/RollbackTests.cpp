@@ -0,0 +1,111 @@
+#include <doctest/doctest.h>
+
+#include "../src/net/RollbackSession.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <vector>
+
+namespace
+{
+struct Issued
+{
+    int at_ms;
+    int player;
+    Command cmd;
+};
+
+// Both sides open and then trade a capture
+const std::vector<Issued> kScript = {
+    {100, 1, Command{0, "PW_(6,4)", "move", {{6, 4}, {4, 4}}}},
+    {110, 2, Command{0, "PB_(1,3)", "move", {{1, 3}, {3, 3}}}},
+    {400, 1, Command{0, "NW_(7,6)", "move", {{7, 6}, {5, 5}}}},
+    {420, 2, Command{0, "NB_(0,1)", "move", {{0, 1}, {2, 2}}}},
+    {4000, 1, Command{0, "PW_(6,4)", "move", {{4, 4}, {3, 3}}}},
+    {4004, 2, Command{0, "PB_(1,0)", "jump", {{1, 0}}}},
+    {4010, 2, Command{0, "PB_(1,3)", "move", {{3, 3}, {4, 4}}}},
+};
+
+struct Peers
+{
+    Game white = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    Game black = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+};
+
+// Run both peers over the link in 1 ms steps of virtual time
+void play(Peers &p, LoopbackLink &link, RollbackConfig cfg, RollbackStats &ws, RollbackStats &bs)
+{
+    p.white.reset_pieces(0);
+    p.black.reset_pieces(0);
+    RollbackConfig wc = cfg, bc = cfg;
+    wc.player = 1;
+    bc.player = 2;
+    RollbackSession w(p.white, link.end(0), wc);
+    RollbackSession b(p.black, link.end(1), bc);
+
+    size_t next = 0;
+    for (int now = 0; now <= 8000; ++now)
+    {
+        for (; next < kScript.size() && kScript[next].at_ms == now; ++next)
+        {
+            const Issued &e = kScript[next];
+            CHECK((e.player == 1 ? w : b).local_command(e.cmd, now));
+        }
+        w.advance_to(now);
+        b.advance_to(now);
+    }
+    CHECK(link.idle());
+    ws = w.stats();
+    bs = b.stats();
+}
+} // namespace
+
+TEST_CASE("Rollback peers converge over a laggy link")
+{
+    set_log_enabled(false);
+    Peers peers;
+    LoopbackLink link(90, 40, 7);
+    RollbackConfig cfg;
+    cfg.input_delay_ms = 32;
+    RollbackStats ws, bs;
+    play(peers, link, cfg, ws, bs);
+
+    CHECK(peers.white.snapshot() == peers.black.snapshot());
+    CHECK(peers.white.pieces.size() < 32); // the capture happened on both sides
+
+    // Latency beyond the input delay forces rollbacks on both peers
+    CHECK(ws.rollbacks > 0);
+    CHECK(bs.rollbacks > 0);
+    CHECK(ws.too_late == 0);
+    CHECK(bs.too_late == 0);
+    // 130 ms worst-case latency - 32 ms delay, in 16 ms ticks
+    CHECK(ws.max_depth_ticks <= 8);
+    MESSAGE("rollbacks " << ws.rollbacks + bs.rollbacks << ", max depth " << std::max(ws.max_depth_ticks, bs.max_depth_ticks)
+                         << " ticks, " << (ws.resim_ns + bs.resim_ns) / 1000 << " us re-simulating");
+}
+
+TEST_CASE("Input delay covering the latency avoids rollbacks")
+{
+    set_log_enabled(false);
+    Peers peers;
+    LoopbackLink link(40, 0);
+    RollbackConfig cfg;
+    cfg.input_delay_ms = 48;
+    RollbackStats ws, bs;
+    play(peers, link, cfg, ws, bs);
+
+    CHECK(peers.white.snapshot() == peers.black.snapshot());
+    CHECK(ws.rollbacks == 0);
+    CHECK(bs.rollbacks == 0);
+    CHECK(ws.ticks == 8000 / 16);
+}
+
+TEST_CASE("Rollback session refuses the opponent's pieces")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    LoopbackLink link(10);
+    RollbackSession session(game, link.end(0));
+    CHECK_FALSE(session.local_command(Command{0, "PB_(1,0)", "move", {{1, 0}, {2, 0}}}, 0));
+    CHECK(session.local_command(Command{0, "PW_(6,0)", "move", {{6, 0}, {5, 0}}}, 0));
+}
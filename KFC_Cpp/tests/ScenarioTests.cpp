@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+
+#include "../bench/Scenarios.hpp"
+#include "../src/Game.hpp"
+#include "../src/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Outcome
+{
+    std::vector<std::string> captured;                     // in board order
+    std::map<std::string, std::pair<int, int>> cell_of_id; // the survivors
+};
+
+// Plays sc as kungfu_chess_scenarios does, in 16 ms steps
+Outcome play(const Scenario &sc)
+{
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+    std::vector<PiecePtr> start = game.pieces;
+    size_t next = 0;
+    for (int t = 0; t <= sc.duration_ms; t += 16)
+    {
+        while (next < sc.commands.size() && sc.commands[next].timestamp <= t)
+            game.enqueue_command(sc.commands[next++]);
+        game.advance(t);
+    }
+    Outcome out;
+    for (const auto &p : start)
+        if (std::find(game.pieces.begin(), game.pieces.end(), p) == game.pieces.end())
+            out.captured.push_back(p->id);
+    for (const auto &p : game.pieces)
+        out.cell_of_id[p->id] = p->current_cell();
+    return out;
+}
+
+// Nothing captured, and every piece the script sends ends where it was sent
+void check_quiet(const Scenario &sc)
+{
+    Outcome out = play(sc);
+    CHECK(out.captured.empty());
+    std::map<std::string, std::pair<int, int>> sent_to;
+    for (const auto &cmd : sc.commands)
+        sent_to[cmd.piece_id] = cmd.params.back();
+    for (const auto &kv : sent_to)
+    {
+        INFO(sc.name << ": " << kv.first);
+        CHECK(out.cell_of_id[kv.first] == kv.second);
+    }
+}
+} // namespace
+
+TEST_CASE("Quiet scenarios move every piece they name and capture nothing")
+{
+    set_log_enabled(false);
+    check_quiet(scenario_opening());
+    check_quiet(scenario_pawn_push());
+    check_quiet(scenario_all_at_once());
+    CHECK(play(scenario_idle()).captured.empty());
+    set_log_enabled(true);
+}
+
+TEST_CASE("The capture storm ends with the same six pieces taken")
+{
+    set_log_enabled(false);
+    Outcome out = play(scenario_capture_storm());
+    // Two black pawns at the raids' ends; two white pawns and both white
+    // knights on the way
+    CHECK(out.captured == std::vector<std::string>{"PB_(1,1)", "PB_(1,6)", "PW_(6,2)", "PW_(6,5)", "NW_(7,1)",
+                                                   "NW_(7,6)"});
+    set_log_enabled(true);
+}
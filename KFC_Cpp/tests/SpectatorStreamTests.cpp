@@ -0,0 +1,114 @@
+#include <doctest/doctest.h>
+
+#include "../src/net/SpectatorStream.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace
+{
+const std::vector<Command> kScript = {
+    Command{100, "PW_(6,4)", "move", {{6, 4}, {4, 4}}},
+    Command{150, "PB_(1,3)", "move", {{1, 3}, {3, 3}}},
+    Command{400, "NW_(7,6)", "move", {{7, 6}, {5, 5}}},
+    Command{4000, "PW_(6,4)", "move", {{4, 4}, {3, 3}}},
+    Command{4100, "PB_(1,0)", "jump", {{1, 0}}},
+};
+
+// Every live piece of the game must appear in the view exactly as it is
+void check_view(const Game &game, const SpectatorView &view)
+{
+    CHECK(view.time_ms == game.sim_time_ms());
+    size_t alive = 0;
+    for (const auto &v : view.pieces)
+        alive += v.alive ? 1 : 0;
+    REQUIRE(alive == game.pieces.size());
+    for (const auto &p : game.pieces)
+    {
+        auto it = std::find_if(view.pieces.begin(), view.pieces.end(),
+                               [&](const PieceView &v)
+                               { return v.alive && v.id == p->id; });
+        REQUIRE(it != view.pieces.end());
+        CHECK(it->state == p->state->name);
+        CHECK(it->cell == p->current_cell());
+        CHECK(it->pix == p->state->physics->get_pos_pix());
+    }
+}
+} // namespace
+
+TEST_CASE("Spectator stream decodes to the live game at every tick")
+{
+    set_log_enabled(false);
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+    game.reset_pieces(0);
+
+    SpectatorEncoder encoder(1000);
+    SpectatorDecoder from_start, late_joiner;
+    ByteWriter frame;
+    size_t total_bytes = 0, frames = 0, ticks = 0;
+    std::chrono::nanoseconds encode_time{0};
+
+    size_t next = 0;
+    const int end_ms = 8000;
+    for (int t = 0; t <= end_ms; t += 16, ++ticks)
+    {
+        while (next < kScript.size() && kScript[next].timestamp <= t)
+            game.enqueue_command(kScript[next++]);
+        game.advance(t);
+
+        frame.clear();
+        auto t0 = std::chrono::steady_clock::now();
+        size_t n = encoder.encode(game, frame);
+        encode_time += std::chrono::steady_clock::now() - t0;
+        if (n == 0)
+            continue;
+        total_bytes += n;
+        ++frames;
+
+        REQUIRE(from_start.apply(frame.data()));
+        check_view(game, from_start.view());
+        // A viewer tuning in mid-game waits for the next keyframe
+        if (t >= 2500)
+        {
+            bool synced = late_joiner.apply(frame.data());
+            CHECK(synced == late_joiner.synced_yet());
+            if (synced)
+                check_view(game, late_joiner.view());
+        }
+    }
+    CHECK(late_joiner.synced_yet());
+    CHECK(next == kScript.size());
+
+    // Captures went through the stream as dead slots
+    CHECK(game.pieces.size() < 32);
+
+    double seconds = end_ms / 1000.0;
+    double us_per_tick = std::chrono::duration<double, std::micro>(encode_time).count() / static_cast<double>(ticks);
+    MESSAGE("spectator stream: " << total_bytes / seconds << " B/s, " << frames << " frames, "
+                                 << us_per_tick << " us encode per tick");
+    // One keyframe is ~700 bytes; deltas must keep the rest far below a
+    // keyframe per second
+    CHECK(total_bytes / seconds < 2000.0);
+}
+
+TEST_CASE("Spectator stream rejects frames that reference unknown slots")
+{
+    ByteWriter w;
+    w.u8(spectator_stream::kKeyframe);
+    w.svarint(0);
+    w.varint(0); // no names
+    w.varint(0); // no pieces
+    SpectatorDecoder decoder;
+    REQUIRE(decoder.apply(w.data()));
+
+    ByteWriter bad;
+    bad.u8(0);
+    bad.svarint(16);
+    bad.varint(1);
+    bad.varint(5); // slot 5 of an empty view
+    bad.u8(spectator_stream::kCell);
+    bad.svarint(1);
+    bad.svarint(0);
+    CHECK_THROWS(decoder.apply(bad.data()));
+}
@@ -0,0 +1,72 @@
+#include <doctest/doctest.h>
+
+#include "../src/Tracer.hpp"
+#include "../src/Game.hpp"
+#include "../src/img/MockImg.hpp"
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+TEST_CASE("Trace export covers loop phases, threads and piece states")
+{
+    set_log_enabled(false);
+    std::string path = (std::filesystem::temp_directory_path() / "kfc_trace.json").string();
+    Game game = create_game("../../pieces/", std::make_shared<MockImgFactory>());
+
+    trace_start(path);
+    trace_thread_name("test main");
+    game.reset_pieces(0);
+    game.enqueue_command(Command{0, "PW_(6,4)", "move", {{6, 4}, {5, 4}}});
+    for (int t = 0; t <= 3000; t += 16)
+        game.advance(t);
+    std::thread worker([]
+                       {
+                           trace_thread_name("worker");
+                           TraceScope scope("test", "worker_span"); });
+    worker.join();
+    trace_stop();
+    CHECK_FALSE(trace_enabled());
+
+    std::ifstream in(path);
+    nlohmann::json doc = nlohmann::json::parse(in);
+    const auto &events = doc.at("traceEvents");
+
+    std::set<std::string> loop_phases, pawn_states, thread_names;
+    std::set<int> span_tids;
+    int pawn_track = -1;
+    for (const auto &e : events)
+        if (e.at("ph") == "M" && e.at("args").at("name") == "PW_(6,4)")
+            pawn_track = e.at("tid").get<int>();
+    REQUIRE(pawn_track >= 1000);
+
+    for (const auto &e : events)
+    {
+        std::string ph = e.at("ph");
+        if (ph == "M")
+        {
+            thread_names.insert(e.at("args").at("name").get<std::string>());
+            continue;
+        }
+        if (e.at("cat") == "loop")
+            loop_phases.insert(e.at("name").get<std::string>());
+        if (e.at("cat") == "piece" && e.at("tid") == pawn_track)
+            pawn_states.insert(e.at("name").get<std::string>());
+        if (e.at("name") == "worker_span" || e.at("name") == "pieces")
+            span_tids.insert(e.at("tid").get<int>());
+    }
+    CHECK(loop_phases == std::set<std::string>{"pieces", "commands", "collisions"});
+    // idle -> move -> long_rest finished within three seconds of game time
+    CHECK(pawn_states.count("idle") == 1);
+    CHECK(pawn_states.count("move") == 1);
+    CHECK(thread_names.count("test main") == 1);
+    CHECK(thread_names.count("worker") == 1);
+    CHECK(span_tids.size() == 2); // the worker has its own track
+
+    // Tracing off: nothing is recorded and the file is left alone
+    game.advance(3016);
+    std::ifstream again(path);
+    CHECK(nlohmann::json::parse(again).at("traceEvents").size() == events.size());
+}
@@ -13,6 +13,8 @@ class Moves:
         dr,dc               # can both capture and not capture
         dr,dc:non_capture   # non-capture move only
         dr,dc:capture       # capture move only (e.g. pawn diagonal)
+        dr,dc*              # ray: k*(dr,dc) for every k up to the board edge
+        dr,dc*N             # ray of at most N steps (any tag may follow)
     """
 
     def __init__(self, moves_file: pathlib.Path, dims: Tuple[int, int]):
@@ -24,6 +26,7 @@ class Moves:
         """
         self.dims = dims
         self.moves = {}  # (dr, dc) -> tag
+        self.rays = []   # (dr, dc, max_steps, tag), bounded by the board
 
         if not moves_file.exists():
             return
@@ -34,12 +37,24 @@ class Moves:
                 if not line or line.startswith("#"):
                     continue
 
-                # Parse "dr,dc:tag" format
+                # Parse "dr,dc[*[N]]:tag" format
                 move, *tag = line.split("#")[0].split(":")
-                dr, dc = map(int, move.strip().split(","))
+                move = move.strip()
                 tag = tag[0].strip() if tag else ""
+                if not move:
+                    continue
 
-                self.moves[(dr, dc)] = tag
+                if "*" in move:
+                    offset, limit = move.split("*", 1)
+                    dr, dc = map(int, offset.split(","))
+                    if dr == 0 and dc == 0:
+                        raise ValueError(f"Ray without a direction: '{line}'")
+                    span = max(1, max(dims) - 1)
+                    steps = min(max(1, int(limit)), span) if limit.strip() else span
+                    self.rays.append((dr, dc, steps, tag))
+                else:
+                    dr, dc = map(int, move.split(","))
+                    self.moves[(dr, dc)] = tag
 
     def _load_moves(self, fp: pathlib.Path) -> List[Tuple[int, int, int]]:
         moves: List[Tuple[int, int, int]] = []
@@ -74,11 +89,13 @@ class Moves:
             # tests don’t care about colour; default if missing
             my_color   = my_color or "W"
 
-        # unknown relative move
-        if (dr, dc) not in self.moves:
-            return False
-
-        move_tag = self.moves[(dr, dc)]
+        if (dr, dc) in self.moves:
+            move_tag = self.moves[(dr, dc)]
+        else:
+            ray = self._find_ray(dr, dc)
+            if ray is None:  # unknown relative move
+                return False
+            move_tag = ray[0][3]
         if move_tag == "":  # No tag = can both capture/non-capture
             return True
 
@@ -90,6 +107,24 @@ class Moves:
 
         return False  # Invalid tag
 
+    def _find_ray(self, dr, dc):
+        """The ray reaching (dr, dc) and its number of steps, or None."""
+        for ray in self.rays:
+            rdr, rdc, max_steps, _ = ray
+            if rdr != 0:
+                if dr % rdr != 0:
+                    continue
+                k = dr // rdr
+                if dc != k * rdc:
+                    continue
+            else:
+                if dr != 0 or dc % rdc != 0:
+                    continue
+                k = dc // rdc
+            if 1 <= k <= max_steps:
+                return ray, k
+        return None
+
     def is_valid(self, src_cell, dst_cell, cell2piece, is_need_clear_path, my_color):
         # Check board boundaries
         if not (0 <= dst_cell[0] < self.dims[0] and 0 <= dst_cell[1] < self.dims[1]):
@@ -116,6 +151,17 @@ class Moves:
             print(f"Path not clear at {dst_cell}")
             return False
 
+        # Along a ray: its landing cells, in integer steps
+        found = self._find_ray(dr, dc)
+        if found is not None:
+            (rdr, rdc, _, _), k = found
+            for i in range(1, k):
+                cell = (src_cell[0] + i * rdr, src_cell[1] + i * rdc)
+                if cell in cell2piece:
+                    print(f"Path not clear at {cell}")
+                    return False
+            return True
+
         # Get unit vector for movement direction
         steps = max(abs(dr), abs(dc))
         step_r = dr / steps
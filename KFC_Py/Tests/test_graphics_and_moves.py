@@ -123,3 +123,33 @@ def test_moves_board_bounds():
         assert not mv.is_valid((7, 4), (8, 4), {}, True, "X")
         assert not mv.is_valid((4, 0), (4, -1), {}, True, "X")
         assert not mv.is_valid((4, 7), (4, 8), {}, True, "X")
+
+
+def test_moves_rays():
+    with tempfile.TemporaryDirectory() as tmp:
+        moves_txt = (
+            "1,1*\n"
+            "0,1*2:non_capture\n"
+            "# a comment\n"
+            "2,0  # trailing comment\n"
+        )
+        path = pathlib.Path(tmp) / "moves.txt"
+        path.write_text(moves_txt)
+
+        mv = Moves(path, dims=(16, 16))
+        blocker = SimpleNamespace(id="PX")
+
+        # an unlimited ray reaches the edge of a board of any size
+        assert mv.is_valid((0, 0), (15, 15), {}, True, "X")
+        assert not mv.is_valid((0, 0), (15, 14), {}, True, "X")
+        assert not mv.is_valid((0, 0), (5, 5), {(3, 3): [blocker]}, True, "X")
+        assert mv.is_valid((0, 0), (5, 5), {(3, 3): [blocker]}, False, "X")
+
+        # a bounded ray, with its tag
+        assert mv.is_valid((4, 4), (4, 6), {}, True, "X")
+        assert not mv.is_valid((4, 4), (4, 7), {}, True, "X")
+        assert not mv.is_dst_cell_valid(0, 2, [blocker], "Y")
+
+        # plain offsets still work next to rays
+        assert mv.is_valid((4, 4), (6, 4), {}, True, "X")
+        assert not mv.is_valid((4, 4), (8, 4), {}, True, "X")